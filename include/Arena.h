@@ -0,0 +1,68 @@
+#ifndef ARENA_H
+#define ARENA_H
+#include "Defs.h"
+typedef struct arena_s *arena;
+
+/**
+ * @brief Creates an arena (a region) of objects of any size.
+ *
+ * The arena mallocs large blocks and hands out objects by moving a pointer forward in the newest block.
+ * Objects are never freed one by one: all the blocks are released together by destroyArena, so
+ * tearing down everything that was allocated costs one free per block instead of one per object.
+ *
+ * @param blockSize The size in bytes of every block (larger objects get a block of their own).
+ * @return A pointer to the new arena, or NULL if there was a problem.
+ */
+arena createArena(int blockSize);
+/**
+ * @brief Destroys the arena and releases all its blocks at once.
+ *
+ * Every object that came from the arena becomes invalid.
+ *
+ * @param region A pointer to the arena.
+ * @return success if the arena was destroyed, or failure if the arena is NULL.
+ */
+status destroyArena(arena region);
+/**
+ * @brief Moves all the blocks of an arena into another one and destroys the emptied arena.
+ *
+ * The objects of from stay valid, they are released with into. Objects can be allocated from separate
+ * arenas on separate threads and the arenas merged afterwards.
+ *
+ * @param into The arena that receives the blocks.
+ * @param from The arena to empty and destroy.
+ * @return success if the blocks were moved, or failure if an arena is NULL or both are the same.
+ */
+status mergeArena(arena into, arena from);
+/**
+ * @brief Takes an object from the arena.
+ *
+ * @param region A pointer to the arena.
+ * @param size   The size in bytes of the object.
+ * @return A pointer to an uninitialized object, aligned for any basic type, or NULL if the arena is NULL,
+ *         the size is negative or memory allocation failed.
+ */
+Element allocateFromArena(arena region, int size);
+/**
+ * @brief Copies a string into the arena.
+ *
+ * @param region A pointer to the arena.
+ * @param str    The string to copy.
+ * @return A pointer to the copy, or NULL if a parameter is NULL or memory allocation failed.
+ */
+char* copyStringToArena(arena region, char* str);
+/**
+ * @brief Returns the number of bytes the arena has handed out since it was created.
+ *
+ * @param region A pointer to the arena.
+ * @return The number of bytes, or -1 if the arena is NULL.
+ */
+long getArenaBytes(arena region);
+/**
+ * @brief Returns the number of blocks the arena had to malloc.
+ *
+ * @param region A pointer to the arena.
+ * @return The number of blocks, or -1 if the arena is NULL.
+ */
+long getArenaBlocks(arena region);
+#endif
@@ -0,0 +1,30 @@
+// ConfigLoader.h
+// Loads a configuration file into a PlanetsManager and a list of Jerries, on several threads for a large roster.
+
+#ifndef CONFIG_LOADER_H
+#define CONFIG_LOADER_H
+#include "Defs.h"
+#include "Jerry.h"
+#include "LinkedList.h"
+#define LOADER_MIN_CHUNK (1 << 20) // Bytes of Jerries a thread gets at least, smaller rosters load on one thread
+#define LOADER_MAX_THREADS 64
+
+/**
+ * Loads a configuration file (see ConfigParser.h) into a PlanetsManager and a list of Jerries.
+ *
+ * The Planets section is loaded first. The Jerries section is then split at Jerry lines into one chunk per thread,
+ * and every thread parses its chunk and creates its Jerries apart: from an arena of its own, with the characteristic
+ * names numbered on its own, and with the planets found in the manager, which no thread changes meanwhile.
+ * The chunks are then merged in the order of the file: the arenas join the arena of the manager, the names join
+ * the catalog, the planets of Jerries from unknown planets are created, and the Jerries are appended to the list.
+ * The result is the one of loading the file line by line: the same Jerries, planets and characteristic ids, in the same order.
+ * A file whose Jerries section is followed by another section is loaded line by line.
+ *
+ * @param file_name The name of the configuration file.
+ * @param manager A pointer to the PlanetsManager for managing planets.
+ * @param Jerries A linked list to store the Jerry objects.
+ * @param threads The number of threads to use, or 0 for one per processor.
+ * @return success, Invlid_Input if the file cannot be read, or Memory_Problem if memory allocation failed.
+ */
+status load_configuration(char* file_name, PlanetsManager* manager, linkedlist Jerries, int threads);
+#endif // CONFIG_LOADER_H
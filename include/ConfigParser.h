@@ -0,0 +1,113 @@
+#ifndef CONFIG_PARSER_H
+#define CONFIG_PARSER_H
+#include "Defs.h"
+/**
+ * A one pass parser of daycare configuration files.
+ *
+ * The file is mapped into memory (or read at once when it cannot be mapped) and split into lines with memchr.
+ * Every line is tokenized in place and numbers are parsed by hand, without sscanf.
+ * The format is the one the daycare always read:
+ *
+ *   Planets                      a section header, the whole line
+ *   <name>,<x>,<y>,<z>           a planet, in the Planets section
+ *   Jerries                      a section header, the whole line
+ *   <id>,<dimension>,<planet>,<happiness>
+ *                                a Jerry, in the Jerries section
+ *   \t<name>:<value>             a characteristic of the last Jerry, in the Jerries section
+ *
+ * Text fields are not empty and hold no ',' (no ':' for a characteristic name), numbers may be preceded by white
+ * space and anything after the last number is ignored. Lines that do not match are skipped, and lines longer than
+ * CONFIG_MAX_LINE characters are read in pieces of CONFIG_MAX_LINE characters.
+ */
+#define CONFIG_MAX_LINE 299
+
+/**
+ * The text of a configuration file in memory: mapped, or read into an allocated buffer.
+ */
+typedef struct ConfigText_struct {
+    const char* data;  // The bytes of the file (NULL for an empty file)
+    long size;         // The number of bytes
+    bool mapped;       // Whether data is a mapping of the file (true) or an allocated copy (false)
+} ConfigText;
+
+typedef status(*PlanetHandler) (Element context, char* name, double x, double y, double z);
+typedef status(*JerryHandler) (Element context, char* id, char* dimension, char* planet, int happiness);
+typedef status(*CharacteristicHandler) (Element context, char* name, double value);
+
+/**
+ * The functions called for the entries of a configuration file, in the order of the file.
+ * The strings they get are only valid during the call.
+ * A handler that returns anything other than success stops the parsing, a NULL handler skips its entries.
+ */
+typedef struct ConfigHandlers_struct {
+    PlanetHandler planet;
+    JerryHandler jerry;
+    CharacteristicHandler characteristic;
+} ConfigHandlers;
+
+/**
+ * @brief Parses a configuration file.
+ *
+ * @param path     The path of the file.
+ * @param handlers The functions to call for the entries of the file.
+ * @param context  Any pointer, passed as is to every handler.
+ * @return success if the whole file was parsed, Invlid_Input if the file cannot be read or a parameter is NULL,
+ *         Memory_Problem if allocation failed, or the first status other than success returned by a handler.
+ */
+status parseConfigFile(char* path, ConfigHandlers* handlers, Element context);
+
+/**
+ * @brief Parses a configuration that is already in memory.
+ *
+ * @param data     The text of the configuration (it is not changed).
+ * @param size     The number of bytes of the text.
+ * @param handlers The functions to call for the entries of the text.
+ * @param context  Any pointer, passed as is to every handler.
+ * @return success if the whole text was parsed, Invlid_Input if a parameter is invalid,
+ *         or the first status other than success returned by a handler.
+ */
+status parseConfigBuffer(const char* data, long size, ConfigHandlers* handlers, Element context);
+
+/**
+ * @brief Parses the lines of a Jerries section, up to the next section header.
+ *
+ * The text starts inside the section, as if the Jerries header came just before it, so a section can be
+ * split at the start of any line and its parts parsed apart.
+ *
+ * @param data     The text to parse (it is not changed).
+ * @param size     The number of bytes of the text.
+ * @param handlers The functions to call for the entries of the text.
+ * @param context  Any pointer, passed as is to every handler.
+ * @param parsed   Receives the offset of the first section header of the text, or size if it has none.
+ *                 When a handler fails, it receives the offset of the line it failed on instead.
+ * @return success if the text was parsed up to parsed, Invlid_Input if a parameter is invalid,
+ *         or the first status other than success returned by a handler.
+ */
+status parseConfigJerries(const char* data, long size, ConfigHandlers* handlers, Element context, long* parsed);
+
+/**
+ * @brief Finds the first line of a section.
+ *
+ * @param data   The text of a configuration.
+ * @param size   The number of bytes of the text.
+ * @param header The header of the section ("Planets" or "Jerries").
+ * @return The offset of the line after the first header line of the section, or -1 if the text has no such header.
+ */
+long findConfigSection(const char* data, long size, char* header);
+
+/**
+ * @brief Brings a configuration file into memory, by mapping it or by reading it when it cannot be mapped.
+ *
+ * @param path The path of the file.
+ * @param text Receives the text of the file, to release with unmapConfigFile.
+ * @return success, Invlid_Input if the file cannot be read or a parameter is NULL, or Memory_Problem if allocation failed.
+ */
+status mapConfigFile(char* path, ConfigText* text);
+
+/**
+ * @brief Releases the text of a configuration file.
+ *
+ * @param text The text filled by mapConfigFile.
+ */
+void unmapConfigFile(ConfigText* text);
+#endif
@@ -20,5 +20,8 @@ typedef Element(*CopyFunction) (Element);
 typedef status(*FreeFunction) (Element);
 typedef status(*PrintFunction) (Element);
 typedef int(*TransformIntoNumberFunction) (Element);
+typedef unsigned long long(*HashFunction) (Element, unsigned long long seed);
 typedef bool(*EqualFunction) (Element, Element);
+typedef status(*VisitFunction) (Element element, Element context);
+typedef int(*CompareFunction) (Element, Element);
 #endif //DEFS_H
\ No newline at end of file
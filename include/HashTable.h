@@ -1,15 +1,51 @@
-
 #ifndef HASH_TABLE_H
 #define HASH_TABLE_H
 #include "Defs.h"
 
 typedef struct hashTable_s *hashTable;
 
+/**
+ * The storage engine behind a hash table.
+ * Chained - every bucket is a linked list of key-value pairs.
+ * Open_Addressing - a flat array of in-place slots, probed linearly and filtered by one control byte per slot.
+ */
+typedef enum e_hash_engine {
+    Chained,
+    Open_Addressing
+} hashEngine;
+
 hashTable createHashTable(CopyFunction copyKey, FreeFunction freeKey, PrintFunction printKey, CopyFunction copyValue, FreeFunction freeValue, PrintFunction printValue, EqualFunction equalKey, TransformIntoNumberFunction transformIntoNumber, int hashNumber);
+/**
+ * Creates a hash table that uses the given storage engine.
+ * createHashTable is the same as calling this function with the Chained engine.
+ * Both engines track their load and resize themselves: the table grows when it gets full and shrinks
+ * (never below its initial size) when it gets sparse. A resize is incremental, every later operation
+ * migrates a few buckets from the old storage, so no single call pays for the whole rehash.
+ *
+ * @param hashNumber The initial number of buckets (Chained) or the expected number of entries (Open_Addressing).
+ * @param engine The storage engine of the table.
+ * @return A pointer to the new hash table, or NULL if there was a problem.
+ */
+hashTable createHashTableWithEngine(CopyFunction copyKey, FreeFunction freeKey, PrintFunction printKey, CopyFunction copyValue, FreeFunction freeValue, PrintFunction printValue, EqualFunction equalKey, TransformIntoNumberFunction transformIntoNumber, int hashNumber, hashEngine engine);
 status destroyHashTable(hashTable);
 status addToHashTable(hashTable, Element key,Element value);
 Element lookupInHashTable(hashTable, Element key);
 status removeFromHashTable(hashTable, Element key);
 status displayHashElements(hashTable);
+/**
+ * Replaces transformIntoNumber with a 64-bit hash function (see StringHash.h for built-in ones).
+ * The table draws its own random seed and passes it to every call of the hash function.
+ *
+ * @param hashFunction The hash function to use.
+ * @return success, or failure if an argument is NULL or the table is not empty.
+ */
+status setHashFunction(hashTable ht, HashFunction hashFunction);
+/**
+ * Returns how many mallocs the table saved by taking its bucket nodes and pairs from slab pools.
+ * The chained engine allocates from pools that are released in bulk by destroyHashTable.
+ *
+ * @return The number of saved mallocs (0 for the open addressing engine), or -1 if the table is NULL.
+ */
+long getHashTableSavedMallocs(hashTable ht);
 
 #endif /* HASH_TABLE_H */
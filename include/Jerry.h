@@ -4,6 +4,7 @@
 #ifndef JERRY_H
 #define JERRY_H
 #include "Defs.h"
+#define INLINE_CHARACTERISTICS 4 // Characteristics a Jerry holds without allocating an array
 // External flag to indicate memory problems
 extern int memory_failure_sign;
 // Structures
@@ -27,34 +28,60 @@ typedef struct Origin_struct {
     char* dimension;  // Dimension identifier
 } Origin;
 
+/**
+ * A characteristic name of the catalog.
+ * Every name is stored once for all Jerries and gets a small integer id, so characteristics are matched by comparing ids.
+ */
+typedef struct CharacteristicName_struct {
+    int id;       // The id of the name, its position in the catalog (from 0)
+    char* name;   // The name (e.g., Height, Weight)
+} CharacteristicName;
+
 /**
  * Represents a single physical characteristic of a Jerry.
- * Includes the name of the characteristic and its value.
+ * Includes the id of the characteristic name in the catalog and its value.
+ * A characteristic lives inside the array of its Jerry, a pointer to it is valid until a characteristic is added to or removed from that Jerry.
  */
 typedef struct PhysicalCharacteristics_struct {
-    char* name;   // The name of the characteristic (e.g., Height, Weight)
+    int id;       // The id of the characteristic name (see get_characteristic_name)
     double value; // The value of the characteristic
+    Element index_node; // Handle of the Jerry in the daycare's index of this characteristic (NULL if not indexed)
+    Element order_node; // Handle of the Jerry in the daycare's ordered index of this characteristic (NULL if not indexed)
 } PhysicalCharacteristics;
 
 /**
  * Represents a single Jerry.
- * Contains an ID, happiness level, origin information, and a dynamic array of physical characteristics.
+ * Contains an ID, happiness level, origin information, and a contiguous array of physical characteristics.
+ * The first INLINE_CHARACTERISTICS characteristics are stored inside the Jerry, more move to an allocated array that doubles when full,
+ * and halves (or moves back into the Jerry) once removals leave it a quarter full.
  */
 typedef struct Jerry_struct {
     char* id;                           // Unique Jerry ID
-    int happiness;                      // Happiness level (0-100)
+    int* happiness;                     // Happiness level (0-100): own_happiness, or the Jerry's slot in a JerryStore
+    int own_happiness;                  // The happiness of the Jerry while it is not in a JerryStore
+    Element store;                      // The JerryStore that holds the happiness of the Jerry (NULL if none)
+    Element arena;                      // The arena that holds the Jerry, its ID and origin (NULL if they are malloced)
     Origin* origin;                     // Pointer to the origin
-    PhysicalCharacteristics** characteristics; // Dynamic array of characteristics
+    PhysicalCharacteristics* characteristics; // The characteristics: inline_characteristics, or an allocated array when they do not fit
     int characteristics_count;          // Number of characteristics
+    int characteristics_capacity;       // Number of characteristics the array can hold
+    PhysicalCharacteristics inline_characteristics[INLINE_CHARACTERISTICS]; // The array while it is small enough
 } Jerry;
 
 /**
  * Manages an array of planets.
- * Tracks the list of planets and their count.
+ * Tracks the list of planets and their count, finds a planet by its name in O(1) and the planets near a point in O(log n).
+ * A manager starts as {NULL, 0}: the array and the indexes are created with the first planet.
+ * When arena is set, the planets and the Jerries created through the manager are allocated from it, they are
+ * not freed one by one and are all released when the owner of the manager destroys the arena.
  */
 typedef struct PlanetsManager {
     Planet** planets; // Array of pointers to planets
     int count;        // Number of planets
+    int capacity;     // Number of planets the array can hold, it doubles when full
+    Element index;    // The planets by name (a PlanetByName table of Jerry.c)
+    Element spatial;  // The planets by coordinates (a spatialIndex)
+    Element arena;    // The arena of the planets and Jerries (an arena of Arena.h, NULL to malloc every object)
 } PlanetsManager;
 
 // Function Declarations
@@ -62,6 +89,7 @@ typedef struct PlanetsManager {
 // --- Jerry Management ---
 /**
  * Creates a new Jerry object using all the necessary information.
+ * The Jerry is allocated from the arena of the manager, if it has one.
  * @param id The unique ID of the Jerry.
  * @param happiness The happiness level of the Jerry (0-100).
  * @param dimension The dimension where the Jerry originates.
@@ -74,12 +102,34 @@ typedef struct PlanetsManager {
  */
 Jerry* create_jerry(char* id, int happiness,char* dimension,PlanetsManager* manager, char* name, double x, double y, double z );
 
+/**
+ * Creates a new Jerry from a planet that already exists, without going through a PlanetsManager.
+ * Nothing shared is changed, a failure is only reported by the return value and memory_failure_sign is left to the caller,
+ * so Jerries can be created this way on several threads at once (each with its own arena).
+ * @param id The unique ID of the Jerry.
+ * @param happiness The happiness level of the Jerry (0-100).
+ * @param dimension The dimension where the Jerry originates.
+ * @param planet The planet where the Jerry originates.
+ * @param arena The arena to allocate the Jerry from (NULL to malloc it).
+ * @return A pointer to the newly created Jerry, or NULL if allocation fails or invalid input is provided.
+ */
+Jerry* create_jerry_on_planet(char* id, int happiness, char* dimension, Planet* planet, Element arena);
+
 /**
  * Destroys a Jerry object, freeing all associated memory.
+ * The memory of a Jerry from an arena is only released with the arena, except its characteristics array
+ * when it outgrew the Jerry, which is always malloced.
  * @param jerry Pointer to the Jerry to destroy.
  */
 void destroy_jerry(Jerry* jerry);
 
+/**
+ * Returns the happiness of a Jerry, after any activity its JerryStore deferred.
+ * @param jerry The Jerry.
+ * @return The happiness level of the Jerry.
+ */
+int get_happiness(Jerry* jerry);
+
 /**
  * Prints a Jerry's details, including its characteristics.
  * @param jerry The Jerry to print.
@@ -100,13 +150,47 @@ status print_jerry(Jerry* jerry);
 Planet* create_planet(PlanetsManager* manager, char* name, double x, double y, double z);
 
 /**
- * Destroys a Planet object, freeing its memory.
+ * Finds a planet of the PlanetsManager by its name, in O(1).
+ * @param manager The PlanetsManager to search.
+ * @param name The name of the planet.
+ * @return A pointer to the planet, or NULL if the manager has no planet with this name.
+ */
+Planet* find_planet(PlanetsManager* manager, char* name);
+
+/**
+ * Finds the planets closest to a point.
+ * @param manager The PlanetsManager to search.
+ * @param x The X coordinate of the point.
+ * @param y The Y coordinate of the point.
+ * @param z The Z coordinate of the point.
+ * @param k The number of planets to find.
+ * @param nearest Receives the planets, closest first (room for k planets).
+ * @return The number of planets found (at most k), or -1 if the input is invalid or memory allocation failed.
+ */
+int find_nearest_planets(PlanetsManager* manager, double x, double y, double z, int k, Planet** nearest);
+
+/**
+ * Calls a function on every planet within a radius of a point, closest first.
+ * @param manager The PlanetsManager to search.
+ * @param x The X coordinate of the point.
+ * @param y The Y coordinate of the point.
+ * @param z The Z coordinate of the point.
+ * @param radius The largest distance from the point.
+ * @param visit The function to call, it receives the planet and the context.
+ * @param context Any pointer, passed as is to every call of visit.
+ * @return success if every planet was visited, the first status other than success returned by visit, or failure if the input is invalid.
+ */
+status for_each_planet_within(PlanetsManager* manager, double x, double y, double z, double radius, VisitFunction visit, Element context);
+
+/**
+ * Destroys a Planet object, freeing its memory (only for a planet of a manager without an arena).
  * @param planet Pointer to the Planet to destroy.
  */
 void destroy_planet(Planet* planet);
 
 /**
  * Destroys all planets managed by a PlanetsManager.
+ * Planets from the arena of the manager are left to the arena, which is not destroyed.
  * @param manager Pointer to the PlanetsManager.
  */
 void destroy_all_planets(PlanetsManager* manager);
@@ -123,24 +207,43 @@ status print_planet(Planet* planet);
  * Creates a new Origin object.
  * @param planet Pointer to the Planet the Origin is associated with.
  * @param dimension The dimension name.
- * @return A pointer to the newly created Origin, or NULL if allocation fails.
+ * @param arena The arena to allocate the Origin from (NULL to malloc it).
+ * @return A pointer to the newly created Origin, or NULL if allocation fails (memory_failure_sign is left to the caller).
  */
-Origin* create_origin(Planet* planet, char* dimension);
+Origin* create_origin(Planet* planet, char* dimension, Element arena);
 
 // --- Physical Characteristics Management ---
 /**
- * Creates a new physical characteristic.
- * @param name The name of the characteristic.
- * @param value The value of the characteristic.
- * @return A pointer to the newly created PhysicalCharacteristic, or NULL if allocation fails.
+ * Returns the id of a characteristic name, adding the name to the catalog if it is new.
+ * @param characteristic_name The name of the characteristic.
+ * @return The id of the name, or -1 if the input is invalid or memory allocation failed.
+ */
+int intern_characteristic_name(char* characteristic_name);
+
+/**
+ * Returns the id of a characteristic name, without adding it to the catalog.
+ * @param characteristic_name The name of the characteristic.
+ * @return The id of the name, or -1 if no Jerry ever had this characteristic.
  */
-PhysicalCharacteristics* create_characteristic(char* name, double value);
+int find_characteristic_id(char* characteristic_name);
 
 /**
- * Destroys a physical characteristic, freeing its memory.
- * @param characteristic Pointer to the PhysicalCharacteristic to destroy.
+ * Returns a characteristic name of the catalog by its id.
+ * @param id The id of the name.
+ * @return A pointer to the CharacteristicName (owned by the catalog), or NULL if there is no such id.
  */
-void destroy_physical_characteristic(PhysicalCharacteristics* characteristic);
+CharacteristicName* get_characteristic_name(int id);
+
+/**
+ * Returns the number of names in the catalog, their ids are 0 to this number - 1.
+ * @return The number of characteristic names.
+ */
+int count_characteristic_names(void);
+
+/**
+ * Destroys the catalog of characteristic names, after all Jerries are destroyed.
+ */
+void destroy_characteristic_catalog(void);
 
 /**
  * Checks if a Jerry has a specific physical characteristic.
@@ -151,12 +254,24 @@ void destroy_physical_characteristic(PhysicalCharacteristics* characteristic);
 bool does_characteristic_exist(Jerry* jerry, char* characteristic_name);
 
 /**
- * Adds a physical characteristic to a Jerry.
+ * Adds a physical characteristic to a Jerry, at the end of its characteristics.
+ * @param jerry The Jerry to which the characteristic will be added.
+ * @param characteristic_name The name of the characteristic (copied).
+ * @param value The value of the characteristic.
+ * @return Status indicating success, memory problem, or duplicate characteristic.
+ */
+status add_physical_characteristic(Jerry* jerry, char* characteristic_name, double value);
+
+/**
+ * Adds a physical characteristic to a Jerry by the id of its name, at the end of its characteristics.
+ * The id is stored as is and not checked against the catalog, so a loader may number names on its own and renumber the characteristics later.
+ * Nothing shared is changed (memory_failure_sign is left to the caller), so the Jerries of different threads can get characteristics at once.
  * @param jerry The Jerry to which the characteristic will be added.
- * @param characteristic The PhysicalCharacteristic to add.
+ * @param id The id of the characteristic name.
+ * @param value The value of the characteristic.
  * @return Status indicating success, memory problem, or duplicate characteristic.
  */
-status add_physical_characteristic(Jerry* jerry, PhysicalCharacteristics* characteristic);
+status add_physical_characteristic_by_id(Jerry* jerry, int id, double value);
 
 /**
  * Removes a physical characteristic from a Jerry.
@@ -173,4 +288,12 @@ status remove_physical_characteristic(Jerry* jerry,  char* characteristic_name);
  * @return A pointer to the PhysicalCharacteristics object if found, or NULL if the characteristic does not exist.
  */
 PhysicalCharacteristics* get_characteristic(Jerry* jerry, char* characteristic_name);
+
+/**
+ * Retrieves a physical characteristic of a Jerry by the id of its name.
+ * @param jerry A pointer to the Jerry object.
+ * @param id The id of the characteristic name.
+ * @return A pointer to the PhysicalCharacteristics object if found, or NULL if the characteristic does not exist.
+ */
+PhysicalCharacteristics* get_characteristic_by_id(Jerry* jerry, int id);
 #endif // JERRY_H
\ No newline at end of file
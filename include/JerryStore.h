@@ -0,0 +1,100 @@
+#ifndef JERRY_STORE_H
+#define JERRY_STORE_H
+#include "Defs.h"
+#include "Jerry.h"
+#define MIN_HAPPINESS 0
+#define MAX_HAPPINESS 100
+#define MAX_PENDING 64 // Deferred activities kept before they are applied to every Jerry
+typedef struct jerryStore_s *jerryStore;
+
+/**
+ * @brief Creates a columnar store of Jerries.
+ *
+ * The store keeps the happiness of all its Jerries in one dense int array, one slot per Jerry, so an
+ * activity that changes every Jerry runs over the array with vector instructions (AVX2 or SSE2 when
+ * the compiler targets them, plain C otherwise) instead of visiting every Jerry.
+ * While a Jerry is in the store, its happiness pointer points to its slot. An activity can also be
+ * deferred (see deferHappinessAdjustment), then the slot is only up to date after readHappinessInStore.
+ *
+ * @param expected The number of Jerries expected, the store grows when it is passed.
+ * @return A pointer to the new store, or NULL if there was a problem.
+ */
+jerryStore createJerryStore(int expected);
+/**
+ * @brief Destroys the store. The Jerries are not freed, their happiness moves back into them.
+ *
+ * @param store A pointer to the store.
+ * @return success if the store was destroyed, or failure if the store is NULL.
+ */
+status destroyJerryStore(jerryStore store);
+/**
+ * @brief Adds a Jerry to the store, its happiness moves into a slot of the store.
+ *
+ * @param store A pointer to the store.
+ * @param jerry The Jerry to add (not copied, it must stay alive until it is removed).
+ * @return success on success, failure if parameters are invalid or the Jerry is already in a store,
+ *         or Memory_Problem if allocation failed.
+ */
+status addToJerryStore(jerryStore store, Jerry* jerry);
+/**
+ * @brief Removes a Jerry from the store in O(1), its happiness moves back into it.
+ *
+ * The last slot takes the place of the removed one, so the slots stay dense.
+ *
+ * @param store A pointer to the store.
+ * @param jerry A Jerry of this store.
+ * @return success on successful deletion, failure if parameters are invalid or the Jerry is not in this store.
+ */
+status removeFromJerryStore(jerryStore store, Jerry* jerry);
+/**
+ * @brief Changes the happiness of every Jerry in the store, right away.
+ *
+ * A Jerry whose happiness is at least the threshold gains addAbove, capped at MAX_HAPPINESS.
+ * Every other Jerry gains addBelow, floored at MIN_HAPPINESS.
+ * The deferred activities are applied first.
+ *
+ * @param store     A pointer to the store.
+ * @param threshold The happiness that separates the two groups (INT_MIN puts every Jerry above).
+ * @param addAbove  The change for the Jerries at or above the threshold.
+ * @param addBelow  The change for the Jerries below the threshold.
+ * @return success on success, failure if the store is NULL.
+ */
+status adjustHappinessInStore(jerryStore store, int threshold, int addAbove, int addBelow);
+/**
+ * @brief Records an activity for every Jerry in the store, in O(1) whatever the number of Jerries.
+ *
+ * The activity is the same as in adjustHappinessInStore, but a Jerry only goes through it when its
+ * happiness is read (readHappinessInStore) or it leaves the store. The activity changes only the
+ * order of happiness levels that become equal, the order of all other levels stays the same.
+ * After MAX_PENDING deferred activities, all of them are applied to every Jerry at once.
+ *
+ * @param store     A pointer to the store.
+ * @param threshold The happiness that separates the two groups (INT_MIN puts every Jerry above).
+ * @param addAbove  The change for the Jerries at or above the threshold.
+ * @param addBelow  The change for the Jerries below the threshold.
+ * @return success on success, failure if the store is NULL.
+ */
+status deferHappinessAdjustment(jerryStore store, int threshold, int addAbove, int addBelow);
+/**
+ * @brief Returns the happiness of a Jerry of the store, after the deferred activities it missed.
+ *
+ * @param store A pointer to the store.
+ * @param jerry A Jerry of this store.
+ * @return The happiness of the Jerry, or -1 if the Jerry is not in this store.
+ */
+int readHappinessInStore(jerryStore store, Jerry* jerry);
+/**
+ * @brief Applies the deferred activities to every Jerry in the store.
+ *
+ * @param store A pointer to the store.
+ * @return success on success, failure if the store is NULL.
+ */
+status applyDeferredAdjustments(jerryStore store);
+/**
+ * @brief Returns the number of Jerries in the store.
+ *
+ * @param store A pointer to the store.
+ * @return The number of Jerries, or -1 if the store is NULL.
+ */
+int getJerryStoreSize(jerryStore store);
+#endif
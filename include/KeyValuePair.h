@@ -1,7 +1,9 @@
 #ifndef KeyValuePair_h
 #define KeyValuePair_h
 #include "Defs.h"
+#include "MemoryPool.h"
 typedef struct key_value_pair_s *KeyValuePair;
+typedef struct pair_ops_s *pairOps;
 /**
  * Creates a new key-value pair with the given key and value.
  *
@@ -17,6 +19,46 @@ typedef struct key_value_pair_s *KeyValuePair;
  * @return A pointer to the created key-value pair, or NULL on failure.
  */
 KeyValuePair createKeyValuePair(CopyFunction copyKey, FreeFunction freeKey, PrintFunction printKey,EqualFunction equalKey, CopyFunction copyValue, FreeFunction freeValue, PrintFunction printValue, Element key,Element value);
+/**
+ * Creates a set of callbacks that many key-value pairs share.
+ * A pair only keeps a pointer to its ops, so the owner of the pairs (usually a hash table)
+ * creates the ops once and destroys them after all its pairs were destroyed.
+ *
+ * @param copyKey A function to copy the key.
+ * @param freeKey A function to free the memory of the key.
+ * @param printKey A function to print the key.
+ * @param equalKey A function to compare two keys for equality.
+ * @param copyValue A function to copy the value.
+ * @param freeValue A function to free the memory of the value.
+ * @param printValue A function to print the value.
+ * @param pool The pool the pairs are taken from (see createPairPool), or NULL to malloc every pair.
+ * @return A pointer to the created ops, or NULL on failure.
+ */
+pairOps createPairOps(CopyFunction copyKey, FreeFunction freeKey, PrintFunction printKey,EqualFunction equalKey, CopyFunction copyValue, FreeFunction freeValue, PrintFunction printValue, memoryPool pool);
+/**
+ * Destroys ops created by createPairOps. No pair may use them afterwards.
+ *
+ * @param ops The ops to destroy.
+ * @return Status indicating success or failure.
+ */
+status destroyPairOps(pairOps ops);
+/**
+ * Creates a new key-value pair that uses shared ops.
+ * destroyKeyValuePair returns the pair to the pool of the ops, if they have one.
+ *
+ * @param ops The shared callbacks of the pair.
+ * @param key The key to be stored in the pair.
+ * @param value The value to be stored in the pair.
+ * @return A pointer to the created key-value pair, or NULL on failure.
+ */
+KeyValuePair createKeyValuePairWithOps(pairOps ops, Element key, Element value);
+/**
+ * Creates a pool sized for key-value pairs.
+ *
+ * @param pairsPerSlab The number of pairs allocated with every slab.
+ * @return A pointer to the new pool, or NULL on failure.
+ */
+memoryPool createPairPool(int pairsPerSlab);
 /**
  * Destroys a key-value pair and frees its associated memory.
  *
@@ -50,9 +92,8 @@ Element getValue(KeyValuePair pair);
 /**
  * Retrieves the key from the key-value pair.
  *
- * @param pair The key-value pair to retrieve the value from.
- * @return A copy of the value stored in the pair.
- * @note If you provided a deep copy function, it is your responsibility to free the returned key.
+ * @param pair The key-value pair to retrieve the key from.
+ * @return The key stored in the pair (owned by the pair, do not free it).
  */
 Element getKey(KeyValuePair pair);
 /**
@@ -70,4 +111,20 @@ bool isEqualKey(KeyValuePair pair,Element key);
  * @return Status indicating success or failure.
  */
 status displayKeyValuePair(Element pair_element);
+/**
+ * Caches the hash of the key in the key-value pair.
+ * A hash table stores the full hash so that bucket scans compare hashes before calling equalKey.
+ *
+ * @param pair The key-value pair.
+ * @param hash The hash of the pair's key.
+ * @return Status indicating success or failure.
+ */
+status setPairHash(KeyValuePair pair, unsigned long long hash);
+/**
+ * Retrieves the cached hash of the key in the key-value pair.
+ *
+ * @param pair The key-value pair.
+ * @return The cached hash (0 if it was never set or the pair is NULL).
+ */
+unsigned long long getPairHash(KeyValuePair pair);
 #endif
\ No newline at end of file
@@ -1,7 +1,9 @@
 #ifndef LINKED_LIST_H
 #define LINKED_LIST_H
 #include "Defs.h"
+#include "MemoryPool.h"
 typedef struct linkedlist_s *linkedlist;
+typedef struct node_t *listNode;
 
 /**
  * @brief Creates a new linked list.
@@ -13,6 +15,25 @@ typedef struct linkedlist_s *linkedlist;
  * @return A pointer to the new linked list, or NULL if there was a problem.
  */
 linkedlist createLinkedList(CopyFunction copyElement, FreeFunction freeElement, PrintFunction printElement,EqualFunction equalFunc);
+/**
+ * @brief Creates a new linked list whose nodes come from a slab pool instead of one malloc each.
+ *
+ * @param copyElement   A function that copies an element and returns a new pointer.
+ * @param freeElement   A function that frees an element.
+ * @param printElement  A function that prints an element.
+ * @param equalFunc     A function that checks if two elements are equal.
+ * @param pool          A pool from createNodePool shared with other lists (it must outlive the list),
+ *                      or NULL to let the list create its own pool and release it in bulk when destroyed.
+ * @return A pointer to the new linked list, or NULL if there was a problem.
+ */
+linkedlist createLinkedListWithPool(CopyFunction copyElement, FreeFunction freeElement, PrintFunction printElement,EqualFunction equalFunc, memoryPool pool);
+/**
+ * @brief Creates a pool sized for list nodes, to be shared by several lists.
+ *
+ * @param nodesPerSlab The number of nodes allocated with every slab.
+ * @return A pointer to the new pool, or NULL if there was a problem.
+ */
+memoryPool createNodePool(int nodesPerSlab);
 /**
  * @brief Destroys the linked list and frees all its elements.
  *
@@ -30,6 +51,27 @@ status destroyLinkedList(linkedlist list);
  */
 status appendNode(linkedlist list, Element element);
 
+/**
+ * @brief Adds a new element to the end of the list and returns a handle to its node.
+ *
+ * @param list    A pointer to the linked list.
+ * @param element The element to add (it will be copied internally).
+ * @param handle  Receives the node of the new element (may be NULL). The handle stays valid until the element is removed.
+ *
+ * @return success on success, failure if parameters are invalid, or Memory_Problem if allocation failed.
+ */
+status appendNodeWithHandle(linkedlist list, Element element, listNode* handle);
+
+/**
+ * @brief Deletes the element of a node in O(1), without searching the list.
+ *
+ * @param list   A pointer to the linked list.
+ * @param handle A node of this list (from appendNodeWithHandle or getFirstNode/getNextNode).
+ *
+ * @return success on successful deletion, failure if parameters are invalid.
+ */
+status removeByHandle(linkedlist list, listNode handle);
+
 /**
  * @brief Deletes a specified element from the linked list.
  *
@@ -84,4 +126,38 @@ Element searchByKeyInList(linkedlist list, Element key);
 * @Note that you will receive a copy of the data. Therefore, if you provided a deep copy, it is your responsibility to free the additional memory.
 * */
 Element getTailContent(linkedlist list);
+/**
+ * @brief Moves the first node of a list to the end of another list.
+ *
+ * The element is neither copied nor freed, only relinked, so the two lists should share the same callbacks.
+ *
+ * @param from The list to take the first node from.
+ * @param to   The list to append the node to.
+ * @return success on success, failure if a list is NULL or the source list is empty.
+ */
+status transferHead(linkedlist from, linkedlist to);
+/**
+ * @brief Returns the first node of the list, to walk over the list in order.
+ *
+ * Walking with getFirstNode/getNextNode visits the whole list in O(n), unlike a loop over getDataByIndex.
+ * The list must not be changed while it is walked (except for the node that was already visited).
+ *
+ * @param list A pointer to the linked list.
+ * @return The first node, or NULL if the list is empty or invalid.
+ */
+listNode getFirstNode(linkedlist list);
+/**
+ * @brief Returns the node that follows a node.
+ *
+ * @param node A node of a list.
+ * @return The next node, or NULL at the end of the list.
+ */
+listNode getNextNode(listNode node);
+/**
+ * @brief Returns the element stored in a node.
+ *
+ * @param node A node of a list.
+ * @return The element itself (not a copy, it is still owned by the list), or NULL if the node is NULL.
+ */
+Element getNodeData(listNode node);
 #endif
\ No newline at end of file
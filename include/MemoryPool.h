@@ -0,0 +1,62 @@
+#ifndef MEMORY_POOL_H
+#define MEMORY_POOL_H
+#include "Defs.h"
+typedef struct memoryPool_s *memoryPool;
+
+/**
+ * @brief Creates a pool of fixed-size objects.
+ *
+ * The pool mallocs slabs of many objects at once, hands out objects from them and keeps returned
+ * objects in a free list for reuse. All the slabs are released together by destroyMemoryPool.
+ *
+ * @param objectSize     The size in bytes of every object.
+ * @param objectsPerSlab The number of objects allocated with every slab.
+ * @return A pointer to the new pool, or NULL if there was a problem.
+ */
+memoryPool createMemoryPool(int objectSize, int objectsPerSlab);
+/**
+ * @brief Destroys the pool and releases all its slabs at once.
+ *
+ * Every object that came from the pool becomes invalid, whether it was returned or not.
+ *
+ * @param pool A pointer to the pool.
+ * @return success if the pool was destroyed, or failure if the pool is NULL.
+ */
+status destroyMemoryPool(memoryPool pool);
+/**
+ * @brief Takes an object from the pool.
+ *
+ * @param pool A pointer to the pool.
+ * @return A pointer to an uninitialized object, or NULL if the pool is NULL or memory allocation failed.
+ */
+Element allocateFromPool(memoryPool pool);
+/**
+ * @brief Returns an object to the pool so it can be reused.
+ *
+ * @param pool   A pointer to the pool.
+ * @param object An object that was taken from this pool.
+ * @return success, or failure if a parameter is NULL.
+ */
+status returnToPool(memoryPool pool, Element object);
+/**
+ * @brief Returns the number of objects the pool has handed out since it was created.
+ *
+ * @param pool A pointer to the pool.
+ * @return The number of allocations, or -1 if the pool is NULL.
+ */
+long getPoolAllocations(memoryPool pool);
+/**
+ * @brief Returns the number of slabs the pool had to malloc.
+ *
+ * @param pool A pointer to the pool.
+ * @return The number of slabs, or -1 if the pool is NULL.
+ */
+long getPoolSlabs(memoryPool pool);
+/**
+ * @brief Returns how many mallocs the pool saved, compared to one malloc per allocation.
+ *
+ * @param pool A pointer to the pool.
+ * @return The number of allocations minus the number of slabs, or -1 if the pool is NULL.
+ */
+long getPoolSavedMallocs(memoryPool pool);
+#endif
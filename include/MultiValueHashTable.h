@@ -16,7 +16,7 @@ typedef struct MultiValueHashTable_s* MultiValueHashTable;
  * @param equalKey Function to compare keys for equality.
  * @param equalValue Function to compare values for equality.
  * @param transformIntoNumber Function to transform a key into a hash number.
- * @param hashNumber The number of buckets in the hash table.
+ * @param hashNumber The initial number of buckets in the hash table (it grows and shrinks with the number of keys).
  *
  * @return A pointer to the created multi-value hash table, or NULL if creation fails.
  */
@@ -46,6 +46,18 @@ status destroyMultiValueHashTable(MultiValueHashTable mht);
  */
 status addToMultiValueHashTable(MultiValueHashTable mht, Element key, Element value);
 
+/**
+ * Adds a value under the specified key and returns the node that holds it in the key's value list.
+ *
+ * @param mht The multi-value hash table.
+ * @param key The key to which the value will be associated.
+ * @param value The value to add.
+ * @param handle Receives the node of the value (may be NULL), for removeHandleFromMultiValueHashTable.
+ *
+ * @return Status indicating success or failure.
+ */
+status addToMultiValueHashTableWithHandle(MultiValueHashTable mht, Element key, Element value, listNode* handle);
+
 /**
  * Looks up the list of values associated with a specific key in the multi-value hash table.
  *
@@ -66,6 +78,17 @@ linkedlist lookupInMultiValueHashTable(MultiValueHashTable mht, Element key);
  */
 status removeFromMultiValueHashTable(MultiValueHashTable mht, Element key, Element value);
 
+/**
+ * Removes the value held by a node of a key's value list, without searching the list.
+ * If the value is the last one associated with the key, the key is also removed from the table.
+ * @param mht The multi-value hash table.
+ * @param key The key from which the value will be removed.
+ * @param handle The node returned by addToMultiValueHashTableWithHandle for this key.
+ *
+ * @return Status indicating success or failure.
+ */
+status removeHandleFromMultiValueHashTable(MultiValueHashTable mht, Element key, listNode handle);
+
 /**
  * Displays all values associated with a specific key in the multi-value hash table.
  *
@@ -75,4 +98,22 @@ status removeFromMultiValueHashTable(MultiValueHashTable mht, Element key, Eleme
  * @return Status indicating success or failure.
  */
 status displayMultiValueHashElementsByKey(MultiValueHashTable mht, Element key);
+
+/**
+ * Replaces the transformIntoNumber of the multi-value hash table with a 64-bit hash function.
+ *
+ * @param mht The multi-value hash table (must be empty).
+ * @param hashFunction The hash function to use (see StringHash.h for built-in ones).
+ *
+ * @return Status indicating success or failure.
+ */
+status setMultiValueHashFunction(MultiValueHashTable mht, HashFunction hashFunction);
+
+/**
+ * Returns how many mallocs the multi-value hash table saved by taking its nodes and pairs from slab pools.
+ *
+ * @param mht The multi-value hash table.
+ * @return The number of saved mallocs, or -1 if the table is NULL.
+ */
+long getMultiValueSavedMallocs(MultiValueHashTable mht);
 #endif
\ No newline at end of file
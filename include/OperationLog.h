@@ -0,0 +1,115 @@
+// OperationLog.h
+// An append-only log of the changes of the daycare, replayed on startup so a crash loses none of them.
+
+#ifndef OPERATION_LOG_H
+#define OPERATION_LOG_H
+#include "Defs.h"
+#define LOG_MAGIC "JERRYLOG" // The first 8 bytes of every log
+#define LOG_VERSION 1
+#define LOG_MAX_RECORD 4096  // Bytes of the largest record, the strings of a change must fit in it
+
+/**
+ * The log is a header followed by one record per change, in the order the changes were made:
+ *
+ *   header             magic, version, byte order, and the base of the log
+ *   record             the size and the checksum of the record, then its type and fields
+ *                      (admit, add characteristic, remove characteristic, check out, activity)
+ *
+ * The base is the state the changes apply to: 0 for the configuration file, or the checksum of the snapshot
+ * they were made after (see Snapshot.h). Saving a snapshot empties the log and makes the snapshot its base.
+ * The snapshot records the base the log had when it was saved: if a crash comes after the snapshot replaced the
+ * old one and before the log was emptied, the log still has that base, and it is emptied when it is opened
+ * instead of being replayed, since the snapshot holds its changes.
+ *
+ * A change is logged before it is made. Logging only copies the record to a buffer in memory: a thread of the log
+ * writes the buffer to the file and syncs it, and the records logged while it syncs are written and synced together
+ * on its next round (group commit), so a sync is paid once per batch and not once per change.
+ * A record cut by a crash fails its checksum, it and what follows are dropped when the log is opened.
+ */
+typedef struct operationLog_s *operationLog;
+
+/**
+ * How durable a logged change is when the daycare goes on.
+ * Log_Unsynced - the log thread writes the records but never syncs them: they survive a crash of the program,
+ *                not of the machine.
+ * Log_Group_Commit - the log thread writes and syncs the records a batch at a time, the daycare never waits for it:
+ *                a crash of the machine loses at most the batch being synced.
+ * Log_Synchronous - every change waits until its record is synced, with the records of its batch, before it is made.
+ */
+typedef enum e_log_durability {
+    Log_Unsynced,
+    Log_Group_Commit,
+    Log_Synchronous
+} logDurability;
+
+typedef status(*LogAdmitHandler) (Element context, char* id, char* planet, char* dimension, int happiness);
+typedef status(*LogAddHandler) (Element context, char* id, char* name, double value);
+typedef status(*LogRemoveHandler) (Element context, char* id, char* name);
+typedef status(*LogCheckOutHandler) (Element context, char* id);
+typedef status(*LogActivityHandler) (Element context, int activity);
+
+/**
+ * The functions called for the records of a log when it is replayed, in the order of the log.
+ * The strings they get are only valid during the call.
+ * A handler that returns anything other than success stops the replay.
+ */
+typedef struct LogHandlers_struct {
+    LogAdmitHandler admit;
+    LogAddHandler add_characteristic;
+    LogRemoveHandler remove_characteristic;
+    LogCheckOutHandler check_out;
+    LogActivityHandler activity;
+} LogHandlers;
+
+/**
+ * Opens a log, creating it if it does not exist, and replays its records with the handlers.
+ * The records after the last whole one are dropped, and the next changes are appended after it.
+ * @param path The path of the log file.
+ * @param durability How durable a logged change is.
+ * @param base The state the daycare was loaded from: 0 for the configuration file, or the checksum of the snapshot.
+ * @param applied The base of a log whose changes the daycare already holds (see get_snapshot_log_base), or NULL.
+ *                A log of this base is emptied and given base, without replaying it.
+ * @param handlers The functions to call for the records of the log.
+ * @param context Any pointer, passed as is to every handler.
+ * @param result Receives success, Invlid_Input if the file cannot be used or is the log of another base,
+ *               Memory_Problem, or the first status other than success returned by a handler.
+ * @return The open log, or NULL if it was not opened.
+ */
+operationLog openOperationLog(char* path, logDurability durability, unsigned long long base, unsigned long long* applied,
+                              LogHandlers* handlers, Element context, status* result);
+
+/**
+ * Log a change of the daycare, before it is made.
+ * Every one of them only buffers the record, unless the durability is Log_Synchronous. A NULL log logs nothing.
+ * @return success, Invlid_Input if the strings do not fit in a record, Memory_Problem,
+ *         or failure if the log could not be written since it was opened.
+ */
+status logAdmit(operationLog log, char* id, char* planet, char* dimension, int happiness);
+status logAddCharacteristic(operationLog log, char* id, char* name, double value);
+status logRemoveCharacteristic(operationLog log, char* id, char* name);
+status logCheckOut(operationLog log, char* id);
+status logActivity(operationLog log, int activity);
+
+/**
+ * Empties the log after a snapshot of the daycare was saved, so the log holds the changes made after it.
+ * The records logged so far are written first.
+ * @param log The log.
+ * @param base The checksum of the snapshot.
+ * @return success, or failure if the log could not be written.
+ */
+status resetOperationLog(operationLog log, unsigned long long base);
+
+/**
+ * Returns the base of a log, the state its records apply to.
+ * @param log The log.
+ * @return The base, or 0 if log is NULL.
+ */
+unsigned long long getOperationLogBase(operationLog log);
+
+/**
+ * Writes and syncs the records logged so far, stops the log thread and closes the log.
+ * @param log The log, or NULL.
+ * @return success, or failure if the log could not be written.
+ */
+status closeOperationLog(operationLog log);
+#endif // OPERATION_LOG_H
@@ -0,0 +1,178 @@
+#ifndef ORDERED_INDEX_H
+#define ORDERED_INDEX_H
+#include "Defs.h"
+typedef struct orderedIndex_s *orderedIndex;
+typedef struct index_node_s *indexNode;
+typedef double(*DistanceFunction) (Element element, Element context);
+
+/**
+ * One dimension of a nearest neighbour search over several indexes (see findNearestInIndexes).
+ */
+typedef struct index_dimension_s {
+    orderedIndex index; // The elements ordered by their number in this dimension (NULL if no element has it)
+    double target;      // The number searched for in this dimension
+    double weight;      // Weight of the squared difference from the target
+    double missing;     // Distance added for an element that is not in the index of this dimension
+} IndexDimension;
+
+/**
+ * @brief Creates an index that keeps elements ordered by a number (a balanced binary search tree).
+ *
+ * Elements with the same number stay in the order they were added.
+ * Adding, removing and every search run in O(log n).
+ *
+ * @param copyElement   A function that copies an element and returns a new pointer.
+ * @param freeElement   A function that frees an element.
+ * @param printElement  A function that prints an element.
+ * @return A pointer to the new index, or NULL if there was a problem.
+ */
+orderedIndex createOrderedIndex(CopyFunction copyElement, FreeFunction freeElement, PrintFunction printElement);
+/**
+ * @brief Destroys the index and frees all its elements.
+ *
+ * @param index A pointer to the index.
+ * @return success if the index was destroyed, or failure if the index is NULL.
+ */
+status destroyOrderedIndex(orderedIndex index);
+/**
+ * @brief Adds an element under a number.
+ *
+ * @param index   A pointer to the index.
+ * @param value   The number the element is ordered by.
+ * @param element The element to add (it will be copied internally).
+ * @param handle  Receives the node of the new element (may be NULL). The handle stays valid until the element is removed.
+ * @return success on success, failure if parameters are invalid, or Memory_Problem if allocation failed.
+ */
+status addToOrderedIndex(orderedIndex index, double value, Element element, indexNode* handle);
+/**
+ * @brief Removes the element of a node in O(log n), without searching the index.
+ *
+ * @param index  A pointer to the index.
+ * @param handle A node of this index.
+ * @return success on successful deletion, failure if parameters are invalid.
+ */
+status removeFromOrderedIndex(orderedIndex index, indexNode handle);
+/**
+ * @brief Finds the node with the greatest number that is not above the target.
+ *
+ * @param index  A pointer to the index.
+ * @param target The number to search for.
+ * @return The node (the first added among equal numbers), or NULL if every number is above the target.
+ */
+indexNode findFloorInIndex(orderedIndex index, double target);
+/**
+ * @brief Finds the node with the smallest number that is not below the target.
+ *
+ * @param index  A pointer to the index.
+ * @param target The number to search for.
+ * @return The node (the first added among equal numbers), or NULL if every number is below the target.
+ */
+indexNode findCeilingInIndex(orderedIndex index, double target);
+/**
+ * @brief Finds the node whose number is the closest to the target.
+ *
+ * @param index  A pointer to the index.
+ * @param target The number to search for.
+ * @return The closest node (the first added among equally close ones), or NULL if the index is empty or invalid.
+ */
+indexNode findNearestInIndex(orderedIndex index, double target);
+/**
+ * @brief Finds the k elements closest to a point over several indexes (one per dimension).
+ *
+ * The distance of an element is the sum over the dimensions of weight * (number - target)^2,
+ * or of missing for a dimension whose index does not hold the element.
+ * Only elements held by at least one of the indexes are candidates.
+ * The search walks outward from the target in every index, always taking the closest unvisited
+ * number, and stops as soon as no unvisited element can beat the k-th best one found.
+ *
+ * @param dimensions     The dimensions of the search.
+ * @param dimensionCount The number of dimensions.
+ * @param distance       Calculates the full distance of an element, as described above.
+ * @param context        Any pointer, passed as is to every call of distance.
+ * @param k              The number of elements to find, more than the indexes hold finds all of them.
+ * @param nearest        Receives the elements, closest first (room for k elements).
+ * @param distances      Receives the distances of the elements (may be NULL).
+ * @return The number of elements found (at most k), or -1 if the parameters are invalid or memory allocation failed.
+ */
+int findNearestInIndexes(IndexDimension* dimensions, int dimensionCount, DistanceFunction distance, Element context, int k, Element* nearest, double* distances);
+/**
+ * @brief Counts the elements whose number is in [low, high], in O(log n) and without visiting them.
+ *
+ * @param index A pointer to the index.
+ * @param low   The lowest number of the range.
+ * @param high  The highest number of the range.
+ * @return The number of elements in the range (0 if low is above high), or -1 if the index is NULL.
+ */
+int countInIndexRange(orderedIndex index, double low, double high);
+/**
+ * @brief Calls a function on every element whose number is in [low, high], in order, without copying the elements.
+ *
+ * Finding the start of the range is O(log n), every visited element then costs O(1) on average.
+ * The index must not be changed while the range is visited.
+ *
+ * @param index   A pointer to the index.
+ * @param low     The lowest number of the range.
+ * @param high    The highest number of the range.
+ * @param visit   The function to call, it receives the element itself (still owned by the index) and the context.
+ * @param context Any pointer, passed as is to every call of visit.
+ * @return success if every element in the range was visited, the first status other than success returned
+ *         by visit, or failure if the parameters are invalid.
+ */
+status forEachInIndexRange(orderedIndex index, double low, double high, VisitFunction visit, Element context);
+/**
+ * @brief Returns the node with the smallest number, to walk over the index in order.
+ *
+ * @param index A pointer to the index.
+ * @return The first node, or NULL if the index is empty or invalid.
+ */
+indexNode getFirstIndexNode(orderedIndex index);
+/**
+ * @brief Returns the node with the greatest number.
+ *
+ * @param index A pointer to the index.
+ * @return The last node, or NULL if the index is empty or invalid.
+ */
+indexNode getLastIndexNode(orderedIndex index);
+/**
+ * @brief Returns the node that follows a node in the order of the index.
+ *
+ * @param node A node of an index.
+ * @return The next node, or NULL at the end of the index.
+ */
+indexNode getNextIndexNode(indexNode node);
+/**
+ * @brief Returns the node that precedes a node in the order of the index.
+ *
+ * @param node A node of an index.
+ * @return The previous node, or NULL at the start of the index.
+ */
+indexNode getPrevIndexNode(indexNode node);
+/**
+ * @brief Returns the element stored in a node.
+ *
+ * @param node A node of an index.
+ * @return The element itself (not a copy, it is still owned by the index), or NULL if the node is NULL.
+ */
+Element getIndexNodeData(indexNode node);
+/**
+ * @brief Returns the number a node is ordered by.
+ *
+ * @param node A node of an index.
+ * @return The number of the node, or 0 if the node is NULL.
+ */
+double getIndexNodeValue(indexNode node);
+/**
+ * @brief Returns the number of elements in the index.
+ *
+ * @param index A pointer to the index.
+ * @return The number of elements, or -1 if the index is NULL.
+ */
+int getIndexSize(orderedIndex index);
+/**
+ * @brief Prints all elements in the order of the index.
+ *
+ * @param index A pointer to the index.
+ * @return success on success, failure if the index is NULL.
+ */
+status displayOrderedIndex(orderedIndex index);
+#endif
@@ -0,0 +1,105 @@
+#ifndef PRIORITY_QUEUE_H
+#define PRIORITY_QUEUE_H
+#include "Defs.h"
+typedef struct priorityQueue_s *priorityQueue;
+typedef struct heap_node_s *heapNode;
+
+/**
+ * @brief Creates a new priority queue (a d-ary min-heap).
+ *
+ * The top of the queue is the smallest element by compare. Elements that compare equal come out
+ * in the order they were added. Adding, removing and updating an element run in O(log n).
+ *
+ * @param copyElement   A function that copies an element and returns a new pointer.
+ * @param freeElement   A function that frees an element.
+ * @param printElement  A function that prints an element.
+ * @param compare       A function that returns a negative number, 0 or a positive number when its first
+ *                      element is smaller than, equal to or greater than its second element.
+ * @return A pointer to the new priority queue, or NULL if there was a problem.
+ */
+priorityQueue createPriorityQueue(CopyFunction copyElement, FreeFunction freeElement, PrintFunction printElement, CompareFunction compare);
+/**
+ * @brief Destroys the priority queue and frees all its elements.
+ *
+ * @param pq A pointer to the priority queue.
+ * @return success if the queue was destroyed, or failure if the queue is NULL.
+ */
+status destroyPriorityQueue(priorityQueue pq);
+/**
+ * @brief Adds an element to the priority queue.
+ *
+ * @param pq      A pointer to the priority queue.
+ * @param element The element to add (it will be copied internally).
+ * @param handle  Receives the node of the new element (may be NULL). The handle stays valid until the element is removed.
+ * @return success on success, failure if parameters are invalid, or Memory_Problem if allocation failed.
+ */
+status pushToPriorityQueue(priorityQueue pq, Element element, heapNode* handle);
+/**
+ * @brief Returns the smallest element without removing it.
+ *
+ * @param pq A pointer to the priority queue.
+ * @return The element itself (not a copy, it is still owned by the queue), or NULL if the queue is empty or invalid.
+ */
+Element peekPriorityQueue(priorityQueue pq);
+/**
+ * @brief Returns the node of the smallest element.
+ *
+ * @param pq A pointer to the priority queue.
+ * @return The top node, or NULL if the queue is empty or invalid.
+ */
+heapNode getTopHeapNode(priorityQueue pq);
+/**
+ * @brief Removes the element of a node (any node, not only the top) and frees it.
+ *
+ * @param pq     A pointer to the priority queue.
+ * @param handle A node of this queue.
+ * @return success on successful deletion, failure if parameters are invalid.
+ */
+status removeFromPriorityQueue(priorityQueue pq, heapNode handle);
+/**
+ * @brief Moves a node to its place after the priority of its element was increased or decreased.
+ *
+ * @param pq     A pointer to the priority queue.
+ * @param handle A node of this queue whose element changed.
+ * @return success on success, failure if parameters are invalid.
+ */
+status updateInPriorityQueue(priorityQueue pq, heapNode handle);
+/**
+ * @brief Restores the order of the whole queue in O(n), after the priorities of many elements changed.
+ *
+ * @param pq A pointer to the priority queue.
+ * @return success on success, failure if the queue is NULL.
+ */
+status rebuildPriorityQueue(priorityQueue pq);
+/**
+ * @brief Marks the order of the whole queue as stale, in O(1), after the priorities of many elements changed.
+ *
+ * The queue is rebuilt once, by the next operation that needs its order (adding, peeking, removing or updating).
+ * Until then the queue compares no element, so priorities that keep changing cost nothing.
+ *
+ * @param pq A pointer to the priority queue.
+ * @return success on success, failure if the queue is NULL.
+ */
+status invalidatePriorityQueue(priorityQueue pq);
+/**
+ * @brief Returns the element stored in a node.
+ *
+ * @param node A node of a priority queue.
+ * @return The element itself (not a copy, it is still owned by the queue), or NULL if the node is NULL.
+ */
+Element getHeapNodeData(heapNode node);
+/**
+ * @brief Returns the number of elements in the priority queue.
+ *
+ * @param pq A pointer to the priority queue.
+ * @return The number of elements, or -1 if the queue is NULL.
+ */
+int getPriorityQueueSize(priorityQueue pq);
+/**
+ * @brief Prints all elements, in heap order (only the first one is guaranteed to be the smallest).
+ *
+ * @param pq A pointer to the priority queue.
+ * @return success on success, failure if the queue is NULL.
+ */
+status displayPriorityQueue(priorityQueue pq);
+#endif
@@ -0,0 +1,46 @@
+// RosterFeed.h
+// Follows an append-only roster file and parses the lines appended to it, for Jerries that arrive while the daycare runs.
+
+#ifndef ROSTER_FEED_H
+#define ROSTER_FEED_H
+#include "Defs.h"
+#include "ConfigParser.h"
+
+/**
+ * A roster is a file of Jerry lines and characteristic lines, in the format of the Jerries section of a
+ * configuration file (see ConfigParser.h), which another program appends to. A configuration file whose last
+ * section is Jerries can be followed as well.
+ *
+ * The feed starts at the end of the file: what it held already is not read. The file is watched with inotify, so
+ * a poll of a file that did not change costs one read of the watch, and only the bytes appended since the last
+ * poll are read. A line is parsed once it is whole, the part of a line still being written waits for the next poll.
+ * Section headers are skipped. A file that gets shorter was truncated, and is read again from its start.
+ * Without inotify, every poll checks the size of the file instead.
+ */
+typedef struct rosterFeed_s *rosterFeed;
+
+/**
+ * Starts following a roster file, from its current end.
+ * @param path The path of the roster file.
+ * @param result Receives success, Invlid_Input if the file cannot be read, or Memory_Problem.
+ * @return The feed, or NULL if it was not opened.
+ */
+rosterFeed openRosterFeed(char* path, status* result);
+
+/**
+ * Parses the whole lines appended to the roster since the last poll, as one batch.
+ * @param feed The feed.
+ * @param handlers The functions to call for the Jerries and characteristics of the new lines.
+ * @param context Any pointer, passed as is to every handler.
+ * @return success (also when nothing was appended), Invlid_Input if the file cannot be read, Memory_Problem,
+ *         or the first status other than success returned by a handler: the lines before the one it failed on
+ *         are not read again, that line and the rest of the batch are read on the next poll.
+ */
+status pollRosterFeed(rosterFeed feed, ConfigHandlers* handlers, Element context);
+
+/**
+ * Stops following a roster file.
+ * @param feed The feed, or NULL.
+ */
+void closeRosterFeed(rosterFeed feed);
+#endif // ROSTER_FEED_H
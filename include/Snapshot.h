@@ -0,0 +1,94 @@
+// Snapshot.h
+// Saves the whole state of the daycare to a binary file and restores it without parsing a configuration file.
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+#include "Defs.h"
+#include "Jerry.h"
+#include "LinkedList.h"
+#include "MultiValueHashTable.h"
+#define SNAPSHOT_MAGIC "JERRYSNP" // The first 8 bytes of every snapshot
+#define SNAPSHOT_VERSION 2
+
+/**
+ * A snapshot file is a fixed header followed by arrays of fixed size records, every part aligned to 8 bytes:
+ *
+ *   header             magic, version, byte order, the number of every record, the checksum of the rest,
+ *                      and the base of the log of the daycare when it was saved (see OperationLog.h)
+ *   planets            x, y, z and the name of every planet, in the order of the PlanetsManager
+ *   names              the characteristic names of the catalog, by id
+ *   Jerries            id, dimension, planet, current happiness and characteristics of every Jerry, in the order of the list
+ *   characteristics    the id and value of every characteristic, Jerry after Jerry
+ *   index layout       for every characteristic name, the Jerries that have it in the order of the characteristic
+ *                      indexes, so they are rebuilt with the same order of ties
+ *   strings            every name, id and dimension, NUL terminated, referenced by offset
+ *
+ * A snapshot is written to a temporary file that replaces the old one only once it is complete and synced, so a
+ * crash during a save leaves the previous snapshot. It is read by mapping the file, checking the header, the
+ * checksum and every reference, and then creating the objects straight from the records.
+ * Numbers are stored in the byte order of the machine that saved them: a snapshot of another byte order is rejected.
+ */
+typedef struct snapshot_s *snapshot;
+
+/**
+ * The function that indexes a characteristic of a Jerry, called by index_snapshot_characteristics.
+ */
+typedef status(*CharacteristicIndexer)(Jerry* jerry, PhysicalCharacteristics* characteristic, Element context);
+
+/**
+ * Saves the daycare to a snapshot file, replacing the file atomically.
+ * @param path The path of the snapshot file.
+ * @param manager The PlanetsManager of the daycare.
+ * @param Jerries The list of the Jerries of the daycare.
+ * @param mht The multi-value hash table of the Jerries by characteristic name (keyed by the names of the catalog),
+ *            its order is saved as the index layout.
+ * @param log_base The base of the log of the daycare, whose changes the snapshot holds (NULL if it has no log).
+ * @param checksum Receives the checksum of the saved snapshot, unless NULL.
+ * @return success, Invlid_Input if a parameter is NULL or the file cannot be written, or Memory_Problem.
+ */
+status save_snapshot(char* path, PlanetsManager* manager, linkedlist Jerries, MultiValueHashTable mht,
+                     unsigned long long* log_base, unsigned long long* checksum);
+
+/**
+ * Restores the planets, the characteristic catalog and the Jerries of a snapshot.
+ * The whole file is checked before anything is created, so a damaged snapshot is rejected before it changes anything.
+ * The catalog must be empty, so the names get back their ids.
+ * @param path The path of the snapshot file.
+ * @param manager The PlanetsManager to fill (its arena, if it has one, holds the planets and the Jerries).
+ * @param Jerries The list to append the Jerries to, in their saved order.
+ * @param result Receives success, Invlid_Input if the file cannot be read or is not a valid snapshot, or Memory_Problem.
+ * @return The open snapshot, to give to index_snapshot_characteristics and close_snapshot, or NULL if it was not restored.
+ */
+snapshot load_snapshot(char* path, PlanetsManager* manager, linkedlist Jerries, status* result);
+
+/**
+ * Calls a function on every characteristic of the restored Jerries, in the saved order of the characteristic indexes.
+ * @param snap The snapshot returned by load_snapshot.
+ * @param index The function that indexes a characteristic.
+ * @param context Any pointer, passed as is to every call of index.
+ * @return success, the first status other than success returned by index, or failure if the input is invalid.
+ */
+status index_snapshot_characteristics(snapshot snap, CharacteristicIndexer index, Element context);
+
+/**
+ * Returns the checksum of a snapshot, which tells it apart from other snapshots (see OperationLog.h).
+ * @param snap The snapshot returned by load_snapshot.
+ * @return The checksum of the header of the snapshot, or 0 if snap is NULL.
+ */
+unsigned long long get_snapshot_checksum(snapshot snap);
+
+/**
+ * Returns the base of the log the daycare had when the snapshot was saved. A log that still has this base was not
+ * emptied after the save (a crash came in between), and its changes are already in the snapshot.
+ * @param snap The snapshot returned by load_snapshot.
+ * @param base Receives the base of the log.
+ * @return true if the daycare had a log when it was saved, false otherwise.
+ */
+bool get_snapshot_log_base(snapshot snap, unsigned long long* base);
+
+/**
+ * Closes a snapshot, the restored objects are not changed.
+ * @param snap The snapshot returned by load_snapshot.
+ */
+void close_snapshot(snapshot snap);
+#endif // SNAPSHOT_H
@@ -0,0 +1,81 @@
+#ifndef SPATIAL_INDEX_H
+#define SPATIAL_INDEX_H
+#include "Defs.h"
+typedef struct spatialIndex_s *spatialIndex;
+
+/**
+ * @brief Creates an index of elements by a point in 3D space (a k-d tree).
+ *
+ * The tree is kept balanced while elements are added: a subtree that becomes too lopsided is rebuilt
+ * around its medians, so adding an element and every search stay O(log n) on average.
+ * Among elements at the same distance from a point, the one added first comes first.
+ *
+ * @param copyElement   A function that copies an element and returns a new pointer.
+ * @param freeElement   A function that frees an element.
+ * @param printElement  A function that prints an element.
+ * @return A pointer to the new index, or NULL if there was a problem.
+ */
+spatialIndex createSpatialIndex(CopyFunction copyElement, FreeFunction freeElement, PrintFunction printElement);
+/**
+ * @brief Destroys the index and frees all its elements.
+ *
+ * @param index A pointer to the index.
+ * @return success if the index was destroyed, or failure if the index is NULL.
+ */
+status destroySpatialIndex(spatialIndex index);
+/**
+ * @brief Adds an element at a point.
+ *
+ * @param index   A pointer to the index.
+ * @param x       The X coordinate of the element.
+ * @param y       The Y coordinate of the element.
+ * @param z       The Z coordinate of the element.
+ * @param element The element to add (it will be copied internally).
+ * @return success on success, failure if parameters are invalid, or Memory_Problem if allocation failed.
+ */
+status addToSpatialIndex(spatialIndex index, double x, double y, double z, Element element);
+/**
+ * @brief Finds the k elements closest to a point.
+ *
+ * @param index     A pointer to the index.
+ * @param x         The X coordinate of the point.
+ * @param y         The Y coordinate of the point.
+ * @param z         The Z coordinate of the point.
+ * @param k         The number of elements to find.
+ * @param nearest   Receives the elements, closest first (room for k elements). They are still owned by the index.
+ * @param distances Receives the squared distances of the elements from the point (may be NULL).
+ * @return The number of elements found (at most k), or -1 if the parameters are invalid.
+ */
+int findNearestInSpatialIndex(spatialIndex index, double x, double y, double z, int k, Element* nearest, double* distances);
+/**
+ * @brief Calls a function on every element within a radius of a point, closest first, without copying the elements.
+ *
+ * Only the parts of the tree that can hold such elements are searched.
+ * The index must not be changed while the elements are visited.
+ *
+ * @param index   A pointer to the index.
+ * @param x       The X coordinate of the point.
+ * @param y       The Y coordinate of the point.
+ * @param z       The Z coordinate of the point.
+ * @param radius  The largest distance from the point (the boundary is included).
+ * @param visit   The function to call, it receives the element itself (still owned by the index) and the context.
+ * @param context Any pointer, passed as is to every call of visit.
+ * @return success if every element within the radius was visited, the first status other than success
+ *         returned by visit, failure if the parameters are invalid, or Memory_Problem if allocation failed.
+ */
+status forEachInSpatialRadius(spatialIndex index, double x, double y, double z, double radius, VisitFunction visit, Element context);
+/**
+ * @brief Returns the number of elements in the index.
+ *
+ * @param index A pointer to the index.
+ * @return The number of elements, or -1 if the index is NULL.
+ */
+int getSpatialIndexSize(spatialIndex index);
+/**
+ * @brief Prints all elements, in the order of the tree.
+ *
+ * @param index A pointer to the index.
+ * @return success on success, failure if the index is NULL.
+ */
+status displaySpatialIndex(spatialIndex index);
+#endif
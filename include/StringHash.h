@@ -0,0 +1,28 @@
+#ifndef STRING_HASH_H
+#define STRING_HASH_H
+#include "Defs.h"
+/**
+ * Built-in 64-bit hash functions for string keys.
+ * All of them match HashFunction, so they can be given to setHashFunction.
+ */
+
+/**
+ * Hashes a string in the style of wyhash: the string is read 8 bytes at a time and every block is
+ * folded in with a 64x64->128 bit multiply. Fast and well distributed, recommended for string keys.
+ *
+ * @param str A pointer to the string element.
+ * @param seed The seed of the hash (different seeds give unrelated hashes).
+ * @return The hash of the string, or 0 if the input is NULL.
+ */
+unsigned long long wyhashString(Element str, unsigned long long seed);
+
+/**
+ * Hashes a string with seeded 64-bit FNV-1a (one byte at a time).
+ * Slower than wyhashString, kept as a simple reference member of the family.
+ *
+ * @param str A pointer to the string element.
+ * @param seed The seed of the hash.
+ * @return The hash of the string, or 0 if the input is NULL.
+ */
+unsigned long long fnv1aString(Element str, unsigned long long seed);
+#endif
@@ -0,0 +1,296 @@
+#ifndef TYPED_HASH_TABLE_H
+#define TYPED_HASH_TABLE_H
+#include <time.h>
+#include "Defs.h"
+/**
+ * A generator of statically typed hash tables, the compile-time counterpart of HashTable.h.
+ *
+ * DEFINE_HASHTABLE(Name, KeyType, ValueType, hashFunction, equalFunction) expands to a table type Name
+ * and static inline functions over it. The hash and equal functions are called by name, not through
+ * pointers, so the compiler can inline them together with the probing loop.
+ *
+ * hashFunction: unsigned long long hashFunction(KeyType key, unsigned long long seed) (e.g. wyhashString).
+ * equalFunction: bool equalFunction(KeyType key1, KeyType key2).
+ *
+ * The generated functions (for Name = JerryById):
+ *   JerryById JerryById_create(int expected)          - NULL if there was a problem
+ *   status JerryById_destroy(JerryById table)
+ *   status JerryById_add(JerryById table, KeyType key, ValueType value)
+ *   ValueType* JerryById_lookup(JerryById table, KeyType key)
+ *   status JerryById_remove(JerryById table, KeyType key)
+ *   int JerryById_count(JerryById table)
+ *
+ * They behave like the open addressing engine of HashTable.h (control bytes, linear probing, cached
+ * hashes, a random seed per table, growing at 7/8 load and shrinking when sparse), with two differences:
+ * - Keys and values are stored by value, never copied or freed, so whatever they point to must outlive the entry.
+ * - The table resizes incrementally like HashTable.c: a resize starts a new slot array and every add and remove
+ *   moves a few slots of the old one into it, so one add never pays for a full rehash. Until the move ends,
+ *   lookups check both arrays.
+ */
+
+#define TYPED_CTRL_EMPTY (-128)   // Control byte of a slot that was never used
+#define TYPED_CTRL_DELETED (-2)   // Control byte of a slot whose entry was removed (tombstone)
+#define TYPED_MIN_SLOTS 8         // Smallest slot array of a generated table
+#define TYPED_REHASH_STEP 8       // Slots moved from the old array by every add and remove during a resize
+
+// Smallest power of two slot count that keeps the given number of entries under a 7/8 load
+static inline int typedSlotsForEntries(int entries) {
+    int size = TYPED_MIN_SLOTS;
+    while (size / 8 * 7 < entries) {
+        size *= 2;
+    }
+    return size;
+}
+
+// Draws the random seed of a table, from the clock, the table address and a counter, mixed by splitmix64
+static inline unsigned long long typedTableSeed(Element table) {
+    static unsigned long long tables = 0;
+    unsigned long long seed = (unsigned long long)time(NULL) ^ (unsigned long long)clock() ^ (unsigned long long)(size_t)table ^ (++tables * 0x9e3779b97f4a7c15ULL);
+    seed += 0x9e3779b97f4a7c15ULL;
+    seed = (seed ^ (seed >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    seed = (seed ^ (seed >> 27)) * 0x94d049bb133111ebULL;
+    return seed ^ (seed >> 31);
+}
+
+#define DEFINE_HASHTABLE(Name, KeyType, ValueType, hashFunction, equalFunction)                                  \
+typedef struct Name##_slot_s {                                                                                     \
+    KeyType key;                                                                                                   \
+    ValueType value;                                                                                               \
+    unsigned long long hash;    /* Full hash of the key, compared before equalFunction is called */                \
+} Name##_slot;                                                                                                     \
+                                                                                                                   \
+typedef struct Name##_store_s {                                                                                    \
+    int size;               /* Number of slots, always a power of two (0 for no storage) */                        \
+    int count;              /* Number of stored entries */                                                         \
+    int tombstones;         /* Number of deleted slots */                                                          \
+    signed char* control;   /* One control byte per slot: empty, deleted or the low 7 bits of the hash */          \
+    Name##_slot* slots;                                                                                            \
+} Name##_store;                                                                                                    \
+                                                                                                                   \
+typedef struct Name##_s {                                                                                          \
+    Name##_store current;   /* Where new entries go */                                                             \
+    Name##_store previous;  /* Storage being migrated into current (size 0 when no resize is running) */           \
+    int migrated;           /* Slots of previous that were already migrated */                                     \
+    int count;              /* Number of entries in both storages */                                               \
+    int minSize;            /* Initial size, the table never shrinks below it */                                   \
+    unsigned long long seed;                                                                                       \
+} *Name;                                                                                                           \
+                                                                                                                   \
+/* Returns the slot index of the key in a storage, or -1 if the key is not stored there */                         \
+static inline int Name##_findSlot(Name##_store* store, KeyType key, unsigned long long hash) {                     \
+    if (store->size == 0) {                                                                                        \
+        return -1;                                                                                                 \
+    }                                                                                                              \
+    signed char tag = (signed char)(hash & 0x7F);                                                                  \
+    int mask = store->size - 1;                                                                                    \
+    int index = (int)((hash >> 7) & (unsigned long long)mask);                                                     \
+    for (int probes = 0; probes < store->size; probes++) {                                                         \
+        signed char control = store->control[index];                                                               \
+        if (control == TYPED_CTRL_EMPTY) {                                                                         \
+            return -1; /* The probe sequence ends at the first never used slot */                                  \
+        }                                                                                                          \
+        if (control == tag && store->slots[index].hash == hash && equalFunction(store->slots[index].key, key)) {   \
+            return index;                                                                                          \
+        }                                                                                                          \
+        index = (index + 1) & mask;                                                                                \
+    }                                                                                                              \
+    return -1;                                                                                                     \
+}                                                                                                                  \
+                                                                                                                   \
+/* Puts an entry into the first free slot of its probe sequence (the key must not be stored already) */            \
+static inline void Name##_place(Name##_store* store, KeyType key, ValueType value, unsigned long long hash) {      \
+    int mask = store->size - 1;                                                                                    \
+    int index = (int)((hash >> 7) & (unsigned long long)mask);                                                     \
+    while (store->control[index] != TYPED_CTRL_EMPTY && store->control[index] != TYPED_CTRL_DELETED) {             \
+        index = (index + 1) & mask;                                                                                \
+    }                                                                                                              \
+    if (store->control[index] == TYPED_CTRL_DELETED) {                                                             \
+        store->tombstones--; /* Reusing a tombstone */                                                             \
+    }                                                                                                              \
+    store->control[index] = (signed char)(hash & 0x7F);                                                            \
+    store->slots[index].key = key;                                                                                 \
+    store->slots[index].value = value;                                                                             \
+    store->slots[index].hash = hash;                                                                               \
+    store->count++;                                                                                                \
+}                                                                                                                  \
+                                                                                                                   \
+/* Empties a slot of a storage */                                                                                  \
+static inline void Name##_clear(Name##_store* store, int slot) {                                                   \
+    /* A slot followed by an empty one ends no probe sequence, so it can become empty again */                     \
+    if (store->control[(slot + 1) & (store->size - 1)] == TYPED_CTRL_EMPTY) {                                      \
+        store->control[slot] = TYPED_CTRL_EMPTY;                                                                   \
+    } else {                                                                                                       \
+        store->control[slot] = TYPED_CTRL_DELETED;                                                                 \
+        store->tombstones++;                                                                                       \
+    }                                                                                                              \
+    store->count--;                                                                                                \
+}                                                                                                                  \
+                                                                                                                   \
+static inline status Name##_initStore(Name##_store* store, int size) {                                             \
+    store->control = (signed char*)malloc(size * sizeof(signed char));                                             \
+    store->slots = (Name##_slot*)malloc(size * sizeof(Name##_slot));                                               \
+    if (store->control == NULL || store->slots == NULL) {                                                          \
+        free(store->control);                                                                                      \
+        free(store->slots);                                                                                        \
+        return Memory_Problem;                                                                                     \
+    }                                                                                                              \
+    memset(store->control, TYPED_CTRL_EMPTY, size * sizeof(signed char));                                          \
+    store->size = size;                                                                                            \
+    store->count = 0;                                                                                              \
+    store->tombstones = 0;                                                                                         \
+    return success;                                                                                                \
+}                                                                                                                  \
+                                                                                                                   \
+static inline void Name##_releaseStore(Name##_store* store) {                                                      \
+    free(store->control);                                                                                          \
+    free(store->slots);                                                                                            \
+    store->control = NULL;                                                                                         \
+    store->slots = NULL;                                                                                           \
+    store->size = 0;                                                                                               \
+    store->count = 0;                                                                                              \
+    store->tombstones = 0;                                                                                         \
+}                                                                                                                  \
+                                                                                                                   \
+/* Moves the next few slots of the old storage into the current one */                                             \
+static inline void Name##_migrateStep(Name table) {                                                                \
+    if (table->previous.size == 0) {                                                                               \
+        return; /* No resize is running */                                                                         \
+    }                                                                                                              \
+    for (int budget = TYPED_REHASH_STEP; budget > 0 && table->migrated < table->previous.size; budget--) {         \
+        int i = table->migrated++;                                                                                 \
+        if (table->previous.control[i] >= 0) {                                                                     \
+            Name##_slot slot = table->previous.slots[i];                                                           \
+            Name##_place(&table->current, slot.key, slot.value, slot.hash);                                        \
+            table->previous.control[i] = TYPED_CTRL_DELETED; /* Keeps the old probe sequences intact */            \
+            table->previous.count--;                                                                               \
+        }                                                                                                          \
+    }                                                                                                              \
+    if (table->migrated == table->previous.size) {                                                                 \
+        Name##_releaseStore(&table->previous); /* Every entry now lives in the current storage */                  \
+    }                                                                                                              \
+}                                                                                                                  \
+                                                                                                                   \
+/* Starts migrating the table into a new storage of the given size */                                              \
+static inline status Name##_startResize(Name table, int newSize) {                                                 \
+    /* A running resize is finished first, only two generations are kept at a time */                              \
+    while (table->previous.size != 0) {                                                                            \
+        Name##_migrateStep(table);                                                                                 \
+    }                                                                                                              \
+    Name##_store next;                                                                                             \
+    if (Name##_initStore(&next, newSize) != success) {                                                             \
+        return Memory_Problem;                                                                                     \
+    }                                                                                                              \
+    table->previous = table->current;                                                                              \
+    table->current = next;                                                                                         \
+    table->migrated = 0;                                                                                           \
+    Name##_migrateStep(table);                                                                                     \
+    return success;                                                                                                \
+}                                                                                                                  \
+                                                                                                                   \
+static inline Name Name##_create(int expected) {                                                                   \
+    if (expected < 1) {                                                                                            \
+        return NULL;                                                                                               \
+    }                                                                                                              \
+    Name table = (Name)malloc(sizeof(struct Name##_s));                                                            \
+    if (table == NULL) {                                                                                           \
+        return NULL;                                                                                               \
+    }                                                                                                              \
+    table->minSize = typedSlotsForEntries(expected);                                                               \
+    if (Name##_initStore(&table->current, table->minSize) != success) {                                            \
+        free(table);                                                                                               \
+        return NULL;                                                                                               \
+    }                                                                                                              \
+    table->previous.size = 0; /* No resize is running yet */                                                       \
+    table->previous.count = 0;                                                                                     \
+    table->previous.tombstones = 0;                                                                                \
+    table->previous.control = NULL;                                                                                \
+    table->previous.slots = NULL;                                                                                  \
+    table->migrated = 0;                                                                                           \
+    table->count = 0;                                                                                              \
+    table->seed = typedTableSeed(table);                                                                           \
+    return table;                                                                                                  \
+}                                                                                                                  \
+                                                                                                                   \
+static inline status Name##_destroy(Name table) {                                                                  \
+    if (table == NULL) {                                                                                           \
+        return failure;                                                                                            \
+    }                                                                                                              \
+    Name##_releaseStore(&table->previous);                                                                         \
+    Name##_releaseStore(&table->current);                                                                          \
+    free(table);                                                                                                   \
+    return success;                                                                                                \
+}                                                                                                                  \
+                                                                                                                   \
+/* Adds an entry, returns failure if the key is already stored or memory ran out */                                \
+static inline status Name##_add(Name table, KeyType key, ValueType value) {                                        \
+    if (table == NULL) {                                                                                           \
+        return failure;                                                                                            \
+    }                                                                                                              \
+    Name##_migrateStep(table);                                                                                     \
+    unsigned long long hash = hashFunction(key, table->seed);                                                      \
+    if (Name##_findSlot(&table->current, key, hash) != -1 || Name##_findSlot(&table->previous, key, hash) != -1) { \
+        return failure;                                                                                            \
+    }                                                                                                              \
+    /* Grow (or just drop the tombstones) before the slots get too full to probe quickly */                        \
+    Name##_store* store = &table->current;                                                                         \
+    if (store->count + store->tombstones + 1 > store->size / 8 * 7) {                                              \
+        int newSize = store->size;                                                                                 \
+        while (newSize / 2 < table->count + 1) {                                                                   \
+            newSize *= 2;                                                                                          \
+        }                                                                                                          \
+        if (Name##_startResize(table, newSize) != success && store->count + store->tombstones + 1 >= store->size) { \
+            return failure; /* Could not grow and no free slot is left */                                          \
+        }                                                                                                          \
+    }                                                                                                              \
+    Name##_place(&table->current, key, value, hash);                                                               \
+    table->count++;                                                                                                \
+    return success;                                                                                                \
+}                                                                                                                  \
+                                                                                                                   \
+/* Returns the stored value of the key (valid until the next add or remove), or NULL if it is not stored */        \
+static inline ValueType* Name##_lookup(Name table, KeyType key) {                                                  \
+    if (table == NULL) {                                                                                           \
+        return NULL;                                                                                               \
+    }                                                                                                              \
+    unsigned long long hash = hashFunction(key, table->seed);                                                      \
+    int slot = Name##_findSlot(&table->current, key, hash);                                                        \
+    if (slot != -1) {                                                                                              \
+        return &table->current.slots[slot].value;                                                                  \
+    }                                                                                                              \
+    slot = Name##_findSlot(&table->previous, key, hash);                                                           \
+    return slot == -1 ? NULL : &table->previous.slots[slot].value;                                                 \
+}                                                                                                                  \
+                                                                                                                   \
+/* Removes the entry of the key, returns Not_Exist if it is not stored */                                          \
+static inline status Name##_remove(Name table, KeyType key) {                                                      \
+    if (table == NULL) {                                                                                           \
+        return failure;                                                                                            \
+    }                                                                                                              \
+    Name##_migrateStep(table);                                                                                     \
+    unsigned long long hash = hashFunction(key, table->seed);                                                      \
+    int slot = Name##_findSlot(&table->current, key, hash);                                                        \
+    if (slot != -1) {                                                                                              \
+        Name##_clear(&table->current, slot);                                                                       \
+    } else {                                                                                                       \
+        slot = Name##_findSlot(&table->previous, key, hash);                                                       \
+        if (slot == -1) {                                                                                          \
+            return Not_Exist;                                                                                      \
+        }                                                                                                          \
+        Name##_clear(&table->previous, slot);                                                                      \
+    }                                                                                                              \
+    table->count--;                                                                                                \
+    /* Shrink when the table became too sparse, on failure it simply stays large */                                \
+    if (table->previous.size == 0 && table->current.size > table->minSize && table->count < table->current.size / 8) { \
+        Name##_startResize(table, table->current.size / 2);                                                        \
+    }                                                                                                              \
+    return success;                                                                                                \
+}                                                                                                                  \
+                                                                                                                   \
+static inline int Name##_count(Name table) {                                                                       \
+    if (table == NULL) {                                                                                           \
+        return -1;                                                                                                 \
+    }                                                                                                              \
+    return table->count;                                                                                           \
+}
+
+#endif
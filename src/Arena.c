@@ -0,0 +1,145 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Arena.h"
+#define ARENA_ALIGNMENT 16 // Every object is aligned for any basic type
+
+// Header of a block, the objects follow it
+typedef struct block_s {
+    struct block_s* next;
+    union {
+        long double align_ld;
+        void* align_ptr;
+        long long align_ll;
+    } align; // Keeps the first object aligned
+} Block;
+
+struct arena_s {
+    int blockSize;      // Bytes of objects in a regular block
+    Block* blocks;      // All the blocks, the one objects are taken from first
+    int usedInBlock;    // Bytes already handed out from the first block
+    long bytes;         // Bytes handed out since the arena was created
+    long blockCount;    // Blocks malloced since the arena was created
+};
+
+arena createArena(int blockSize) {
+    if (blockSize < ARENA_ALIGNMENT) {
+        return NULL;
+    }
+    arena region = (arena)malloc(sizeof(struct arena_s));
+    if (region == NULL) {
+        return NULL;
+    }
+    region->blockSize = blockSize / ARENA_ALIGNMENT * ARENA_ALIGNMENT;
+    region->blocks = NULL;
+    region->usedInBlock = region->blockSize; // No block yet, the first allocation mallocs one
+    region->bytes = 0;
+    region->blockCount = 0;
+    return region;
+}
+
+status destroyArena(arena region) {
+    if (region == NULL) {
+        return failure;
+    }
+    // Release the blocks, not the objects one by one
+    Block* curr = region->blocks;
+    while (curr != NULL) {
+        Block* next = curr->next;
+        free(curr);
+        curr = next;
+    }
+    free(region);
+    return success;
+}
+
+status mergeArena(arena into, arena from) {
+    if (into == NULL || from == NULL || into == from) {
+        return failure;
+    }
+    if (from->blocks != NULL) {
+        Block* last = from->blocks;
+        while (last->next != NULL) {
+            last = last->next;
+        }
+        if (into->blocks == NULL) {
+            // The blocks of from become all the blocks, its first one keeps its free space if the sizes match
+            into->blocks = from->blocks;
+            into->usedInBlock = from->blockSize == into->blockSize ? from->usedInBlock : into->blockSize;
+        } else {
+            // Behind the first block, so its free space is kept
+            last->next = into->blocks->next;
+            into->blocks->next = from->blocks;
+        }
+    }
+    into->bytes += from->bytes;
+    into->blockCount += from->blockCount;
+    free(from);
+    return success;
+}
+
+Element allocateFromArena(arena region, int size) {
+    if (region == NULL || size < 0) {
+        return NULL;
+    }
+    size = (size + ARENA_ALIGNMENT - 1) / ARENA_ALIGNMENT * ARENA_ALIGNMENT;
+    if (size > region->blockSize / 4) {
+        // A large object gets a block of its own, behind the first one so its free space is kept
+        Block* block = (Block*)malloc(sizeof(Block) + (size_t)size);
+        if (block == NULL) {
+            return NULL;
+        }
+        if (region->blocks == NULL) {
+            block->next = NULL;
+            region->blocks = block; // The arena stays full, the next small object starts a block
+        } else {
+            block->next = region->blocks->next;
+            region->blocks->next = block;
+        }
+        region->blockCount++;
+        region->bytes += size;
+        return block + 1;
+    }
+    // Start a new block when the first one has no room left
+    if (region->usedInBlock + size > region->blockSize) {
+        Block* block = (Block*)malloc(sizeof(Block) + (size_t)region->blockSize);
+        if (block == NULL) {
+            return NULL;
+        }
+        block->next = region->blocks;
+        region->blocks = block;
+        region->usedInBlock = 0;
+        region->blockCount++;
+    }
+    Element object = (char*)(region->blocks + 1) + region->usedInBlock;
+    region->usedInBlock += size;
+    region->bytes += size;
+    return object;
+}
+
+char* copyStringToArena(arena region, char* str) {
+    if (region == NULL || str == NULL) {
+        return NULL;
+    }
+    size_t length = strlen(str) + 1;
+    char* copy = (char*)allocateFromArena(region, (int)length);
+    if (copy == NULL) {
+        return NULL;
+    }
+    memcpy(copy, str, length);
+    return copy;
+}
+
+long getArenaBytes(arena region) {
+    if (region == NULL) {
+        return -1;
+    }
+    return region->bytes;
+}
+
+long getArenaBlocks(arena region) {
+    if (region == NULL) {
+        return -1;
+    }
+    return region->blockCount;
+}
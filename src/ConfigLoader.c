@@ -0,0 +1,424 @@
+//
+// Loads the configuration file of the daycare, the Jerries section on several threads.
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "Arena.h"
+#include "ConfigLoader.h"
+#include "ConfigParser.h"
+#include "StringHash.h"
+#include "TypedHashTable.h"
+#define CHUNK_ARENA_BLOCK_SIZE 65536 // Block size of the arena of a chunk
+#define CHUNK_INITIAL_CAPACITY 64    // Entries of a new array of a chunk, it doubles when full
+#define LOCAL_NAMES_CAPACITY 16      // Names of a new local catalog of a chunk
+
+static bool equal_names(char* name1, char* name2) {
+    return strcmp(name1, name2) == 0;
+}
+
+// The characteristic names a chunk met, keyed by the name (owned by the chunk), the value is the local id
+DEFINE_HASHTABLE(LocalNameIds, char*, int, wyhashString, equal_names)
+
+// What the handlers of a line by line load fill
+typedef struct ConfigContext_struct {
+    PlanetsManager* manager;
+    linkedlist Jerries;
+} ConfigContext;
+
+// A Jerry created by a chunk
+typedef struct LoadedJerry_struct {
+    Jerry* jerry;
+    char* planet; // The name of its planet when the manager did not have it (the Jerry points to the placeholder), or NULL
+} LoadedJerry;
+
+// A characteristic met before the first Jerry of a chunk, it belongs to the last Jerry of an earlier chunk
+typedef struct PendingCharacteristic_struct {
+    char* name;
+    double value;
+} PendingCharacteristic;
+
+// A part of the Jerries section, loaded by one thread
+typedef struct Chunk_struct {
+    const char* data;              // The lines of the chunk, the first one is a Jerry line
+    long size;
+    PlanetsManager* manager;       // Shared by all chunks, only read while they are loaded
+    Element arena;                 // The arena of the Jerries of the chunk (NULL when the manager mallocs them)
+    LoadedJerry* jerries;          // The Jerries of the chunk, in the order of the file
+    int count;
+    int capacity;
+    char** names;                  // The characteristic names of the chunk, names[id] has the local id
+    int names_count;
+    int names_capacity;
+    LocalNameIds names_index;
+    PendingCharacteristic* pending;
+    int pending_count;
+    int pending_capacity;
+    Planet placeholder;            // The planet of Jerries from unknown planets until the merge
+    long parsed;                   // Bytes parsed before a section header, size when there was none
+    status result;
+} Chunk;
+
+// Copies a string with malloc
+static char* copy_name(char* name) {
+    size_t length = strlen(name) + 1;
+    char* copy = (char*)malloc(length);
+    if (copy != NULL) {
+        memcpy(copy, name, length);
+    }
+    return copy;
+}
+
+// Doubles an array when it is full, returns false if memory allocation failed
+static bool make_room(Element* array, int count, int* capacity, size_t element_size) {
+    if (count < *capacity) {
+        return true;
+    }
+    int new_capacity = *capacity == 0 ? CHUNK_INITIAL_CAPACITY : *capacity * 2;
+    Element temp = realloc(*array, (size_t)new_capacity * element_size);
+    if (temp == NULL) {
+        return false;
+    }
+    *array = temp;
+    *capacity = new_capacity;
+    return true;
+}
+
+// --- Line by line ---
+
+// Creates a planet of the configuration file, stops the reading if it failed
+static status load_planet(Element context, char* name, double x, double y, double z) {
+    ConfigContext* config = (ConfigContext*)context;
+    return create_planet(config->manager, name, x, y, z) == NULL ? failure : success;
+}
+
+// Creates a Jerry of the configuration file and adds it to the list, stops the reading if it failed
+static status load_jerry(Element context, char* id, char* dimension, char* planet, int happiness) {
+    ConfigContext* config = (ConfigContext*)context;
+    Jerry* jerry = create_jerry(id, happiness, dimension, config->manager, planet, 0, 0, 0);
+    if (jerry == NULL) {
+        return failure;
+    }
+    if (appendNode(config->Jerries, jerry) == Memory_Problem) {
+        memory_failure_sign = 1;
+        return Memory_Problem;
+    }
+    return success;
+}
+
+// Adds a characteristic of the configuration file to the last Jerry, stops the reading only if memory ran out
+static status load_characteristic(Element context, char* name, double value) {
+    ConfigContext* config = (ConfigContext*)context;
+    Jerry* last_jerry = getTailContent(config->Jerries);
+    return add_physical_characteristic(last_jerry, name, value) == Memory_Problem ? Memory_Problem : success;
+}
+
+// Loads the Jerries section (starting at data) and whatever follows it line by line
+static status load_jerries_serially(const char* data, long size, ConfigHandlers* handlers, ConfigContext* context) {
+    long parsed;
+    status s = parseConfigJerries(data, size, handlers, context, &parsed);
+    if (s == success && parsed < size) {
+        s = parseConfigBuffer(data + parsed, size - parsed, handlers, context);
+    }
+    return s;
+}
+
+// --- In chunks ---
+
+// Returns the local id of a characteristic name in a chunk, numbering it if it is new, or -1 if memory allocation failed
+static int local_name_id(Chunk* chunk, char* name) {
+    if (chunk->names_index == NULL) {
+        chunk->names_index = LocalNameIds_create(LOCAL_NAMES_CAPACITY);
+        if (chunk->names_index == NULL) {
+            return -1;
+        }
+    }
+    int* id = LocalNameIds_lookup(chunk->names_index, name);
+    if (id != NULL) {
+        return *id;
+    }
+    if (!make_room((Element*)&chunk->names, chunk->names_count, &chunk->names_capacity, sizeof(char*))) {
+        return -1;
+    }
+    char* copy = copy_name(name);
+    if (copy == NULL) {
+        return -1;
+    }
+    if (LocalNameIds_add(chunk->names_index, copy, chunk->names_count) != success) {
+        free(copy);
+        return -1;
+    }
+    chunk->names[chunk->names_count] = copy;
+    return chunk->names_count++;
+}
+
+// Creates a Jerry of a chunk, on the placeholder planet if the manager does not have its planet
+static status chunk_jerry(Element context, char* id, char* dimension, char* planet_name, int happiness) {
+    Chunk* chunk = (Chunk*)context;
+    if (!make_room((Element*)&chunk->jerries, chunk->count, &chunk->capacity, sizeof(LoadedJerry))) {
+        return Memory_Problem;
+    }
+    LoadedJerry* loaded = &chunk->jerries[chunk->count];
+    Planet* planet = find_planet(chunk->manager, planet_name);
+    loaded->planet = NULL;
+    if (planet == NULL) {
+        // Created at the merge, in the order of the file, as create_jerry would have created it
+        loaded->planet = copy_name(planet_name);
+        if (loaded->planet == NULL) {
+            return Memory_Problem;
+        }
+        planet = &chunk->placeholder;
+    }
+    loaded->jerry = create_jerry_on_planet(id, happiness, dimension, planet, chunk->arena);
+    if (loaded->jerry == NULL) {
+        free(loaded->planet);
+        return Memory_Problem;
+    }
+    chunk->count++;
+    return success;
+}
+
+// Adds a characteristic to the last Jerry of a chunk with its local id, or keeps it for the merge if the chunk has no Jerry yet
+static status chunk_characteristic(Element context, char* name, double value) {
+    Chunk* chunk = (Chunk*)context;
+    if (chunk->count == 0) {
+        if (!make_room((Element*)&chunk->pending, chunk->pending_count, &chunk->pending_capacity, sizeof(PendingCharacteristic))) {
+            return Memory_Problem;
+        }
+        PendingCharacteristic* pending = &chunk->pending[chunk->pending_count];
+        pending->name = copy_name(name);
+        if (pending->name == NULL) {
+            return Memory_Problem;
+        }
+        pending->value = value;
+        chunk->pending_count++;
+        return success;
+    }
+    int id = local_name_id(chunk, name);
+    if (id < 0) {
+        return Memory_Problem;
+    }
+    Jerry* last_jerry = chunk->jerries[chunk->count - 1].jerry;
+    return add_physical_characteristic_by_id(last_jerry, id, value) == Memory_Problem ? Memory_Problem : success;
+}
+
+// The thread of a chunk
+static void* load_chunk(void* context) {
+    Chunk* chunk = (Chunk*)context;
+    ConfigHandlers handlers = {NULL, chunk_jerry, chunk_characteristic};
+    chunk->result = parseConfigJerries(chunk->data, chunk->size, &handlers, chunk, &chunk->parsed);
+    return NULL;
+}
+
+// Releases what a chunk still owns, the Jerries from the given one on were not merged
+static void release_chunk(Chunk* chunk, int first_unmerged) {
+    for (int i = first_unmerged; i < chunk->count; i++) {
+        destroy_jerry(chunk->jerries[i].jerry); // Nothing to do for a Jerry of an arena
+    }
+    for (int i = 0; i < chunk->count; i++) {
+        free(chunk->jerries[i].planet);
+    }
+    for (int i = 0; i < chunk->names_count; i++) {
+        free(chunk->names[i]);
+    }
+    for (int i = 0; i < chunk->pending_count; i++) {
+        free(chunk->pending[i].name);
+    }
+    LocalNameIds_destroy(chunk->names_index);
+    free(chunk->jerries);
+    free(chunk->names);
+    free(chunk->pending);
+    if (chunk->arena != NULL) {
+        destroyArena(chunk->arena);
+    }
+}
+
+// Merges a loaded chunk into the manager and the list, sets merged to the number of its Jerries in the list
+static status merge_chunk(Chunk* chunk, PlanetsManager* manager, linkedlist Jerries, int* merged) {
+    *merged = 0;
+    if (chunk->arena != NULL) {
+        mergeArena(manager->arena, chunk->arena);
+        chunk->arena = NULL;
+    }
+    // The characteristics before the first Jerry of the chunk, as load_characteristic adds them
+    for (int i = 0; i < chunk->pending_count; i++) {
+        Jerry* last_jerry = getTailContent(Jerries);
+        if (add_physical_characteristic(last_jerry, chunk->pending[i].name, chunk->pending[i].value) == Memory_Problem) {
+            return Memory_Problem;
+        }
+    }
+    // The names join the catalog in the order the chunk met them, which is the order of the file
+    int* ids = (int*)malloc((chunk->names_count + 1) * sizeof(int));
+    if (ids == NULL) {
+        return Memory_Problem;
+    }
+    for (int i = 0; i < chunk->names_count; i++) {
+        ids[i] = intern_characteristic_name(chunk->names[i]);
+        if (ids[i] < 0) {
+            free(ids);
+            return Memory_Problem;
+        }
+    }
+    status s = success;
+    for (int i = 0; i < chunk->count && s == success; i++) {
+        Jerry* jerry = chunk->jerries[i].jerry;
+        if (chunk->jerries[i].planet != NULL) {
+            Planet* planet = create_planet(manager, chunk->jerries[i].planet, 0, 0, 0);
+            if (planet == NULL) {
+                s = Memory_Problem;
+                break;
+            }
+            jerry->origin->planet = planet;
+        }
+        for (int c = 0; c < jerry->characteristics_count; c++) {
+            jerry->characteristics[c].id = ids[jerry->characteristics[c].id];
+        }
+        jerry->arena = manager->arena;
+        if (appendNode(Jerries, jerry) == Memory_Problem) {
+            memory_failure_sign = 1;
+            s = Memory_Problem;
+            break;
+        }
+        *merged = i + 1;
+    }
+    free(ids);
+    return s;
+}
+
+// Returns the start of the first Jerry line at or after a position of the Jerries section, or size if there is none
+static long next_jerry_line(const char* data, long size, long position) {
+    while (position < size) {
+        // A line that does not start with a tab is not a characteristic, a chunk can start there
+        if ((position == 0 || data[position - 1] == '\n') && data[position] != '\t') {
+            return position;
+        }
+        const char* newline = (const char*)memchr(data + position, '\n', (size_t)(size - position));
+        if (newline == NULL) {
+            return size;
+        }
+        position = newline + 1 - data;
+    }
+    return size;
+}
+
+/*
+ * Loads the Jerries section in chunks on threads. Sets split to false, with nothing changed, when the section
+ * is followed by another one and has to be loaded line by line.
+ */
+static status load_jerries_in_chunks(const char* data, long size, PlanetsManager* manager, linkedlist Jerries,
+                                     int threads, bool* split) {
+    *split = true;
+    Chunk* chunks = (Chunk*)calloc((size_t)threads, sizeof(Chunk));
+    pthread_t* ids = (pthread_t*)malloc((size_t)threads * sizeof(pthread_t));
+    bool* started = (bool*)calloc((size_t)threads, sizeof(bool));
+    if (chunks == NULL || ids == NULL || started == NULL) {
+        free(chunks);
+        free(ids);
+        free(started);
+        return Memory_Problem;
+    }
+    status s = success;
+    long start = 0;
+    for (int i = 0; i < threads; i++) {
+        long end = i == threads - 1 ? size : next_jerry_line(data, size, size / threads * (i + 1));
+        if (end < start) {
+            end = start;
+        }
+        chunks[i].data = data + start;
+        chunks[i].size = end - start;
+        chunks[i].manager = manager;
+        chunks[i].placeholder.name = "";
+        chunks[i].result = success;
+        start = end;
+        if (manager->arena != NULL) {
+            chunks[i].arena = createArena(CHUNK_ARENA_BLOCK_SIZE);
+            if (chunks[i].arena == NULL) {
+                s = Memory_Problem;
+            }
+        }
+    }
+    // Every chunk on a thread of its own, or on this one if no thread can be started
+    for (int i = 0; i < threads && s == success; i++) {
+        started[i] = pthread_create(&ids[i], NULL, load_chunk, &chunks[i]) == 0;
+        if (!started[i]) {
+            load_chunk(&chunks[i]);
+        }
+    }
+    for (int i = 0; i < threads; i++) {
+        if (started[i]) {
+            pthread_join(ids[i], NULL);
+        }
+        if (chunks[i].result == Memory_Problem) {
+            memory_failure_sign = 1; // The threads only report it through their result
+        }
+        if (s == success && chunks[i].result != success) {
+            s = chunks[i].result;
+        }
+        if (chunks[i].parsed < chunks[i].size) {
+            *split = false; // A section header in the middle of the Jerries
+        }
+    }
+    // Merge in the order of the file, the chunks that are not merged are released as they are
+    int merged = 0;
+    for (int i = 0; i < threads; i++) {
+        merged = 0;
+        if (s == success && *split) {
+            s = merge_chunk(&chunks[i], manager, Jerries, &merged);
+        }
+        release_chunk(&chunks[i], merged);
+    }
+    free(chunks);
+    free(ids);
+    free(started);
+    return s;
+}
+
+// Returns the number of threads to load a Jerries section of the given size with
+static int threads_for(long size, int threads) {
+    if (threads <= 0) {
+        long processors = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = processors > 0 ? (int)processors : 1;
+    }
+    if (threads > LOADER_MAX_THREADS) {
+        threads = LOADER_MAX_THREADS;
+    }
+    if (threads > size / LOADER_MIN_CHUNK) {
+        threads = (int)(size / LOADER_MIN_CHUNK);
+    }
+    return threads < 1 ? 1 : threads;
+}
+
+status load_configuration(char* file_name, PlanetsManager* manager, linkedlist Jerries, int threads) {
+    if (file_name == NULL || manager == NULL || Jerries == NULL) {
+        return Invlid_Input;
+    }
+    ConfigText text;
+    status s = mapConfigFile(file_name, &text);
+    if (s != success) {
+        return s;
+    }
+    ConfigContext context = {manager, Jerries};
+    ConfigHandlers handlers = {load_planet, load_jerry, load_characteristic};
+    long jerries = findConfigSection(text.data, text.size, "Jerries");
+    threads = jerries < 0 ? 1 : threads_for(text.size - jerries, threads);
+    if (threads < 2) {
+        s = parseConfigBuffer(text.data, text.size, &handlers, &context);
+    } else {
+        // The planets first, every chunk then finds them in the manager
+        s = parseConfigBuffer(text.data, jerries, &handlers, &context);
+        if (s == success) {
+            bool split;
+            s = load_jerries_in_chunks(text.data + jerries, text.size - jerries, manager, Jerries, threads, &split);
+            if (s == success && !split) {
+                s = load_jerries_serially(text.data + jerries, text.size - jerries, &handlers, &context);
+            }
+        }
+    }
+    unmapConfigFile(&text);
+    if (s == Memory_Problem || memory_failure_sign == 1) {
+        return Memory_Problem;
+    }
+    return success; // A handler that failed without running out of memory stops the load, as a malformed file would
+}
@@ -0,0 +1,350 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "ConfigParser.h"
+#define MAX_EXACT_MANTISSA (1ULL << 53) // Larger mantissas are not exact in a double
+#define MAX_EXACT_POWER 22              // Larger powers of ten are not exact in a double
+#define MAX_MANTISSA_DIGITS 19          // Digits that always fit an unsigned long long
+#define READ_CHUNK 65536                // Bytes read at once from a file that cannot be mapped
+
+// The sections of a configuration file
+typedef enum e_section { NoSection, PlanetsSection, JerriesSection } Section;
+
+static const double powersOfTen[MAX_EXACT_POWER + 1] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// The white space skipped before a number, as by scanf
+static int isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+static int isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+// Parses a double at p (after white space), returns the end of the number or NULL if there is none
+static const char* parseDouble(const char* p, double* value) {
+    while (isSpace(*p)) {
+        p++;
+    }
+    const char* start = p;
+    int negative = *p == '-';
+    if (*p == '-' || *p == '+') {
+        p++;
+    }
+    unsigned long long mantissa = 0;
+    int digits = 0;         // Significant digits in the mantissa
+    int seen = 0;           // Digits read, with leading zeros
+    int exponent = 0;
+    int exact = 1;          // The fast path gives the same double as strtod
+    for (; isDigit(*p); p++, seen++) {
+        if (digits < MAX_MANTISSA_DIGITS) {
+            mantissa = mantissa * 10 + (unsigned long long)(*p - '0');
+            digits += mantissa != 0;
+        } else {
+            exact = 0;
+        }
+    }
+    if (*p == '.') {
+        for (p++; isDigit(*p); p++, seen++) {
+            if (digits < MAX_MANTISSA_DIGITS) {
+                mantissa = mantissa * 10 + (unsigned long long)(*p - '0');
+                digits += mantissa != 0;
+                exponent--;
+            } else {
+                exact = 0;
+            }
+        }
+    }
+    if (seen == 0 || *p == 'x' || *p == 'X') {
+        exact = 0; // No digits (inf, nan, or not a number) or a hexadecimal number
+    } else if (*p == 'e' || *p == 'E') {
+        const char* e = p + 1;
+        int negativeExponent = *e == '-';
+        if (*e == '-' || *e == '+') {
+            e++;
+        }
+        if (isDigit(*e)) {
+            int power = 0;
+            for (; isDigit(*e); e++) {
+                if (power < 10000) {
+                    power = power * 10 + (*e - '0');
+                }
+            }
+            exponent += negativeExponent ? -power : power;
+            p = e;
+        }
+    }
+    if (exact && mantissa <= MAX_EXACT_MANTISSA && exponent >= -MAX_EXACT_POWER && exponent <= MAX_EXACT_POWER) {
+        // Both the mantissa and the power of ten are exact, so one operation rounds correctly
+        double result = (double)mantissa;
+        result = exponent < 0 ? result / powersOfTen[-exponent] : result * powersOfTen[exponent];
+        *value = negative ? -result : result;
+        return p;
+    }
+    char* end;
+    *value = strtod(start, &end);
+    return end == start ? NULL : end;
+}
+
+// Parses an int at p (after white space), returns the end of the number or NULL if there is none
+static const char* parseInt(const char* p, int* value) {
+    while (isSpace(*p)) {
+        p++;
+    }
+    int negative = *p == '-';
+    if (*p == '-' || *p == '+') {
+        p++;
+    }
+    if (!isDigit(*p)) {
+        return NULL;
+    }
+    long long result = 0;
+    for (; isDigit(*p); p++) {
+        if (result <= 2147483648LL) {
+            result = result * 10 + (*p - '0');
+        }
+    }
+    *value = (int)(negative ? -result : result);
+    return p;
+}
+
+// Ends the field that starts at field at the next separator, returns the character after it or NULL if the field is empty or has no end
+static char* cutField(char* field, char* end, char separator) {
+    char* cut = (char*)memchr(field, separator, (size_t)(end - field));
+    if (cut == NULL || cut == field) {
+        return NULL;
+    }
+    *cut = '\0';
+    return cut + 1;
+}
+
+// Returns the section a header line starts, or NoSection if the line is not a header
+static Section headerOf(const char* line) {
+    if (strcmp(line, "Planets") == 0) {
+        return PlanetsSection;
+    }
+    if (strcmp(line, "Jerries") == 0) {
+        return JerriesSection;
+    }
+    return NoSection;
+}
+
+// Parses one entry line (a NUL terminated copy of at most CONFIG_MAX_LINE characters) and calls its handler
+static status parseLine(char* line, int length, Section section, ConfigHandlers* handlers, Element context) {
+    char* end = line + length;
+    if (section == PlanetsSection) {
+        char* rest = cutField(line, end, ',');
+        double x, y, z;
+        const char* p;
+        if (rest == NULL || (p = parseDouble(rest, &x)) == NULL || *p != ',' || (p = parseDouble(p + 1, &y)) == NULL
+            || *p != ',' || parseDouble(p + 1, &z) == NULL) {
+            return success; // Not a planet
+        }
+        return handlers->planet != NULL ? handlers->planet(context, line, x, y, z) : success;
+    }
+    if (section != JerriesSection) {
+        return success;
+    }
+    if (line[0] == '\t') {
+        char* rest = cutField(line + 1, end, ':');
+        double value;
+        if (rest == NULL || parseDouble(rest, &value) == NULL) {
+            return success; // Not a characteristic
+        }
+        return handlers->characteristic != NULL ? handlers->characteristic(context, line + 1, value) : success;
+    }
+    char* dimension = cutField(line, end, ',');
+    char* planet = dimension == NULL ? NULL : cutField(dimension, end, ',');
+    char* happiness = planet == NULL ? NULL : cutField(planet, end, ',');
+    int value;
+    if (happiness == NULL || parseInt(happiness, &value) == NULL) {
+        return success; // Not a Jerry
+    }
+    return handlers->jerry != NULL ? handlers->jerry(context, line, dimension, planet, value) : success;
+}
+
+/*
+ * Parses the lines of data starting in the given section. A header line switches the section, or, with
+ * stopAtHeader, ends the parsing: parsed receives the offset of the header (size when there is none).
+ */
+static status parseLines(const char* data, long size, Section section, bool stopAtHeader, ConfigHandlers* handlers,
+                         Element context, long* parsed) {
+    char line[CONFIG_MAX_LINE + 1];
+    const char* p = data;
+    const char* end = data + size;
+    while (p < end) {
+        const char* newline = (const char*)memchr(p, '\n', (size_t)(end - p));
+        const char* lineEnd = newline != NULL ? newline : end;
+        // A long line is read in pieces, each one parsed as a line
+        do {
+            int length = lineEnd - p > CONFIG_MAX_LINE ? CONFIG_MAX_LINE : (int)(lineEnd - p);
+            memcpy(line, p, (size_t)length);
+            line[length] = '\0';
+            Section header = headerOf(line);
+            if (header != NoSection && stopAtHeader) {
+                *parsed = p - data;
+                return success;
+            }
+            const char* start = p;
+            p += length;
+            if (header != NoSection) {
+                section = header;
+                continue;
+            }
+            status s = parseLine(line, length, section, handlers, context);
+            if (s != success) {
+                *parsed = start - data; // The lines before it were handled
+                return s;
+            }
+        } while (p < lineEnd);
+        p = lineEnd + 1;
+    }
+    *parsed = size;
+    return success;
+}
+
+status parseConfigBuffer(const char* data, long size, ConfigHandlers* handlers, Element context) {
+    if ((data == NULL && size > 0) || size < 0 || handlers == NULL) {
+        return Invlid_Input;
+    }
+    long parsed;
+    return parseLines(data, size, NoSection, false, handlers, context, &parsed);
+}
+
+status parseConfigJerries(const char* data, long size, ConfigHandlers* handlers, Element context, long* parsed) {
+    if ((data == NULL && size > 0) || size < 0 || handlers == NULL || parsed == NULL) {
+        return Invlid_Input;
+    }
+    return parseLines(data, size, JerriesSection, true, handlers, context, parsed);
+}
+
+long findConfigSection(const char* data, long size, char* header) {
+    if ((data == NULL && size > 0) || size < 0 || header == NULL) {
+        return -1;
+    }
+    char line[CONFIG_MAX_LINE + 1];
+    const char* p = data;
+    const char* end = data + size;
+    while (p < end) {
+        const char* newline = (const char*)memchr(p, '\n', (size_t)(end - p));
+        const char* lineEnd = newline != NULL ? newline : end;
+        do {
+            int length = lineEnd - p > CONFIG_MAX_LINE ? CONFIG_MAX_LINE : (int)(lineEnd - p);
+            memcpy(line, p, (size_t)length);
+            line[length] = '\0';
+            p += length;
+            if (strcmp(line, header) == 0) {
+                // The section starts after the header, on the next line unless the header is a piece of a long line
+                return p < lineEnd ? p - data : (lineEnd < end ? lineEnd + 1 - data : size);
+            }
+        } while (p < lineEnd);
+        p = lineEnd + 1;
+    }
+    return -1;
+}
+
+// Reads a whole file that cannot be mapped, returns a malloced buffer or NULL
+static char* readWholeFile(int fd, long* size) {
+    long capacity = READ_CHUNK;
+    long used = 0;
+    char* data = (char*)malloc((size_t)capacity);
+    while (data != NULL) {
+        if (used == capacity) {
+            char* temp = (char*)realloc(data, (size_t)capacity * 2);
+            if (temp == NULL) {
+                break;
+            }
+            data = temp;
+            capacity *= 2;
+        }
+        ssize_t got = read(fd, data + used, (size_t)(capacity - used));
+        if (got < 0) {
+            break;
+        }
+        if (got == 0) {
+            *size = used;
+            return data;
+        }
+        used += got;
+    }
+    free(data);
+    return NULL;
+}
+
+status mapConfigFile(char* path, ConfigText* text) {
+    if (path == NULL || text == NULL) {
+        return Invlid_Input;
+    }
+    text->data = NULL;
+    text->size = 0;
+    text->mapped = false;
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return Invlid_Input;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        return Invlid_Input;
+    }
+    if (S_ISREG(info.st_mode) && info.st_size == 0) {
+        close(fd);
+        return success; // Nothing to map
+    }
+    if (S_ISREG(info.st_mode)) {
+        void* mapped = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped != MAP_FAILED) {
+            close(fd); // The mapping stays valid
+            madvise(mapped, (size_t)info.st_size, MADV_SEQUENTIAL);
+            text->data = (const char*)mapped;
+            text->size = (long)info.st_size;
+            text->mapped = true;
+            return success;
+        }
+    }
+    // Not a regular file, or one that cannot be mapped: read it at once
+    long size = 0;
+    char* data = readWholeFile(fd, &size);
+    close(fd);
+    if (data == NULL) {
+        return Memory_Problem;
+    }
+    text->data = data;
+    text->size = size;
+    return success;
+}
+
+void unmapConfigFile(ConfigText* text) {
+    if (text == NULL || text->data == NULL) {
+        return;
+    }
+    if (text->mapped) {
+        munmap((void*)text->data, (size_t)text->size);
+    } else {
+        free((void*)text->data);
+    }
+    text->data = NULL;
+    text->size = 0;
+    text->mapped = false;
+}
+
+status parseConfigFile(char* path, ConfigHandlers* handlers, Element context) {
+    if (path == NULL || handlers == NULL) {
+        return Invlid_Input;
+    }
+    ConfigText text;
+    status s = mapConfigFile(path, &text);
+    if (s != success) {
+        return s;
+    }
+    s = parseConfigBuffer(text.data, text.size, handlers, context);
+    unmapConfigFile(&text);
+    return s;
+}
@@ -0,0 +1,204 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "ConfigParser.h"
+#define LINE_SIZE 300
+#define DEFAULT_JERRIES 500000
+#define DEFAULT_ROUNDS 5
+#define PLANETS 1000
+#define CHARACTERISTICS_PER_JERRY 3
+/**
+ * Measures reading a configuration file with fgets and sscanf (the way the daycare read it before
+ * ConfigParser) against parseConfigFile, in MB of configuration per second.
+ * Usage: ./ConfigParserBench [numberOfJerries] [numberOfRounds]
+ * The file is generated in /tmp and removed at the end. Each side reads it once per round and the best
+ * round is kept. Both sides must see the same entries with the same values, or the benchmark fails.
+ */
+
+// What a reader saw in the file
+typedef struct Totals_struct {
+    long planets;
+    long jerries;
+    long characteristics;
+    double coordinates;
+    long happiness;
+    double values;
+} Totals;
+
+static status countPlanet(Element context, char* name, double x, double y, double z) {
+    Totals* totals = (Totals*)context;
+    (void)name;
+    totals->planets++;
+    totals->coordinates += x + y + z;
+    return success;
+}
+
+static status countJerry(Element context, char* id, char* dimension, char* planet, int happiness) {
+    Totals* totals = (Totals*)context;
+    (void)id;
+    (void)dimension;
+    (void)planet;
+    totals->jerries++;
+    totals->happiness += happiness;
+    return success;
+}
+
+static status countCharacteristic(Element context, char* name, double value) {
+    Totals* totals = (Totals*)context;
+    (void)name;
+    totals->characteristics++;
+    totals->values += value;
+    return success;
+}
+
+// The reading loop of the daycare before ConfigParser, with the same handlers
+static status readWithScanf(char* path, Totals* totals) {
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        return Invlid_Input;
+    }
+    char buffer[LINE_SIZE];
+    int reading_planets = 0;
+    int reading_jerries = 0;
+    while (fgets(buffer, sizeof(buffer), file)) {
+        buffer[strcspn(buffer, "\n")] = '\0';
+        if (strcmp(buffer, "Planets") == 0) {
+            reading_planets = 1;
+            reading_jerries = 0;
+            continue;
+        }
+        if (strcmp(buffer, "Jerries") == 0) {
+            reading_jerries = 1;
+            reading_planets = 0;
+            continue;
+        }
+        if (reading_planets) {
+            char name[LINE_SIZE];
+            double x, y, z;
+            if (sscanf(buffer, "%299[^,],%lf,%lf,%lf", name, &x, &y, &z) == 4) {
+                countPlanet(totals, name, x, y, z);
+            }
+        }
+        if (reading_jerries) {
+            if (buffer[0] == '\t') {
+                char name[LINE_SIZE];
+                double value;
+                if (sscanf(buffer + 1, "%299[^:]:%lf", name, &value) == 2) {
+                    countCharacteristic(totals, name, value);
+                }
+            } else {
+                char id[LINE_SIZE];
+                char dimension[LINE_SIZE];
+                char planet[LINE_SIZE];
+                int happiness;
+                if (sscanf(buffer, "%299[^,],%299[^,],%299[^,],%d", id, dimension, planet, &happiness) == 4) {
+                    countJerry(totals, id, dimension, planet, happiness);
+                }
+            }
+        }
+    }
+    fclose(file);
+    return success;
+}
+
+// Writes a configuration file of the given size, returns its size in bytes or -1
+static long writeConfiguration(char* path, int jerryCount) {
+    const char* characteristics[] = {"Height", "Weight", "Age", "LimbsNumber", "Intelligence"};
+    FILE* file = fopen(path, "w");
+    if (file == NULL) {
+        return -1;
+    }
+    unsigned int state = 12345;
+    fprintf(file, "Planets\n");
+    for (int i = 0; i < PLANETS; i++) {
+        state = state * 1103515245u + 12345u;
+        fprintf(file, "Planet%d,%.2f,%.3f,%.1f\n", i, (double)(state >> 8) / 1000.0, -(double)(state >> 16) / 7.0,
+                (double)(i * 17 % 1000));
+    }
+    fprintf(file, "Jerries\n");
+    for (int i = 0; i < jerryCount; i++) {
+        state = state * 1103515245u + 12345u;
+        fprintf(file, "J%d,C-%u,Planet%d,%u\n", i, state % 1000, i % PLANETS, (state >> 16) % 101);
+        for (int c = 0; c < CHARACTERISTICS_PER_JERRY; c++) {
+            state = state * 1103515245u + 12345u;
+            fprintf(file, "\t%s:%.2f\n", characteristics[(i + c) % 5], (double)(state >> 12) / 100.0);
+        }
+    }
+    long size = ftell(file);
+    if (fclose(file) != 0) {
+        return -1;
+    }
+    return size;
+}
+
+// Returns the seconds of processor time since start
+static double elapsed(clock_t start) {
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+static int sameTotals(Totals* a, Totals* b) {
+    return a->planets == b->planets && a->jerries == b->jerries && a->characteristics == b->characteristics
+           && a->coordinates == b->coordinates && a->happiness == b->happiness && a->values == b->values;
+}
+
+int main(int argc, char* argv[]) {
+    int jerryCount = argc > 1 ? atoi(argv[1]) : DEFAULT_JERRIES;
+    int rounds = argc > 2 ? atoi(argv[2]) : DEFAULT_ROUNDS;
+    if (jerryCount < 1 || rounds < 1) {
+        printf("Usage: %s [numberOfJerries] [numberOfRounds]\n", argv[0]);
+        return 1;
+    }
+    char path[] = "/tmp/ConfigParserBenchXXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        printf("Cannot create a file in /tmp\n");
+        return 1;
+    }
+    close(fd);
+    long size = writeConfiguration(path, jerryCount);
+    if (size < 0) {
+        printf("Cannot write %s\n", path);
+        remove(path);
+        return 1;
+    }
+    double megabytes = (double)size / (1024.0 * 1024.0);
+    printf("%d Jerries, %.1f MB of configuration, best of %d rounds\n", jerryCount, megabytes, rounds);
+    ConfigHandlers handlers = {countPlanet, countJerry, countCharacteristic};
+    Totals scanned = {0}, parsed = {0};
+    double scanfTime = -1, parserTime = -1;
+    int failed = 0;
+    for (int r = 0; r < rounds && !failed; r++) {
+        memset(&scanned, 0, sizeof(Totals));
+        clock_t begin = clock();
+        failed |= readWithScanf(path, &scanned) != success;
+        double time = elapsed(begin);
+        if (scanfTime < 0 || time < scanfTime) {
+            scanfTime = time;
+        }
+        memset(&parsed, 0, sizeof(Totals));
+        begin = clock();
+        failed |= parseConfigFile(path, &handlers, &parsed) != success;
+        time = elapsed(begin);
+        if (parserTime < 0 || time < parserTime) {
+            parserTime = time;
+        }
+    }
+    remove(path);
+    if (failed) {
+        printf("Cannot read the configuration\n");
+        return 1;
+    }
+    printf("%-18s %8.1f MB/s\n", "fgets + sscanf", megabytes / scanfTime);
+    printf("%-18s %8.1f MB/s\n", "parseConfigFile", megabytes / parserTime);
+    if (!sameTotals(&scanned, &parsed)) {
+        printf("Different entries: %ld/%ld/%ld against %ld/%ld/%ld planets/Jerries/characteristics\n",
+               scanned.planets, scanned.jerries, scanned.characteristics, parsed.planets, parsed.jerries,
+               parsed.characteristics);
+        return 1;
+    }
+    printf("Same entries on both sides: %ld planets, %ld Jerries, %ld characteristics\n", parsed.planets,
+           parsed.jerries, parsed.characteristics);
+    return 0;
+}
@@ -1,10 +1,50 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
 #include "LinkedList.h"
 #include "KeyValuePair.h"
 #include "HashTable.h"
+#define CTRL_EMPTY (-128)   // Control byte of a slot that was never used
+#define CTRL_DELETED (-2)   // Control byte of a slot whose pair was removed (tombstone)
+#define MIN_SLOTS 8         // Smallest slot array of the open addressing engine
+#define REHASH_STEP 8       // Buckets (or slots) moved from the old storage by every operation during a resize
+#define SHRINK_DIVISOR 8    // The table shrinks when it is filled less than 1/SHRINK_DIVISOR
+#define ENTRIES_PER_SLAB 64 // Bucket nodes (and pairs) malloced at once by the pools of the chained engine
+
+// In-place slot of the open addressing engine
+typedef struct slot_s {
+    Element key;
+    Element value;
+    unsigned long long hash;    // Full hash of the key, compared before equalKey is called
+} Slot;
+
+// A key being searched for in a bucket, together with its hash
+typedef struct key_probe_s {
+    Element key;
+    unsigned long long hash;
+} KeyProbe;
+
+// Buckets (Chained) or slots (Open_Addressing) of one generation of the table
+typedef struct store_s {
+    int size;               // Number of buckets or slots, 0 if the storage is not allocated
+    int count;              // Number of pairs held by this storage
+    int tombstones;         // Number of deleted slots (Open_Addressing)
+    linkedlist* table;      // Buckets of the chained engine
+    signed char* control;   // One control byte per slot: empty, deleted or the low 7 bits of the hash
+    Slot* slots;            // Slots of the open addressing engine
+} Store;
+
 struct hashTable_s {
-    int size;
+    hashEngine engine;
+    int count;          // Number of stored pairs
+    int minSize;        // Initial size, the table never shrinks below it
+    Store current;      // Storage that receives new pairs
+    Store previous;     // Storage that is being migrated into current (size 0 when no resize is running)
+    int migrated;       // Buckets (or slots) of previous that were already migrated
+    memoryPool nodePool;    // Bucket nodes of the chained engine, shared by all the buckets
+    memoryPool pairPool;    // Key-value pairs of the chained engine
+    pairOps ops;            // Callbacks shared by all the pairs of the chained engine
     CopyFunction copyKey;
     FreeFunction freeKey;
     PrintFunction printKey;
@@ -13,8 +53,8 @@ struct hashTable_s {
     PrintFunction printValue;
     EqualFunction equalKey;
     TransformIntoNumberFunction transformIntoNumber;
-    linkedlist* table;
-
+    HashFunction hashFunction;   // Optional 64-bit hash that replaces transformIntoNumber
+    unsigned long long seed;     // Per table random seed of hashFunction
 };
 KeyValuePair copyKeyValuePair(KeyValuePair pair_element) {
     if (pair_element == NULL) {
@@ -24,19 +64,24 @@ KeyValuePair copyKeyValuePair(KeyValuePair pair_element) {
     return pair_element;
 }
 /**
- * @brief Checks if the key extracted from a pair matches a given key.
+ * @brief Checks if the key extracted from a pair matches a searched key.
  *
- * @param pair A pointer to the pair element (must contain a key).
- * @param key  A pointer to the key element to compare against.
+ * @param pair  A pointer to the pair element (must contain a key).
+ * @param probe A pointer to the KeyProbe holding the searched key and its hash.
  *
  * @return true if the key extracted from the pair matches the given key, false otherwise.
- *         Returns false if either pair or key is NULL.
+ *         Returns false if either pair or probe is NULL.
+ * The cached hashes are compared first, so equalKey only runs for pairs that are very likely to match.
  */
-static bool EqualPairWithKey(Element pair,Element key) {
-    if (pair == NULL|| key == NULL) {
+static bool EqualPairWithKey(Element pair,Element probe) {
+    if (pair == NULL|| probe == NULL) {
         return false;
     }
-    if (isEqualKey(pair,key)) {
+    KeyProbe* keyProbe = (KeyProbe*)probe;
+    if (getPairHash(pair) != keyProbe->hash) {
+        return false;
+    }
+    if (isEqualKey(pair,keyProbe->key)) {
         return true;
     }
     return false;
@@ -44,32 +89,237 @@ static bool EqualPairWithKey(Element pair,Element key) {
 
 
 
-// Calculates the index in the hash table for a given key
-static int calculateHashIndex(hashTable ht, Element key) {
-    int transformedNumber = ht->transformIntoNumber(key); // Transform the key into a number
+// Calculates the full 64-bit hash of a key
+static unsigned long long keyHash(hashTable ht, Element key) {
+    if (ht->hashFunction != NULL) {
+        return ht->hashFunction(key, ht->seed);
+    }
+    // Mix the transformed key so that weak transforms still spread over the table
+    unsigned long long h = (unsigned int)ht->transformIntoNumber(key);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
 
-    if (transformedNumber < 0) {
-        // Ensure the number is positive
-        transformedNumber = -transformedNumber;
+// Calculates the bucket index of a hash in a chained storage of the given size
+static int calculateHashIndex(unsigned long long hash, int size) {
+    return (int)(hash % (unsigned long long)size); // Modulo operation to map to bucket
+}
+
+// Returns the slot index of the key in the storage, or -1 if the key is not stored there
+static int findSlot(hashTable ht, Store* store, Element key, unsigned long long hash) {
+    signed char tag = (signed char)(hash & 0x7F); // Low 7 bits are kept in the control byte
+    int mask = store->size - 1;
+    int index = (int)((hash >> 7) & (unsigned long long)mask);
+    for (int probes = 0; probes < store->size; probes++) {
+        signed char control = store->control[index];
+        if (control == CTRL_EMPTY) {
+            return -1; // The probe sequence ends at the first never used slot
+        }
+        // Call equalKey only when the control byte and the full hash already match
+        if (control == tag && store->slots[index].hash == hash && ht->equalKey(store->slots[index].key, key)) {
+            return index;
+        }
+        index = (index + 1) & mask;
     }
+    return -1;
+}
 
-    return transformedNumber % ht->size; // Modulo operation to map to bucket
+// Puts a key-value pair into the first free slot of its probe sequence (the key must not be stored already)
+static void placeInSlot(Store* store, Element key, Element value, unsigned long long hash) {
+    int mask = store->size - 1;
+    int index = (int)((hash >> 7) & (unsigned long long)mask);
+    while (store->control[index] != CTRL_EMPTY && store->control[index] != CTRL_DELETED) {
+        index = (index + 1) & mask;
+    }
+    if (store->control[index] == CTRL_DELETED) {
+        store->tombstones--; // Reusing a tombstone
+    }
+    store->control[index] = (signed char)(hash & 0x7F);
+    store->slots[index].key = key;
+    store->slots[index].value = value;
+    store->slots[index].hash = hash;
+    store->count++;
+}
+
+// Frees the key and value of a slot and marks it as deleted
+static void clearSlot(hashTable ht, Store* store, int slot) {
+    ht->freeKey(store->slots[slot].key);
+    ht->freeValue(store->slots[slot].value);
+    // A slot followed by an empty one ends no probe sequence, so it can become empty again
+    if (store->control[(slot + 1) & (store->size - 1)] == CTRL_EMPTY) {
+        store->control[slot] = CTRL_EMPTY;
+    } else {
+        store->control[slot] = CTRL_DELETED;
+        store->tombstones++;
+    }
+    store->count--;
+}
+
+// Smallest power of two slot count that keeps the given number of entries under a 7/8 load
+static int slotsForEntries(int entries) {
+    int size = MIN_SLOTS;
+    while (size / 8 * 7 < entries) {
+        size *= 2;
+    }
+    return size;
+}
+
+// Marks a storage as not allocated
+static void emptyStore(Store* store) {
+    store->size = 0;
+    store->count = 0;
+    store->tombstones = 0;
+    store->table = NULL;
+    store->control = NULL;
+    store->slots = NULL;
+}
+
+// Frees a storage, with the pairs it still holds if freePairs is true
+static void releaseStore(hashTable ht, Store* store, bool freePairs) {
+    if (store->table != NULL) {
+        // Destroy each linked list in the table
+        for (int i = 0; i < store->size; i++) {
+            if (store->table[i] != NULL) {
+                destroyLinkedList(store->table[i]);
+            }
+        }
+        free(store->table); // Free the table array
+    }
+    if (store->control != NULL && freePairs) {
+        for (int i = 0; i < store->size; i++) {
+            if (store->control[i] >= 0) {
+                ht->freeKey(store->slots[i].key);
+                ht->freeValue(store->slots[i].value);
+            }
+        }
+    }
+    free(store->control);
+    free(store->slots);
+    emptyStore(store);
+}
+
+// Allocates an empty storage with the given number of buckets (or slots)
+static status initStore(hashTable ht, Store* store, int size) {
+    emptyStore(store);
+    store->size = size;
+    if (ht->engine == Open_Addressing) {
+        store->control = (signed char*)malloc(size * sizeof(signed char));
+        store->slots = (Slot*)malloc(size * sizeof(Slot));
+        if (store->control == NULL || store->slots == NULL) {
+            releaseStore(ht, store, false);
+            return Memory_Problem;
+        }
+        memset(store->control, CTRL_EMPTY, size * sizeof(signed char)); // All slots start empty
+        return success;
+    }
+    store->table = (linkedlist*)calloc(size, sizeof(linkedlist));
+    if (store->table == NULL) {
+        emptyStore(store);
+        return Memory_Problem; // Memory allocation for table array failed
+    }
+    // Initialize each bucket with an empty linked list
+    for (int i = 0; i < size; i++) {
+        store->table[i] = createLinkedListWithPool(
+            (CopyFunction)copyKeyValuePair,
+            (FreeFunction)destroyKeyValuePair,
+            (PrintFunction)displayKeyValuePair,
+            (EqualFunction)EqualPairWithKey,
+            ht->nodePool
+        );
+        if (store->table[i] == NULL) {
+            releaseStore(ht, store, false); // Clean up if list creation fails
+            return Memory_Problem;
+        }
+    }
+    return success;
+}
+
+// Moves the next few buckets (or slots) of the old storage into the current one
+static void migrateStep(hashTable ht) {
+    if (ht->previous.size == 0) {
+        return; // No resize is running
+    }
+    int budget = REHASH_STEP;
+    while (budget > 0 && ht->migrated < ht->previous.size) {
+        int i = ht->migrated;
+        if (ht->engine == Open_Addressing) {
+            if (ht->previous.control[i] >= 0) {
+                Slot slot = ht->previous.slots[i];
+                placeInSlot(&ht->current, slot.key, slot.value, slot.hash);
+                ht->previous.control[i] = CTRL_DELETED; // Keeps the old probe sequences intact
+                ht->previous.count--;
+            }
+        } else {
+            linkedlist bucket = ht->previous.table[i];
+            // Relink every node of the old bucket into its new bucket, without copying the pairs
+            while (getLength(bucket) > 0) {
+                KeyValuePair pair = getDataByIndex(bucket, 1);
+                transferHead(bucket, ht->current.table[calculateHashIndex(getPairHash(pair), ht->current.size)]);
+                ht->previous.count--;
+                ht->current.count++;
+            }
+        }
+        ht->migrated++;
+        budget--;
+    }
+    if (ht->migrated == ht->previous.size) {
+        releaseStore(ht, &ht->previous, false); // Every pair now lives in the current storage
+    }
+}
+
+// Starts migrating the table into a new storage of the given size
+static status startResize(hashTable ht, int newSize) {
+    // A running resize is finished first, only two generations are kept at a time
+    while (ht->previous.size != 0) {
+        migrateStep(ht);
+    }
+    Store next;
+    if (initStore(ht, &next, newSize) != success) {
+        return Memory_Problem;
+    }
+    ht->previous = ht->current;
+    ht->current = next;
+    ht->migrated = 0;
+    migrateStep(ht);
+    return success;
+}
+
+// Shrinks the table when it became too sparse
+static void shrinkIfSparse(hashTable ht) {
+    if (ht->previous.size != 0 || ht->current.size <= ht->minSize) {
+        return;
+    }
+    if (ht->count < ht->current.size / SHRINK_DIVISOR) {
+        int newSize = ht->engine == Open_Addressing ? ht->current.size / 2 : ht->current.size / 2 + 1;
+        if (newSize < ht->minSize) {
+            newSize = ht->minSize;
+        }
+        startResize(ht, newSize); // On failure the table simply stays large
+    }
 }
 
 hashTable createHashTable(CopyFunction copyKey, FreeFunction freeKey, PrintFunction printKey, CopyFunction copyValue, FreeFunction freeValue, PrintFunction printValue, EqualFunction equalKey, TransformIntoNumberFunction transformIntoNumber, int hashNumber) {
+    return createHashTableWithEngine(copyKey, freeKey, printKey, copyValue, freeValue, printValue, equalKey, transformIntoNumber, hashNumber, Chained);
+}
+
+hashTable createHashTableWithEngine(CopyFunction copyKey, FreeFunction freeKey, PrintFunction printKey, CopyFunction copyValue, FreeFunction freeValue, PrintFunction printValue, EqualFunction equalKey, TransformIntoNumberFunction transformIntoNumber, int hashNumber, hashEngine engine) {
     if(copyKey == NULL|| freeKey == NULL || printKey == NULL || copyValue == NULL || freeValue == NULL|| printValue == NULL || equalKey == NULL || transformIntoNumber == NULL|| hashNumber < 1) {
         return NULL;
     }
+    if (engine != Chained && engine != Open_Addressing) {
+        return NULL;
+    }
     hashTable ht = malloc(sizeof(struct hashTable_s));
     if (ht == NULL) {
         return NULL;
     }
-    ht->table = (linkedlist*)malloc(hashNumber * sizeof(linkedlist));
-    if (ht->table == NULL) {
-        free(ht);
-        return NULL; // Memory allocation for table array failed
-    }
-    ht->size = hashNumber;
+    ht->engine = engine;
+    ht->count = 0;
+    ht->migrated = 0;
     ht->copyKey = copyKey;
     ht->freeKey = freeKey;
     ht->printKey = printKey;
@@ -78,78 +328,126 @@ hashTable createHashTable(CopyFunction copyKey, FreeFunction freeKey, PrintFunct
     ht->printValue = printValue;
     ht->equalKey = equalKey;
     ht->transformIntoNumber = transformIntoNumber;
-
-    // Initialize each bucket with an empty linked list
-    for (int i = 0; i < hashNumber; i++) {
-        ht->table[i] = createLinkedList(
-            (CopyFunction)copyKeyValuePair,
-            (FreeFunction)destroyKeyValuePair,
-            (PrintFunction)displayKeyValuePair,
-            (EqualFunction)EqualPairWithKey
-        );
-        if (ht->table[i] == NULL) {
-            destroyHashTable(ht); // Clean up if list creation fails
-            return NULL;;
+    ht->hashFunction = NULL;
+    ht->seed = 0;
+    ht->minSize = engine == Open_Addressing ? slotsForEntries(hashNumber) : hashNumber;
+    ht->nodePool = NULL;
+    ht->pairPool = NULL;
+    ht->ops = NULL;
+    if (engine == Chained) {
+        // Nodes and pairs are carved from slabs instead of two mallocs per entry
+        ht->nodePool = createNodePool(ENTRIES_PER_SLAB);
+        ht->pairPool = createPairPool(ENTRIES_PER_SLAB);
+        // The pairs point to one copy of the callbacks instead of holding seven pointers each
+        ht->ops = createPairOps(copyKey, freeKey, printKey, equalKey, copyValue, freeValue, printValue, ht->pairPool);
+        if (ht->nodePool == NULL || ht->pairPool == NULL || ht->ops == NULL) {
+            destroyMemoryPool(ht->nodePool);
+            destroyMemoryPool(ht->pairPool);
+            destroyPairOps(ht->ops);
+            free(ht);
+            return NULL;
         }
-
-
     }
+    if (initStore(ht, &ht->current, ht->minSize) != success) {
+        destroyMemoryPool(ht->nodePool);
+        destroyMemoryPool(ht->pairPool);
+        destroyPairOps(ht->ops);
+        free(ht);
+        return NULL;
+    }
+    emptyStore(&ht->previous); // No resize is running yet
     return ht;
 }
+
+// Adds a key-value pair to the open addressing engine
+static status addToSlots(hashTable ht, Element key, Element value) {
+    unsigned long long hash = keyHash(ht, key);
+    // Check if the key already exists
+    if (findSlot(ht, &ht->current, key, hash) != -1) {
+        return failure;
+    }
+    if (ht->previous.size != 0 && findSlot(ht, &ht->previous, key, hash) != -1) {
+        return failure;
+    }
+    // Grow (or just drop the tombstones) before the slots get too full to probe quickly
+    Store* store = &ht->current;
+    if (store->count + store->tombstones + 1 > store->size / 8 * 7) {
+        int newSize = store->size;
+        while (newSize / 2 < ht->count + 1) {
+            newSize *= 2;
+        }
+        if (startResize(ht, newSize) != success && store->count + store->tombstones + 1 >= store->size) {
+            return failure; // Could not grow and no free slot is left
+        }
+    }
+    Element keyCopy = ht->copyKey(key);
+    if (keyCopy == NULL) {
+        return failure;
+    }
+    Element valueCopy = ht->copyValue(value);
+    if (valueCopy == NULL) {
+        ht->freeKey(keyCopy);
+        return failure;
+    }
+    placeInSlot(&ht->current, keyCopy, valueCopy, hash);
+    ht->count++;
+    return success;
+}
+
 // Adds a key-value pair to the hash table
 status addToHashTable(hashTable ht, Element key, Element value) {
     if (key == NULL || value == NULL || ht == NULL) {
         return failure;
     }
-    int index = calculateHashIndex(ht, key);
-    if (index < 0 || index >= ht->size) {
-        return failure;
+    migrateStep(ht);
+    if (ht->engine == Open_Addressing) {
+        return addToSlots(ht, key, value);
     }
 
-    linkedlist list = ht->table[index];
+    // Check if the key already exists
+    KeyProbe probe = {key, keyHash(ht, key)};
+    if (ht->previous.size != 0 && searchByKeyInList(ht->previous.table[calculateHashIndex(probe.hash, ht->previous.size)], &probe) != NULL) {
+        return failure;
+    }
+    linkedlist list = ht->current.table[calculateHashIndex(probe.hash, ht->current.size)];
     if (list == NULL) {
         return failure;
     }
-
-    // Check if the key already exists
-    Element existingElement = searchByKeyInList(list, key);
+    Element existingElement = searchByKeyInList(list, &probe);
     if (existingElement != NULL) {
         return failure;
     }
 
     // Create a new key-value pair
-    KeyValuePair pair = createKeyValuePair(
-        ht->copyKey, ht->freeKey, ht->printKey,
-        ht->equalKey, ht->copyValue, ht->freeValue, ht->printValue,
-        key, value
-    );
+    KeyValuePair pair = createKeyValuePairWithOps(ht->ops, key, value);
     if (pair == NULL) {
         return failure; // Memory allocation failed
     }
+    setPairHash(pair, probe.hash);
 
     // Append the new pair to the bucket
-    if (appendNode(list, pair) == failure) {
+    if (appendNode(list, pair) != success) {
         destroyKeyValuePair(pair);
         return failure;
     }
-
+    ht->current.count++;
+    ht->count++;
+    // Keep the average chain no longer than one pair
+    if (ht->previous.size == 0 && ht->count > ht->current.size) {
+        startResize(ht, ht->current.size * 2 + 1); // On failure the chains just get longer
+    }
     return success;
 }
 
 
 status destroyHashTable(hashTable ht) {
     if(ht == NULL) return failure;
-    if (ht->table == NULL) {
-        free(ht); // Free the hash table structure if no buckets are allocated
-        return success;
-    }
-    // Destroy each linked list in the table
-    for (int i = 0; i < ht->size; i++) {
-        if (ht->table[i] != NULL) {
-            destroyLinkedList(ht->table[i]);
-        }
-    }
-    free(ht->table); // Free the table array
+    releaseStore(ht, &ht->previous, true);
+    releaseStore(ht, &ht->current, true);
+    // Release the slabs of all nodes and pairs at once
+    destroyMemoryPool(ht->nodePool);
+    destroyMemoryPool(ht->pairPool);
+    destroyPairOps(ht->ops);
     free(ht); // Free the hash table structure
     return success;
 
@@ -157,15 +455,29 @@ status destroyHashTable(hashTable ht) {
 }
 
 Element lookupInHashTable(hashTable ht, Element key) {
-    if (key == NULL || ht == NULL || ht->table == NULL) {
+    if (key == NULL || ht == NULL) {
         return NULL;
     }
-    int index = calculateHashIndex(ht, key);
-    linkedlist list = ht->table[index];
-    if (list == NULL) {
-        return NULL; // Bucket is empty
+    migrateStep(ht);
+    if (ht->engine == Open_Addressing) {
+        unsigned long long hash = keyHash(ht, key);
+        int slot = findSlot(ht, &ht->current, key, hash);
+        if (slot != -1) {
+            return ht->current.slots[slot].value; // Return the value associated with the key
+        }
+        if (ht->previous.size != 0) {
+            slot = findSlot(ht, &ht->previous, key, hash);
+            if (slot != -1) {
+                return ht->previous.slots[slot].value;
+            }
+        }
+        return NULL;
+    }
+    KeyProbe probe = {key, keyHash(ht, key)};
+    KeyValuePair pair = (KeyValuePair)searchByKeyInList(ht->current.table[calculateHashIndex(probe.hash, ht->current.size)], &probe);
+    if (pair == NULL && ht->previous.size != 0) {
+        pair = (KeyValuePair)searchByKeyInList(ht->previous.table[calculateHashIndex(probe.hash, ht->previous.size)], &probe);
     }
-    KeyValuePair pair = (KeyValuePair)searchByKeyInList(list, key);
     if (pair == NULL) {
         return NULL;
     }
@@ -173,28 +485,93 @@ Element lookupInHashTable(hashTable ht, Element key) {
 }
 
 status removeFromHashTable(hashTable ht, Element key) {
-    if (key == NULL || ht == NULL || ht->table == NULL) {
+    if (key == NULL || ht == NULL) {
         return failure;
     }
-    int index = calculateHashIndex(ht, key);
-    linkedlist list = ht->table[index];
-    if (list == NULL) {
-        return failure;  // Bucket is empty
+    migrateStep(ht);
+    if (ht->engine == Open_Addressing) {
+        unsigned long long hash = keyHash(ht, key);
+        Store* store = &ht->current;
+        int slot = findSlot(ht, store, key, hash);
+        if (slot == -1 && ht->previous.size != 0) {
+            store = &ht->previous;
+            slot = findSlot(ht, store, key, hash);
+        }
+        if (slot == -1) {
+            return Not_Exist;
+        }
+        clearSlot(ht, store, slot);
+        ht->count--;
+        shrinkIfSparse(ht);
+        return success;
+    }
+    // The pair is either in the current storage or in the one being migrated
+    KeyProbe probe = {key, keyHash(ht, key)};
+    Store* store = &ht->current;
+    if (deleteNode(store->table[calculateHashIndex(probe.hash, store->size)], &probe) != success) {
+        store = &ht->previous;
+        if (store->size == 0 || deleteNode(store->table[calculateHashIndex(probe.hash, store->size)], &probe) != success) {
+            return Not_Exist;
+        }
     }
-    deleteNode(ht->table[index], key);
+    store->count--;
+    ht->count--;
+    shrinkIfSparse(ht);
     return success;
 }
 
 // Displays all elements in the hash table
 status displayHashElements(hashTable ht) {
-    if (ht == NULL || ht->table == NULL) {
+    if (ht == NULL) {
         return failure;
     }
-    // Iterate over each bucket and display its elements
-    for (int i = 0; i < ht->size; i++) {
-        if (ht->table[i] != NULL) {
-            displayList(ht->table[i]);
+    Store* stores[2] = {&ht->previous, &ht->current};
+    for (int s = 0; s < 2; s++) {
+        Store* store = stores[s];
+        if (ht->engine == Open_Addressing) {
+            // Display the pairs in slot order
+            for (int i = 0; i < store->size; i++) {
+                if (store->control[i] >= 0) {
+                    ht->printKey(store->slots[i].key);
+                    ht->printValue(store->slots[i].value);
+                }
+            }
+            continue;
         }
+        // Iterate over each bucket and display its elements
+        for (int i = 0; i < store->size; i++) {
+            if (store->table[i] != NULL) {
+                displayList(store->table[i]);
+            }
+        }
+    }
+    return success;
+}
+
+status setHashFunction(hashTable ht, HashFunction hashFunction) {
+    if (ht == NULL || hashFunction == NULL) {
+        return failure;
     }
+    if (ht->count != 0) {
+        return failure; // The stored pairs were placed by the old hash
+    }
+    static unsigned long long tables = 0;
+    // Seed with the clock, the table address and a counter, mixed by splitmix64
+    unsigned long long seed = (unsigned long long)time(NULL) ^ (unsigned long long)clock() ^ (unsigned long long)(size_t)ht ^ (++tables * 0x9e3779b97f4a7c15ULL);
+    seed += 0x9e3779b97f4a7c15ULL;
+    seed = (seed ^ (seed >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    seed = (seed ^ (seed >> 27)) * 0x94d049bb133111ebULL;
+    ht->seed = seed ^ (seed >> 31);
+    ht->hashFunction = hashFunction;
     return success;
+}
+
+long getHashTableSavedMallocs(hashTable ht) {
+    if (ht == NULL) {
+        return -1;
+    }
+    if (ht->engine != Chained) {
+        return 0; // Open addressing keeps the pairs in place and never mallocs per entry
+    }
+    return getPoolSavedMallocs(ht->nodePool) + getPoolSavedMallocs(ht->pairPool);
 }
\ No newline at end of file
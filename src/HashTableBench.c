@@ -0,0 +1,124 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "HashTable.h"
+#include "StringHash.h"
+#include "TypedHashTable.h"
+#define KEY_SIZE 16
+#define DEFAULT_KEYS 100000
+#define DEFAULT_LOOKUPS 5000000
+/**
+ * Measures the lookup hot path of the callback hash table (both engines) against the generated one.
+ * Usage: ./HashTableBench [numberOfKeys] [numberOfLookups]
+ * Every table maps the same Jerry-like ID strings to values and is hashed with wyhashString, so the
+ * difference comes from the callbacks, the void* plumbing and the storage layout.
+ */
+
+// Compares two strings, the equal function of every table in the benchmark
+static bool equalKeys(Element key1, Element key2) {
+    return strcmp((char*)key1, (char*)key2) == 0;
+}
+
+// The keys and values are owned by the benchmark, the generic tables keep them as is
+static Element noCopy(Element element) {
+    return element;
+}
+
+static status noFree(Element element) {
+    (void)element;
+    return success;
+}
+
+static status noPrint(Element element) {
+    (void)element;
+    return success;
+}
+
+// Only used until setHashFunction replaces it
+static int firstChar(Element key) {
+    return ((char*)key)[0];
+}
+
+DEFINE_HASHTABLE(BenchTable, char*, long, wyhashString, equalKeys)
+
+// Returns the seconds of processor time since start
+static double elapsed(clock_t start) {
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+// Looks up keys in a callback table, in a fixed pseudo random order, and prints the time per lookup
+static long benchGeneric(const char* name, hashTable ht, char** keys, int keyCount, long lookups) {
+    long sum = 0;
+    unsigned int state = 12345;
+    clock_t start = clock();
+    for (long i = 0; i < lookups; i++) {
+        state = state * 1103515245u + 12345u;
+        long* value = lookupInHashTable(ht, keys[state % keyCount]);
+        sum += *value;
+    }
+    printf("%-26s %8.1f ns/lookup\n", name, elapsed(start) * 1e9 / lookups);
+    return sum;
+}
+
+int main(int argc, char* argv[]) {
+    int keyCount = argc > 1 ? atoi(argv[1]) : DEFAULT_KEYS;
+    long lookups = argc > 2 ? atol(argv[2]) : DEFAULT_LOOKUPS;
+    if (keyCount < 1 || lookups < 1) {
+        printf("Usage: %s [numberOfKeys] [numberOfLookups]\n", argv[0]);
+        return 1;
+    }
+    char** keys = (char**)malloc(keyCount * sizeof(char*));
+    long* values = (long*)malloc(keyCount * sizeof(long));
+    if (keys == NULL || values == NULL) {
+        printf("Memory Problem\n");
+        free(keys);
+        free(values);
+        return 1;
+    }
+    int created = 0;
+    for (; created < keyCount; created++) {
+        keys[created] = (char*)malloc(KEY_SIZE);
+        if (keys[created] == NULL) {
+            break;
+        }
+        snprintf(keys[created], KEY_SIZE, "%x%c%d", created * 2654435761u, 'a' + created % 26, created % 977);
+        values[created] = created;
+    }
+    hashTable chained = createHashTableWithEngine(noCopy, noFree, noPrint, noCopy, noFree, noPrint, equalKeys, firstChar, 11, Chained);
+    hashTable open = createHashTableWithEngine(noCopy, noFree, noPrint, noCopy, noFree, noPrint, equalKeys, firstChar, 11, Open_Addressing);
+    BenchTable typed = BenchTable_create(11);
+    if (created < keyCount || chained == NULL || open == NULL || typed == NULL) {
+        printf("Memory Problem\n");
+    } else {
+        setHashFunction(chained, (HashFunction)wyhashString);
+        setHashFunction(open, (HashFunction)wyhashString);
+        // Every table grows from the same small size to keyCount entries
+        for (int i = 0; i < keyCount; i++) {
+            addToHashTable(chained, keys[i], &values[i]);
+            addToHashTable(open, keys[i], &values[i]);
+            BenchTable_add(typed, keys[i], values[i]);
+        }
+        printf("%d keys, %ld lookups\n", keyCount, lookups);
+        printf("Chained pools saved %ld mallocs\n", getHashTableSavedMallocs(chained));
+        long sum = benchGeneric("callbacks, Chained", chained, keys, keyCount, lookups);
+        sum -= benchGeneric("callbacks, Open_Addressing", open, keys, keyCount, lookups);
+        unsigned int state = 12345;
+        clock_t start = clock();
+        for (long i = 0; i < lookups; i++) {
+            state = state * 1103515245u + 12345u;
+            sum += *BenchTable_lookup(typed, keys[state % keyCount]);
+        }
+        printf("%-26s %8.1f ns/lookup\n", "DEFINE_HASHTABLE", elapsed(start) * 1e9 / lookups);
+        printf("checksum %ld\n", sum); // Keeps the lookups from being optimized away
+    }
+    destroyHashTable(chained);
+    destroyHashTable(open);
+    BenchTable_destroy(typed);
+    for (int i = 0; i < created; i++) {
+        free(keys[i]);
+    }
+    free(keys);
+    free(values);
+    return 0;
+}
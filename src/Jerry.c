@@ -5,32 +5,83 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include "Arena.h"
 #include "Jerry.h"
+#include "JerryStore.h"
+#include "SpatialIndex.h"
+#include "StringHash.h"
+#include "TypedHashTable.h"
 #include "Defs.h"
+#define PLANETS_INITIAL_CAPACITY 8 // Planets of a new PlanetsManager array, it doubles when full
+#define CATALOG_INITIAL_CAPACITY 16 // Names of a new characteristic catalog, it doubles when full
 
 int memory_failure_sign = 0;
 
+// Compares two names, the equal function of the planet index and of the characteristic catalog
+static bool equalNames(char* name1, char* name2) {
+    return strcmp(name1, name2) == 0;
+}
+
+// The planet index of a PlanetsManager: keyed by the name of the planet (owned by the planet)
+DEFINE_HASHTABLE(PlanetByName, char*, Planet*, wyhashString, equalNames)
+
+// The index of the characteristic catalog: keyed by the name (owned by the catalog), the value is the id
+DEFINE_HASHTABLE(CharacteristicByName, char*, int, wyhashString, equalNames)
+
+// The catalog of characteristic names, shared by all Jerries: names[id] is the name with this id
+static CharacteristicName** catalog_names = NULL;
+static int catalog_count = 0;
+static int catalog_capacity = 0;
+static CharacteristicByName catalog_index = NULL;
+
+// The spatial index of a PlanetsManager holds the planets themselves, they are owned by the manager
+static Element keepPlanet(Element planet) {
+    return planet;
+}
+
+static status releasePlanet(Element planet) {
+    (void)planet;
+    return success;
+}
+
+// Takes memory from an arena, or from malloc when there is no arena
+static Element allocate(Element region, int size) {
+    return region != NULL ? allocateFromArena(region, size) : malloc(size);
+}
+
+// Copies a string into an arena, or into malloced memory when there is no arena
+static char* copy_string(Element region, char* str) {
+    char* copy = (char*)allocate(region, (int)strlen(str) + 1);
+    if (copy != NULL) {
+        strcpy(copy, str);
+    }
+    return copy;
+}
+
+// Frees memory taken by allocate, the memory of an arena is only released with the arena
+static void release(Element region, Element memory) {
+    if (region == NULL) {
+        free(memory);
+    }
+}
+
 
-Origin* create_origin(Planet* planet, char* dimension) {
+Origin* create_origin(Planet* planet, char* dimension, Element arena) {
     // Validate input arguments
     if (planet == NULL || dimension == NULL) {
         return NULL; // Return NULL if either the planet or dimension is missing
     }
     // Allocate memory for the Origin structure
-    Origin* new_origin = (Origin*)malloc(sizeof(Origin));
+    Origin* new_origin = (Origin*)allocate(arena, sizeof(Origin));
     if (new_origin == NULL) {
-        memory_failure_sign = 1; // Signal memory allocation failure
         return NULL; // Return NULL if allocation fails
     }
-    // Allocate memory for the dimension string
-    new_origin->dimension = (char*)malloc(strlen(dimension) + 1);
+    // Copy the dimension string into newly allocated memory
+    new_origin->dimension = copy_string(arena, dimension);
     if (new_origin->dimension == NULL) {
-        free(new_origin); // Free the previously allocated Origin structure
-        memory_failure_sign = 1; // Signal memory allocation failure
+        release(arena, new_origin); // Free the previously allocated Origin structure
         return NULL; // Return NULL if allocation fails
     }
-    // Copy the dimension string into the newly allocated memory
-    strcpy(new_origin->dimension, dimension);
     // Link the planet to the Origin structure
     new_origin->planet = planet;
 
@@ -40,22 +91,23 @@ Origin* create_origin(Planet* planet, char* dimension) {
 /**
  * Destroys an Origin object, freeing its memory.
  * @param origin Pointer to the Origin to destroy.
+ * @param arena The arena the Origin was allocated from (NULL if it was malloced).
  */
-void destroy_origin(Origin* origin) {
+void destroy_origin(Origin* origin, Element arena) {
     if (origin == NULL) {
         return;
     }
 
     // Free the dimension string
     if (origin->dimension != NULL) {
-        free(origin->dimension);
+        release(arena, origin->dimension);
         origin->dimension = NULL; // Avoid use-after-free
     }
 
     // I'm not free the planet now, it is managed globally
 
     // Free the origin itself
-    free(origin);
+    release(arena, origin);
 }
 
 Jerry* create_jerry(char* id, int happiness,char* dimension,PlanetsManager* manager, char* name, double x, double y, double z ) {
@@ -63,38 +115,47 @@ Jerry* create_jerry(char* id, int happiness,char* dimension,PlanetsManager* mana
     if (id == NULL || dimension == NULL || manager == NULL || name == NULL) {
         return NULL;
     }
-    // Allocate memory for the Jerry structure
-    Jerry* new_jerry = (Jerry*)malloc(sizeof(Jerry));
+    Planet* new_planet = create_planet(manager,name,x,y,z); // create planet only if not exist yet, else only return pointer
+    if (new_planet == NULL) {
+        memory_failure_sign = 1;
+        return NULL;
+    }
+    // Allocate the Jerry from the arena of the manager if it has one
+    Jerry* new_jerry = create_jerry_on_planet(id, happiness, dimension, new_planet, manager->arena);
     if (new_jerry == NULL) {
-        memory_failure_sign = 1; // Indicate memory allocation failure
+        memory_failure_sign = 1;
+    }
+    return new_jerry;
+}
+
+Jerry* create_jerry_on_planet(char* id, int happiness, char* dimension, Planet* planet, Element arena) {
+    if (id == NULL || dimension == NULL || planet == NULL) {
         return NULL;
     }
-    // Allocate memory for the ID string
-    new_jerry->id = (char*)malloc(strlen(id) + 1); // +1 for the null terminator
-    if (new_jerry->id == NULL) {
-        memory_failure_sign = 1; // Indicate memory allocation failure
-        free(new_jerry);         // Free already allocated memory for Jerry
+    // Allocate memory for the Jerry structure
+    Jerry* new_jerry = (Jerry*)allocate(arena, sizeof(Jerry));
+    if (new_jerry == NULL) {
         return NULL;
     }
-    // Copy the given ID into the allocated memory
-    strcpy(new_jerry->id, id);
-    new_jerry->happiness = happiness; // Assign the happiness level
-    Planet* new_planet = create_planet(manager,name,x,y,z); // create planet only if not exist yet, else only return pointer
-    if (new_planet == NULL) {
-        memory_failure_sign = 1;
-        free(new_jerry->id);
-        free(new_jerry);
+    new_jerry->arena = arena;
+    // Copy the given ID into newly allocated memory
+    new_jerry->id = copy_string(arena, id);
+    if (new_jerry->id == NULL) {
+        release(arena, new_jerry); // Free already allocated memory for Jerry
         return NULL;
     }
-    new_jerry->origin = create_origin(new_planet,dimension); // create new origin to jerry
+    new_jerry->own_happiness = happiness; // Assign the happiness level
+    new_jerry->happiness = &new_jerry->own_happiness;
+    new_jerry->store = NULL;
+    new_jerry->origin = create_origin(planet,dimension,arena); // create new origin to jerry
     if (new_jerry->origin  == NULL) {
-        memory_failure_sign = 1;
-        free(new_jerry->id);
-        free(new_jerry);
+        release(arena, new_jerry->id);
+        release(arena, new_jerry);
         return NULL;
     }
-    new_jerry->characteristics = NULL;  // No characteristics yet
+    new_jerry->characteristics = new_jerry->inline_characteristics;  // No characteristics yet
     new_jerry->characteristics_count = 0; // Set characteristics count to 0
+    new_jerry->characteristics_capacity = INLINE_CHARACTERISTICS;
 
     return new_jerry; // Return pointer to the new jerry
 }
@@ -104,88 +165,126 @@ void destroy_jerry(Jerry* jerry) {
     if (jerry == NULL) {
         return; // No need to proceed if Jerry doesn't exist
     }
+    // Free the array of characteristics if it outgrew the Jerry, it is malloced even for a Jerry of an arena
+    if (jerry->characteristics != jerry->inline_characteristics) {
+        free(jerry->characteristics);
+        jerry->characteristics = jerry->inline_characteristics;
+    }
+    if (jerry->arena != NULL) {
+        return; // The rest of the Jerry is released with its arena
+    }
     // Free the memory allocated for the Jerry's ID
     if (jerry->id != NULL) {
         free(jerry->id);
     }
-    // Free the dynamic array of characteristics if it exists
-    if (jerry->characteristics != NULL) {
-        // Destroy each characteristic in the array
-        for (int i = 0; i < jerry->characteristics_count; i++) {
-            destroy_physical_characteristic(jerry->characteristics[i]);
-        }
-        // Free the array itself
-        free(jerry->characteristics);
-    }
     // Free the memory allocated for the origin, if it exists
     if (jerry->origin != NULL) {
-        destroy_origin(jerry->origin);
+        destroy_origin(jerry->origin, NULL);
     }
     // Finally, free the memory allocated for the Jerry structure itself
     free(jerry);
 }
 
 Planet* create_planet(PlanetsManager* manager,char* name, double x, double y, double z) {
-    if (name == NULL) {
+    if (manager == NULL || name == NULL) {
         return NULL;
     }
-    // Check if the planet already exists in the plantes list
-    if (manager->planets!=NULL) {
-        for (int i = 0; i < manager->count ; i++) {
-            if (strcmp(manager->planets[i]->name, name) == 0) {
-                return manager->planets[i]; // return pointer to the planet if alredy exist
-            }
+    // Return the planet if it already exists
+    Planet* existing = find_planet(manager, name);
+    if (existing != NULL) {
+        return existing;
+    }
+    // Create the name and spatial indexes with the first planet
+    if (manager->index == NULL) {
+        manager->index = PlanetByName_create(PLANETS_INITIAL_CAPACITY);
+        if (manager->index == NULL) {
+            memory_failure_sign = 1;
+            return NULL;
         }
     }
-    // Initialize the  list if it's NULL (for the first planet)
-    if (manager->planets == NULL) {
-       manager->planets = (Planet**)malloc(sizeof(Planet*));
-        if (manager->planets == NULL) {
+    if (manager->spatial == NULL) {
+        manager->spatial = createSpatialIndex(keepPlanet, releasePlanet, (PrintFunction)print_planet);
+        if (manager->spatial == NULL) {
             memory_failure_sign = 1;
             return NULL;
         }
-    } else {
-        // Reallocate memory for the list to add a new planet
-        Planet** temp = (Planet**)realloc(manager->planets, (manager->count + 1) * sizeof(Planet*));
+    }
+    // Double the array of planets when it is full
+    if (manager->count == manager->capacity) {
+        int capacity = manager->capacity == 0 ? PLANETS_INITIAL_CAPACITY : manager->capacity * 2;
+        Planet** temp = (Planet**)realloc(manager->planets, capacity * sizeof(Planet*));
         if (temp == NULL) {
             memory_failure_sign = 1;
             return NULL;
         }
         manager->planets = temp;
+        manager->capacity = capacity;
     }
 
-    // Allocate memory for the new planet
-    Planet* new_planet = (Planet*)malloc(sizeof(Planet));
+    // Allocate memory for the new planet, from the arena of the manager if it has one
+    Planet* new_planet = (Planet*)allocate(manager->arena, sizeof(Planet));
     if (new_planet == NULL) {
         memory_failure_sign = 1;
         return NULL;
     }
 
-    // Allocate memory for the planet name
-    new_planet->name = (char*)malloc(strlen(name) + 1);
+    // Copy the planet name
+    new_planet->name = copy_string(manager->arena, name);
     if (new_planet->name == NULL) {
-        free(new_planet);
+        release(manager->arena, new_planet);
         memory_failure_sign = 1;
         return NULL;
     }
-    strcpy(new_planet->name, name);
     // Assign coordinates
     new_planet->x = x;
     new_planet->y = y;
     new_planet->z = z;
 
-    // Add the new planet to the global list
-    Planet** temp = realloc(manager->planets, (manager->count + 1) * sizeof(Planet*));
-    if (temp == NULL) {
-        free(new_planet->name);
-        free(new_planet);
+    // Add the new planet to the indexes (the name one keyed by its own name) and to the array
+    if (PlanetByName_add(manager->index, new_planet->name, new_planet) != success) {
+        release(manager->arena, new_planet->name);
+        release(manager->arena, new_planet);
+        memory_failure_sign = 1;
+        return NULL;
+    }
+    if (addToSpatialIndex(manager->spatial, x, y, z, new_planet) != success) {
+        PlanetByName_remove(manager->index, new_planet->name);
+        release(manager->arena, new_planet->name);
+        release(manager->arena, new_planet);
         memory_failure_sign = 1;
         return NULL;
     }
-    manager->planets = temp;
     manager->planets[manager->count] = new_planet;
     manager->count++;
-    return manager->planets[manager->count - 1]; // return the pointer to the new plant
+    return new_planet; // return the pointer to the new plant
+}
+
+Planet* find_planet(PlanetsManager* manager, char* name) {
+    if (manager == NULL || name == NULL || manager->index == NULL) {
+        return NULL;
+    }
+    Planet** planet = PlanetByName_lookup(manager->index, name);
+    return planet == NULL ? NULL : *planet;
+}
+
+int find_nearest_planets(PlanetsManager* manager, double x, double y, double z, int k, Planet** nearest) {
+    if (manager == NULL || nearest == NULL || k < 0) {
+        return -1;
+    }
+    if (manager->spatial == NULL) {
+        return 0; // No planets yet
+    }
+    return findNearestInSpatialIndex(manager->spatial, x, y, z, k, (Element*)nearest, NULL);
+}
+
+status for_each_planet_within(PlanetsManager* manager, double x, double y, double z, double radius, VisitFunction visit, Element context) {
+    if (manager == NULL || visit == NULL) {
+        return failure;
+    }
+    if (manager->spatial == NULL) {
+        return success; // No planets yet
+    }
+    return forEachInSpatialRadius(manager->spatial, x, y, z, radius, visit, context);
 }
 
 
@@ -203,13 +302,20 @@ void destroy_planet(Planet* planet) {
     free(planet);
 }
 void destroy_all_planets(PlanetsManager* manager) {
-    // Check if the manager or its list is NULL
-    if (manager == NULL || manager->planets == NULL) {
+    if (manager == NULL) {
+        return;
+    }
+    PlanetByName_destroy(manager->index); // The names it keys on belong to the planets
+    manager->index = NULL;
+    destroySpatialIndex(manager->spatial); // Leaves the planets themselves
+    manager->spatial = NULL;
+    // Check if the list is NULL
+    if (manager->planets == NULL) {
         return; // If there's nothing to free, exit the function
     }
 
-    // Iterate through the list of planets and free each one
-    for (int i = 0; i < manager->count; i++) {
+    // Iterate through the list of planets and free each one, unless the arena holds them
+    for (int i = 0; i < manager->count && manager->arena == NULL; i++) {
         destroy_planet(manager->planets[i]); // Destroy each planet
     }
     // Free the array of pointers to planets
@@ -218,159 +324,226 @@ void destroy_all_planets(PlanetsManager* manager) {
     // Reset the manager's fields
     manager->planets = NULL;
     manager->count = 0;
+    manager->capacity = 0;
+    manager->index = NULL;
 }
 
 
 
 
 
-PhysicalCharacteristics* create_characteristic(char* name, double value) {
-    // Validate input argument: name must not be NULL
-    if (name == NULL) {
-        return NULL; // Return NULL if name is missing
+int intern_characteristic_name(char* characteristic_name) {
+    int id = find_characteristic_id(characteristic_name);
+    if (id >= 0 || characteristic_name == NULL) {
+        return id;
     }
-    // Allocate memory for the PhysicalCharacteristics structure
-    PhysicalCharacteristics* new_characteristic = (PhysicalCharacteristics*)malloc(sizeof(PhysicalCharacteristics));
-    if (new_characteristic == NULL) {
-        memory_failure_sign = 1; // Signal memory allocation failure
-        return NULL; // Return NULL if allocation fails
+    // Create the catalog with the first name
+    if (catalog_index == NULL) {
+        catalog_index = CharacteristicByName_create(CATALOG_INITIAL_CAPACITY);
+        if (catalog_index == NULL) {
+            memory_failure_sign = 1;
+            return -1;
+        }
     }
-    // Allocate memory for the name string
-    new_characteristic->name = (char*)malloc(strlen(name) + 1);
-    if (new_characteristic->name == NULL) {
-        free(new_characteristic); // Free the allocated structure on failure
-        memory_failure_sign = 1; // Signal memory allocation failure
-        return NULL; // Return NULL if allocation fails
+    if (catalog_count == catalog_capacity) {
+        int capacity = catalog_capacity == 0 ? CATALOG_INITIAL_CAPACITY : catalog_capacity * 2;
+        CharacteristicName** temp = (CharacteristicName**)realloc(catalog_names, capacity * sizeof(CharacteristicName*));
+        if (temp == NULL) {
+            memory_failure_sign = 1;
+            return -1;
+        }
+        catalog_names = temp;
+        catalog_capacity = capacity;
+    }
+    // The name is stored right after its entry, in the same allocation
+    size_t length = strlen(characteristic_name) + 1;
+    CharacteristicName* entry = (CharacteristicName*)malloc(sizeof(CharacteristicName) + length);
+    if (entry == NULL) {
+        memory_failure_sign = 1;
+        return -1;
+    }
+    entry->id = catalog_count;
+    entry->name = (char*)(entry + 1);
+    memcpy(entry->name, characteristic_name, length);
+    if (CharacteristicByName_add(catalog_index, entry->name, entry->id) != success) {
+        free(entry);
+        memory_failure_sign = 1;
+        return -1;
+    }
+    catalog_names[catalog_count++] = entry;
+    return entry->id;
+}
+
+int find_characteristic_id(char* characteristic_name) {
+    if (characteristic_name == NULL || catalog_index == NULL) {
+        return -1;
     }
-    // Copy the name into the allocated memory
-    strcpy(new_characteristic->name, name);
-    // Assign the value to the characteristic
-    new_characteristic->value = value;
-    // Return a pointer to the newly created PhysicalCharacteristics structure
-    return new_characteristic;
+    int* id = CharacteristicByName_lookup(catalog_index, characteristic_name);
+    return id == NULL ? -1 : *id;
 }
 
+CharacteristicName* get_characteristic_name(int id) {
+    if (id < 0 || id >= catalog_count) {
+        return NULL;
+    }
+    return catalog_names[id];
+}
 
-bool does_characteristic_exist(Jerry* jerry, char* characteristic_name) {
-    // Check if the input arguments are valid
-    if (jerry == NULL || characteristic_name == NULL) {
-        return false; // Return false if Jerry or characteristic_name is NULL
+int count_characteristic_names(void) {
+    return catalog_count;
+}
+
+void destroy_characteristic_catalog(void) {
+    CharacteristicByName_destroy(catalog_index);
+    for (int i = 0; i < catalog_count; i++) {
+        free(catalog_names[i]);
     }
-    // Check if Jerry has no characteristics yet
-    if (jerry->characteristics == NULL) {
-        return false; // Return false as no characteristics exist
+    free(catalog_names);
+    catalog_names = NULL;
+    catalog_count = 0;
+    catalog_capacity = 0;
+    catalog_index = NULL;
+}
+
+// Returns the position of a characteristic in the array of a Jerry, or -1 if the Jerry does not have it
+static int find_characteristic(Jerry* jerry, int id) {
+    if (id < 0) {
+        return -1; // A name out of the catalog, no Jerry has it
     }
-    // Iterate over the characteristics to find a match
     for (int i = 0; i < jerry->characteristics_count; i++) {
-        if (strcmp(jerry->characteristics[i]->name, characteristic_name) == 0) {
-            return true; // Return true if the characteristic exists
+        if (jerry->characteristics[i].id == id) {
+            return i;
         }
     }
-    return false; // Return false if the characteristic is not found
+    return -1;
+}
+
+bool does_characteristic_exist(Jerry* jerry, char* characteristic_name) {
+    // Check if the input arguments are valid
+    if (jerry == NULL || characteristic_name == NULL) {
+        return false; // Return false if Jerry or characteristic_name is NULL
+    }
+    return find_characteristic(jerry, find_characteristic_id(characteristic_name)) >= 0;
 }
 
 PhysicalCharacteristics* get_characteristic(Jerry* jerry, char* characteristic_name) {
     if (jerry == NULL || characteristic_name == NULL) {
         return NULL;
     }
+    return get_characteristic_by_id(jerry, find_characteristic_id(characteristic_name));
+}
 
-    for (int i = 0; i < jerry->characteristics_count; i++) {
-        if (strcmp(jerry->characteristics[i]->name, characteristic_name) == 0) {
-            return jerry->characteristics[i];
-        }
+PhysicalCharacteristics* get_characteristic_by_id(Jerry* jerry, int id) {
+    if (jerry == NULL) {
+        return NULL;
     }
-    return NULL;
+    int index = find_characteristic(jerry, id);
+    return index < 0 ? NULL : &jerry->characteristics[index];
 }
 
-status add_physical_characteristic(Jerry* jerry, PhysicalCharacteristics* characteristic) {
+status add_physical_characteristic(Jerry* jerry, char* characteristic_name, double value) {
     // Check if the input arguments are valid
-    if (jerry == NULL || characteristic == NULL) {
-        return Invlid_Input; // Return invalid input if Jerry or characteristic is NULL
+    if (jerry == NULL || characteristic_name == NULL) {
+        return Invlid_Input; // Return invalid input if Jerry or characteristic_name is NULL
+    }
+    int id = intern_characteristic_name(characteristic_name);
+    if (id < 0) {
+        return Memory_Problem; // The name could not join the catalog
+    }
+    status s = add_physical_characteristic_by_id(jerry, id, value);
+    if (s == Memory_Problem) {
+        memory_failure_sign = 1; // Signal memory allocation failure
+    }
+    return s;
+}
+
+status add_physical_characteristic_by_id(Jerry* jerry, int id, double value) {
+    if (jerry == NULL || id < 0) {
+        return Invlid_Input;
     }
     // Check if the characteristic already exists
-    if (does_characteristic_exist(jerry, characteristic->name)) {
+    if (find_characteristic(jerry, id) >= 0) {
         return Alreaqdy_Exist; // Return already exists if the characteristic is found
     }
-    // Allocate memory for the characteristics array if not already allocated
-    if (jerry->characteristics == NULL) {
-        jerry->characteristics = (PhysicalCharacteristics**)malloc(sizeof(PhysicalCharacteristics*));
-        if (jerry->characteristics == NULL) {
-            memory_failure_sign = 1; // Signal memory allocation failure
-            return Memory_Problem; // Return memory problem status
+    // Double the array when it is full, the first time it moves out of the Jerry
+    if (jerry->characteristics_count == jerry->characteristics_capacity) {
+        int capacity = jerry->characteristics_capacity * 2;
+        PhysicalCharacteristics* temp;
+        if (jerry->characteristics == jerry->inline_characteristics) {
+            // Out of the Jerry, malloced even for a Jerry of an arena so it can grow, shrink and be freed
+            temp = (PhysicalCharacteristics*)malloc(capacity * sizeof(PhysicalCharacteristics));
+            if (temp != NULL) {
+                memcpy(temp, jerry->characteristics, jerry->characteristics_count * sizeof(PhysicalCharacteristics));
+            }
+        } else {
+            temp = (PhysicalCharacteristics*)realloc(jerry->characteristics, capacity * sizeof(PhysicalCharacteristics));
         }
-    } else {
-        // Reallocate memory to add the new characteristic
-        PhysicalCharacteristics** temp = (PhysicalCharacteristics**)realloc(
-            jerry->characteristics,
-            (jerry->characteristics_count + 1) * sizeof(PhysicalCharacteristics*)
-        );
         if (temp == NULL) { // Check for memory allocation failure
-            memory_failure_sign = 1; // Signal memory allocation failure
             return Memory_Problem; // Return memory problem status
         }
         jerry->characteristics = temp; // Update pointer to the new array
-    }
-    // Add the new characteristic to the array
-    jerry->characteristics[jerry->characteristics_count] = characteristic;
+        jerry->characteristics_capacity = capacity;
+    }
+    // Add the new characteristic at the end of the array
+    PhysicalCharacteristics* characteristic = &jerry->characteristics[jerry->characteristics_count];
+    characteristic->id = id;
+    characteristic->value = value;
+    characteristic->index_node = NULL; // Not indexed yet
+    characteristic->order_node = NULL;
     jerry->characteristics_count++; // Increment the count of characteristics
     return Success; // Return success status
 }
-void destroy_physical_characteristic(PhysicalCharacteristics* characteristic) {
-    if (characteristic == NULL) {
-        return; // Nothing to free if the pointer is NULL
-    }
-    // Free the dynamically allocated name
-    free(characteristic->name);
-    // Free the characteristic itself
-    free(characteristic);
-}
 status remove_physical_characteristic(Jerry* jerry,  char* characteristic_name) {
-    // Check for NULL inputs or uninitialized array
-    if (jerry == NULL || characteristic_name == NULL|| jerry->characteristics == NULL) {
+    // Check for NULL inputs
+    if (jerry == NULL || characteristic_name == NULL) {
         return Invlid_Input;
     }
     // Check if characteristic exists
-    if (!does_characteristic_exist(jerry, characteristic_name)) {
+    int index = find_characteristic(jerry, find_characteristic_id(characteristic_name));
+    if (index < 0) {
         return Not_Exist;
     }
-    int index = -1;
-    for (int i = 0; i <jerry->characteristics_count;i++) {
-        if (strcmp(jerry->characteristics[i]->name, characteristic_name) == 0) {
-            index = i;
-            break; // Found the characteristic, exit loop
-        }
-    }
-    // Free the memory of the characteristic being removed
-    destroy_physical_characteristic(jerry->characteristics[index]);
-    for (int i = index;i<jerry->characteristics_count-1;i++) {
-        jerry->characteristics[i] = jerry->characteristics[i+1];
-    }
+    // Close the gap of the removed characteristic, keeping the order
+    memmove(&jerry->characteristics[index], &jerry->characteristics[index + 1],
+            (jerry->characteristics_count - index - 1) * sizeof(PhysicalCharacteristics));
     // Reduce the count of characteristics
     jerry->characteristics_count--;
-    // Handle the case where the count is now zero
-
-    if (jerry->characteristics_count == 0) {
-        free(jerry->characteristics);
-        jerry->characteristics = NULL;
+    // Shrink only at a quarter of the capacity, so adding and removing around a size does not reallocate every time
+    if (jerry->characteristics == jerry->inline_characteristics || jerry->characteristics_count > jerry->characteristics_capacity / 4) {
         return Success;
     }
-    // Reallocate memory
-    PhysicalCharacteristics** temp = realloc(jerry->characteristics, (jerry->characteristics_count) * sizeof(PhysicalCharacteristics*));
-    if (temp == NULL) {
-        memory_failure_sign = 1;
-        return Memory_Problem; // Array remains valid, but memory isn't reduced
+    if (jerry->characteristics_count <= INLINE_CHARACTERISTICS) {
+        // Back into the Jerry
+        memcpy(jerry->inline_characteristics, jerry->characteristics, jerry->characteristics_count * sizeof(PhysicalCharacteristics));
+        free(jerry->characteristics);
+        jerry->characteristics = jerry->inline_characteristics;
+        jerry->characteristics_capacity = INLINE_CHARACTERISTICS;
+    } else {
+        // Halved, a failed realloc keeps the larger array
+        int capacity = jerry->characteristics_capacity / 2;
+        PhysicalCharacteristics* temp = (PhysicalCharacteristics*)realloc(jerry->characteristics, capacity * sizeof(PhysicalCharacteristics));
+        if (temp != NULL) {
+            jerry->characteristics = temp;
+            jerry->characteristics_capacity = capacity;
+        }
     }
-    jerry->characteristics = temp; // Update pointer to new array
     return Success;
 }
 
+int get_happiness(Jerry* jerry) {
+    if (jerry->store != NULL) {
+        return readHappinessInStore(jerry->store, jerry);
+    }
+    return jerry->own_happiness;
+}
+
 status print_jerry(Jerry* jerry) {
     if (jerry == NULL || jerry->id == NULL) {
         return Invlid_Input;
     }
     // Print Jerry's ID & Happiness level
     printf("Jerry , ID - %s : \n", jerry->id);
-    printf("Happiness level : %d \n", jerry->happiness);
+    printf("Happiness level : %d \n", get_happiness(jerry));
 
     // Print Jerry's origin and planet details
     if (jerry->origin == NULL || jerry->origin->planet == NULL) {
@@ -384,7 +557,7 @@ status print_jerry(Jerry* jerry) {
            jerry->origin->planet->z);
 
     // Print Jerry's physical characteristics only if they exist
-    if (jerry->characteristics_count > 0 && jerry->characteristics != NULL) {
+    if (jerry->characteristics_count > 0) {
         printf("Jerry's physical Characteristics available : \n");
         printf("\t");
 
@@ -394,9 +567,9 @@ status print_jerry(Jerry* jerry) {
                 printf(" , ");
             }
             if (i == jerry->characteristics_count - 1) {
-                printf("%s : %.2f \n", jerry->characteristics[i]->name, jerry->characteristics[i]->value);
+                printf("%s : %.2f \n", get_characteristic_name(jerry->characteristics[i].id)->name, jerry->characteristics[i].value);
             } else {
-                printf("%s : %.2f", jerry->characteristics[i]->name, jerry->characteristics[i]->value);
+                printf("%s : %.2f", get_characteristic_name(jerry->characteristics[i].id)->name, jerry->characteristics[i].value);
             }
         }
     }
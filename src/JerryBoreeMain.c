@@ -2,10 +2,30 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include "Arena.h"
+#include "ConfigLoader.h"
 #include "HashTable.h"
 #include "Jerry.h"
+#include "JerryStore.h"
 #include "LinkedList.h"
+#include "OperationLog.h"
+#include "OrderedIndex.h"
+#include "PriorityQueue.h"
+#include "RosterFeed.h"
+#include "Snapshot.h"
+#include "StringHash.h"
+#include "TypedHashTable.h"
 #define MAX_SIZE 300
+#define MAX_PROFILE 16 // Most characteristics a similarity search can be given
+#define ARENA_BLOCK_SIZE 65536 // Bytes of every block of the session arena
+// The log of the changes of the session, NULL when the daycare keeps no log
+static operationLog daycare_log = NULL;
+// The roster the daycare follows for new Jerries, NULL when it follows none
+static rosterFeed daycare_roster = NULL;
+// The ID of the last Jerry read from the roster, the characteristics read after it are its own
+static char roster_last_id[MAX_SIZE] = "";
 /***
  * Compares two string elements for equality.
  * @param str1 A pointer to the first string element.
@@ -18,15 +38,51 @@ bool equalStrings(Element str1, Element str2) {
 }
 /**
  * Prints the name of a physical characteristic.
- * @param name A pointer to the characteristic name to print.
+ * @param name A pointer to the CharacteristicName of the catalog to print.
  * @return status indicating success or failure.
  */
 status printPhysicalCharacteristic(Element name) {
     if (name == NULL) return failure; // Return failure if input is NULL
-    char* characteristic_name = (char*)name;
-    printf("%s : \n", characteristic_name); // Print the characteristic name
+    CharacteristicName* characteristic_name = (CharacteristicName*)name;
+    printf("%s : \n", characteristic_name->name); // Print the characteristic name
     return success; // Return success
 }
+/**
+ * Compares two characteristic names of the catalog by their ids.
+ * @param name1 A pointer to the first CharacteristicName.
+ * @param name2 A pointer to the second CharacteristicName.
+ * @return true if both are the same name, false otherwise.
+ */
+bool equalCharacteristicNames(Element name1, Element name2) {
+    if (name1 == NULL || name2 == NULL) return false;
+    return ((CharacteristicName*)name1)->id == ((CharacteristicName*)name2)->id;
+}
+/**
+ * Turns a characteristic name of the catalog into a number for hashing.
+ * @param name A pointer to the CharacteristicName.
+ * @return The id of the name.
+ */
+int characteristicNameToNumber(Element name) {
+    return ((CharacteristicName*)name)->id;
+}
+/**
+ * Finds the key of a characteristic in the characteristic tables, the name resolved once in the catalog.
+ * @param characteristic_name The name of the characteristic.
+ * @return A pointer to the CharacteristicName, or NULL if no Jerry ever had this characteristic.
+ */
+CharacteristicName* characteristic_key(char* characteristic_name) {
+    return get_characteristic_name(find_characteristic_id(characteristic_name));
+}
+/**
+ * Prints the name of a planet.
+ * @param name A pointer to the planet name to print.
+ * @return status indicating success or failure.
+ */
+status printPlanetName(Element name) {
+    if (name == NULL) return failure;
+    printf("%s : \n", (char*)name);
+    return success;
+}
 
 /**
  * Creates a deep copy of a string.
@@ -97,8 +153,9 @@ status printJerryID(Element id) {
 status printCharacteristicName(Element characteristic) {
     if (characteristic == NULL) return failure; // Return failure if input is NULL
     PhysicalCharacteristics* pc = (PhysicalCharacteristics*)characteristic; // Cast to PhysicalCharacteristics
-    if (pc->name == NULL) return failure; // Return failure if name is NULL
-    printf("%s:\n", pc->name); // Print the characteristic name
+    CharacteristicName* name = get_characteristic_name(pc->id);
+    if (name == NULL) return failure; // Return failure if the name is not in the catalog
+    printf("%s:\n", name->name); // Print the characteristic name
     return success; // Return success
 }
 
@@ -113,6 +170,42 @@ void freeString(Element str) {
 }
 
 
+/**
+ * The value stored for every Jerry in the ID hash table.
+ * Keeps the node of the Jerry in the Jerries list, so a checkout never has to search the list.
+ */
+typedef struct JerryEntry_struct {
+    Jerry* jerry;   // The Jerry itself (owned by the Jerries list)
+    listNode node;  // The node of the Jerry in the Jerries list
+    heapNode mood;  // The node of the Jerry in the happiness heap
+    listNode origin;// The node of the Jerry in the Jerries-by-planet table
+} JerryEntry;
+
+// The ID table: keyed by the id string of the Jerry (owned by the Jerry), entries stored in place
+DEFINE_HASHTABLE(JerryById, char*, JerryEntry, wyhashString, equalStrings)
+
+/**
+ * Compares the happiness of two Jerries, the order of the happiness heap.
+ * @param j1 A pointer to the first Jerry.
+ * @param j2 A pointer to the second Jerry.
+ * @return A negative number if the first Jerry is sadder, 0 if they are as happy, a positive number otherwise.
+ */
+int compareHappiness(Element j1, Element j2) {
+    return get_happiness((Jerry*)j1) - get_happiness((Jerry*)j2);
+}
+
+/**
+ * Finds a Jerry in the daycare by its ID.
+ * @param ht A hash table of JerryEntry by Jerry ID.
+ * @param id The ID of the Jerry.
+ * @return A pointer to the Jerry, or NULL if no Jerry has this ID.
+ */
+Jerry* find_jerry(JerryById ht, char* id) {
+    JerryEntry* entry = JerryById_lookup(ht, id);
+    if (entry == NULL) return NULL;
+    return entry->jerry;
+}
+
 /**
  * Calculates the sum of ASCII values of the characters in a string.
  * @param str A pointer to the string element.
@@ -133,90 +226,19 @@ int stringToAsciiSum(Element str) {
 
 /***
  * Reads a configuration file to populate the PlanetsManager and a linked list of Jerries.
+ * The Jerries of a large file are loaded on one thread per processor (see ConfigLoader.h).
  * @param file_name The name of the configuration file.
  * @param manager A pointer to the PlanetsManager for managing planets.
  * @param Jerries A linked list to store the Jerry objects.
  * @return Status indicating Success, Invalid_Input, or Memory_Problem.
  */
 status read_configuration_file(char* file_name, PlanetsManager* manager,linkedlist Jerries) {
-
-    FILE* file = fopen(file_name, "r");
-    if (file == NULL) {
+    status s = load_configuration(file_name, manager, Jerries, 0);
+    if (s == Invlid_Input) {
         return Invlid_Input;
     }
-    char buffer[MAX_SIZE]; // Buffer to store each line from the file
-    int reading_planets = 0;
-    int reading_jerries = 0;
-
-    while (fgets(buffer, sizeof(buffer), file) && memory_failure_sign == 0) {
-        // Remove the newline character at the end of the line (if exists)
-        buffer[strcspn(buffer, "\n")] = '\0';
-
-        // Check for section headers
-        if (strcmp(buffer, "Planets") == 0) {
-            reading_planets = 1;
-            reading_jerries = 0;
-            continue;
-        }
-        if (strcmp(buffer, "Jerries") == 0) {
-            reading_jerries = 1;
-            reading_planets = 0;
-            continue;
-        }
-
-        // Process planets
-        if (reading_planets) {
-            char planet_name[MAX_SIZE];
-            double x, y, z;
-
-            // Parse planet details
-            if (sscanf(buffer, "%299[^,],%lf,%lf,%lf", planet_name, &x, &y, &z) == 4) {
-                Planet* planet = create_planet(manager, planet_name, x, y, z);
-                if (planet == NULL) break;
-            }
-        }
-        // Process Jerries and their physical characteristics
-        if (reading_jerries) {
-            // Check if the line starts with a tab (indicating a characteristic)
-            if (buffer[0] == '\t') {
-                char characteristic_name[MAX_SIZE];
-                double characteristic_value;
-
-                // Parse the characteristic
-                if (sscanf(buffer + 1, "%299[^:]:%lf", characteristic_name, &characteristic_value) == 2) {
-                    PhysicalCharacteristics* characteristic = create_characteristic(characteristic_name, characteristic_value);
-                    if (characteristic == NULL) break;
-                    // Add the characteristic to the last added Jerry
-                    Jerry* last_jerrey = getTailContent(Jerries);
-                    status s = add_physical_characteristic(last_jerrey,characteristic);
-                    if (s == Memory_Problem) break;
-                }
-            } else {
-                // Parse Jerry details
-                char id[MAX_SIZE];
-                char dimension[MAX_SIZE];
-                char planet_name[MAX_SIZE];
-                int happiness;
-
-                if (sscanf(buffer, "%299[^,],%299[^,],%299[^,],%d", id, dimension, planet_name, &happiness) == 4) {
-                    //create new Jerry
-                    Jerry* jerry = create_jerry(id, happiness,dimension, manager,planet_name, 0,0, 0 );
-                    if (jerry == NULL) {
-                        break;
-                    }
-                    // Add the new Jerry to the list
-                   status s = appendNode(Jerries, jerry);
-                   if (s == Memory_Problem ) {
-                       memory_failure_sign = 1;
-                   }
-
-                }
-            }
-        }
-    }
-    fclose(file);
     // Handle memory failure
-    if (memory_failure_sign == 1) {
+    if (memory_failure_sign == 1 || s == Memory_Problem) {
         return Memory_Problem;
     }
     return Success; // Success
@@ -230,6 +252,9 @@ void go_home(linkedlist Jerries,PlanetsManager* manager) {
     // Free all Jerries and their associated memory
     destroyLinkedList(Jerries);
     destroy_all_planets(manager); // Free all planets
+    destroyArena(manager->arena); // Release the planets and Jerries at once
+    manager->arena = NULL;
+    destroy_characteristic_catalog(); // Free the characteristic names
 }
 /**
  * Finds the next prime number greater than or equal to the given number.
@@ -267,29 +292,33 @@ int nextPrime(int n) {
 }
 
 /**
- * Adds all Jerries from the linked list to the hash table.
+ * Adds all Jerries from the linked list to the hash table, the happiness store, the happiness heap and the table of Jerries by planet.
  * @param jerryList A linked list containing Jerries.
  * @param ht A hash table to which the Jerries will be added.
+ * @param moods A min-heap of the Jerries by happiness.
+ * @param store The columnar store of the Jerries' happiness.
+ * @param origins A multi-value hash table of the Jerries by planet name.
  * @return status Success if all Jerries were added, failure otherwise.
  */
-status addAllJerriesToHashTable(linkedlist jerryList, hashTable ht) {
-    if (jerryList == NULL || ht == NULL) {
+status addAllJerriesToHashTable(linkedlist jerryList, JerryById ht, priorityQueue moods, jerryStore store, MultiValueHashTable origins) {
+    if (jerryList == NULL || ht == NULL || moods == NULL || store == NULL || origins == NULL) {
         return failure;  // Input validation
     }
 
-    int listLength = getLength(jerryList);
-    if (listLength == -1) {
-        return failure; // Invalid list length
-    }
-
-    for (int i = 1; i <= listLength; i++) { // מעבר על כל האיברים ברשימה לפי אינדקס
-        Jerry* jerry = (Jerry*)getDataByIndex(jerryList, i); // קבלת האיבר הנוכחי
+    // Walk the list node by node
+    for (listNode node = getFirstNode(jerryList); node != NULL; node = getNextNode(node)) {
+        Jerry* jerry = (Jerry*)getNodeData(node);
         if (jerry == NULL) {
             continue;  // Skip if the Jerry is NULL
         }
 
-        // הוספת ה-Jerry לטבלת ההאש
-        if (addToHashTable(ht, jerry->id, jerry) == failure) {
+        // Add the Jerry to the hash table, with its list, heap and planet nodes for fast removal
+        JerryEntry entry = {jerry, node, NULL, NULL};
+        if (addToJerryStore(store, jerry) != success || pushToPriorityQueue(moods, jerry, &entry.mood) != success
+            || addToMultiValueHashTableWithHandle(origins, jerry->origin->planet->name, jerry, &entry.origin) != success) {
+            return failure;
+        }
+        if (JerryById_add(ht, jerry->id, entry) != success) {
             return failure; // Return failure if adding failed
         }
     }
@@ -298,29 +327,86 @@ status addAllJerriesToHashTable(linkedlist jerryList, hashTable ht) {
 }
 
 /**
- * Adds all Jerry characteristics to a multi-value hash table.
- * @param jerryList A linked list containing Jerries.
- * @param mht A multi-value hash table to which the characteristics will be added.
- * @return status Success if all characteristics were added, failure otherwise.
+ * Indexes a characteristic of a Jerry in the multi-value hash table and in the ordered index of its name.
+ * The handles are kept in the characteristic for O(1) and O(log n) removal.
+ * @param mht A multi-value hash table of Jerries by characteristic name.
+ * @param orders A hash table of orderedIndex (Jerries by value) by characteristic name.
+ * @param jerry The Jerry that has the characteristic.
+ * @param characteristic The characteristic to index.
+ * @return status Success if the characteristic was indexed, failure otherwise.
  */
-status addAllcharToMultiHashTable(linkedlist jerryList, MultiValueHashTable mht) {
-    if (jerryList == NULL || mht == NULL) {
+status index_characteristic(MultiValueHashTable mht, hashTable orders, Jerry* jerry, PhysicalCharacteristics* characteristic) {
+    if (mht == NULL || orders == NULL || jerry == NULL || characteristic == NULL) {
+        return failure;
+    }
+    CharacteristicName* key = get_characteristic_name(characteristic->id);
+    listNode handle = NULL;
+    if (addToMultiValueHashTableWithHandle(mht,key,jerry,&handle)!=success) {
         return failure;
     }
+    characteristic->index_node = handle;
+    orderedIndex order = lookupInHashTable(orders,key);
+    if (order == NULL) {
+        // First Jerry with this characteristic
+        order = createOrderedIndex((CopyFunction)shallowCopyElement,(FreeFunction)fakeFree,(PrintFunction)print_jerry);
+        if (order == NULL || addToHashTable(orders,key,order) != success) {
+            destroyOrderedIndex(order);
+            return failure;
+        }
+    }
+    indexNode node = NULL;
+    if (addToOrderedIndex(order,characteristic->value,jerry,&node) != success) {
+        return failure;
+    }
+    characteristic->order_node = node;
+    return success;
+}
 
-    int listLength = getLength(jerryList);
-    if (listLength == -1) {
+/**
+ * Removes a characteristic of a Jerry from the multi-value hash table and from the ordered index of its name.
+ * @param mht A multi-value hash table of Jerries by characteristic name.
+ * @param orders A hash table of orderedIndex (Jerries by value) by characteristic name.
+ * @param characteristic The indexed characteristic.
+ * @return status Success if the characteristic was removed, failure otherwise.
+ */
+status unindex_characteristic(MultiValueHashTable mht, hashTable orders, PhysicalCharacteristics* characteristic) {
+    if (mht == NULL || orders == NULL || characteristic == NULL) {
         return failure;
     }
+    CharacteristicName* key = get_characteristic_name(characteristic->id);
+    status s = removeHandleFromMultiValueHashTable(mht,key,characteristic->index_node);
+    characteristic->index_node = NULL;
+    orderedIndex order = lookupInHashTable(orders,key);
+    if (order != NULL && characteristic->order_node != NULL) {
+        removeFromOrderedIndex(order,characteristic->order_node);
+        if (getIndexSize(order) == 0) {
+            removeFromHashTable(orders,key); // Also destroys the index
+        }
+    }
+    characteristic->order_node = NULL;
+    return s;
+}
 
-    for (int i = 1; i <= listLength; i++) {
-        Jerry* jerry = (Jerry*)getDataByIndex(jerryList, i);
+/**
+ * Adds all Jerry characteristics to a multi-value hash table and to the ordered indexes.
+ * @param jerryList A linked list containing Jerries.
+ * @param mht A multi-value hash table to which the characteristics will be added.
+ * @param orders A hash table of orderedIndex by characteristic name.
+ * @return status Success if all characteristics were added, failure otherwise.
+ */
+status addAllcharToMultiHashTable(linkedlist jerryList, MultiValueHashTable mht, hashTable orders) {
+    if (jerryList == NULL || mht == NULL || orders == NULL) {
+        return failure;
+    }
+
+    for (listNode node = getFirstNode(jerryList); node != NULL; node = getNextNode(node)) {
+        Jerry* jerry = (Jerry*)getNodeData(node);
         if (jerry == NULL) {
             continue;
         }
         // Add each characteristic
         for(int j = 0; j < jerry->characteristics_count; j++) {
-            if (addToMultiValueHashTable(mht,jerry->characteristics[j]->name,jerry)==failure) {
+            if (index_characteristic(mht,orders,jerry,&jerry->characteristics[j])!=success) {
                 return failure; // Return failure if adding failed
             }
         }
@@ -330,6 +416,26 @@ status addAllcharToMultiHashTable(linkedlist jerryList, MultiValueHashTable mht)
     return success;
 }
 
+/**
+ * The indexes of the characteristics, for index_restored_characteristic.
+ */
+typedef struct CharacteristicIndexes_struct {
+    MultiValueHashTable mht;
+    hashTable orders;
+} CharacteristicIndexes;
+
+/**
+ * Indexes a characteristic of a Jerry restored from a snapshot, in the order the snapshot saved.
+ * @param jerry The Jerry that has the characteristic.
+ * @param characteristic The characteristic to index.
+ * @param context A pointer to the CharacteristicIndexes.
+ * @return status Success if the characteristic was indexed, failure otherwise.
+ */
+status index_restored_characteristic(Jerry* jerry, PhysicalCharacteristics* characteristic, Element context) {
+    CharacteristicIndexes* indexes = (CharacteristicIndexes*)context;
+    return index_characteristic(indexes->mht, indexes->orders, jerry, characteristic);
+}
+
 /**
  * Calculates the total number of characteristics across all Jerries in the list.
  * @param jerryList A linked list containing Jerries.
@@ -341,13 +447,8 @@ int sumJerryCharacteristicsCount(linkedlist jerryList) {
     }
 
     int totalCharacteristics = 0;
-    int listLength = getLength(jerryList);
-    if (listLength < 1) {
-        return 0; // Return 0 if the list length is invalid
-    }
-
-    for (int i = 1; i <= listLength; i++) {
-        Jerry* jerry = (Jerry*)getDataByIndex(jerryList, i);
+    for (listNode node = getFirstNode(jerryList); node != NULL; node = getNextNode(node)) {
+        Jerry* jerry = (Jerry*)getNodeData(node);
         if (jerry != NULL) {
             totalCharacteristics += jerry->characteristics_count; // Sum up characteristics
         }
@@ -357,124 +458,104 @@ int sumJerryCharacteristicsCount(linkedlist jerryList) {
 }
 
 /***
- * Cleans up all resources associated with the daycare system.
+ * Cleans up all resources associated with the daycare system, and closes the log of the changes and the roster.
  * @param manager A pointer to the PlanetsManager containing all planet data.
  * @param Jerries A linked list containing all Jerries.
  * @param ht A hash table containing Jerries.
  * @param mht A multi-value hash table containing Jerry characteristics.
+ * @param orders A hash table of the ordered characteristic indexes.
+ * @param moods A min-heap of the Jerries by happiness.
+ * @param store The columnar store of the Jerries' happiness.
+ * @param origins A multi-value hash table of the Jerries by planet name.
  */
-void cleanAll(PlanetsManager* manager,linkedlist Jerries,hashTable ht,MultiValueHashTable mht) {
+void cleanAll(PlanetsManager* manager,linkedlist Jerries,JerryById ht,MultiValueHashTable mht,hashTable orders,priorityQueue moods,jerryStore store,MultiValueHashTable origins) {
+    closeOperationLog(daycare_log); // Writes the changes logged last
+    daycare_log = NULL;
+    closeRosterFeed(daycare_roster);
+    daycare_roster = NULL;
     destroyMultiValueHashTable(mht); // Free the multi-value hash table
-    destroyHashTable(ht); // Free the hash table
+    destroyMultiValueHashTable(origins); // Free the Jerries by planet
+    destroyHashTable(orders); // Free the ordered indexes
+    destroyPriorityQueue(moods); // Free the happiness heap
+    destroyJerryStore(store); // Free the happiness store, before the Jerries
+    JerryById_destroy(ht); // Free the hash table
     destroyLinkedList(Jerries); // Free the linked list of Jerries
     destroy_all_planets(manager); // Free all planet data
+    destroyArena(manager->arena); // Release the planets and Jerries at once
+    manager->arena = NULL;
+    destroy_characteristic_catalog(); // Free the characteristic names, after the Jerries
 }
 
 /**
- * Checks if a planet exists in the PlanetsManager by name.
- * @param manager Pointer to the PlanetsManager structure.
- * @param planet_name Name of the planet to check.
- * @return true if the planet exists, false otherwise.
- */
-bool is_planet_exists(PlanetsManager* manager, char* planet_name) {
-    if (manager == NULL || planet_name == NULL) {
-        return false;
-    }
-    for (int i = 0; i < manager->count; i++) {
-        if (manager->planets[i] != NULL && strcmp(manager->planets[i]->name, planet_name) == 0) {
-            return true;
-        }
-    }
-
-    return false;
-}
-
-/**
- * Deletes all physical characteristics of a given Jerry from the MultiValueHashTable.
+ * Deletes all physical characteristics of a given Jerry from the MultiValueHashTable and the ordered indexes.
  * @param mht Pointer to the MultiValueHashTable.
+ * @param orders A hash table of orderedIndex by characteristic name.
  * @param jerry Pointer to the Jerry whose characteristics will be deleted.
  * @return status Success if deletion succeeded, failure otherwise.
  */
-status deleteAllJerryCHARACTERISTICS(MultiValueHashTable mht,Jerry* jerry) {
+status deleteAllJerryCHARACTERISTICS(MultiValueHashTable mht,hashTable orders,Jerry* jerry) {
     if (jerry == NULL|| mht == NULL) {
         return failure;
     }
     for (int i = 0; i < jerry->characteristics_count; i++) {
-        if (jerry->characteristics[i] != NULL) {
-            removeFromMultiValueHashTable(mht,jerry->characteristics[i]->name,jerry);
-        }
+        unindex_characteristic(mht,orders,&jerry->characteristics[i]);
     }
     return success;
 }
 /**
- * Finds the Jerry with the closest value to the target for a specific characteristic.
- * @param jerryList A linked list containing Jerries.
+ * Removes a Jerry from the daycare: from the characteristics table, the happiness heap and store, the Jerries by planet, the ID table and the Jerries list.
+ * Every step goes through stored handles, so no list is searched.
+ * @param Jerries A linked list of all Jerries in the daycare (destroys the Jerry).
+ * @param ht A hash table of JerryEntry by Jerry ID.
+ * @param mht A multi-value hash table for managing physical characteristics.
+ * @param orders A hash table of orderedIndex by characteristic name.
+ * @param moods A min-heap of the Jerries by happiness.
+ * @param store The columnar store of the Jerries' happiness.
+ * @param origins A multi-value hash table of the Jerries by planet name.
+ * @param jerry Pointer to the Jerry to remove.
+ * @return status Success if the Jerry was removed, Not_Exist if it is not in the daycare.
+ */
+status check_out_jerry(linkedlist Jerries, JerryById ht, MultiValueHashTable mht, hashTable orders, priorityQueue moods, jerryStore store, MultiValueHashTable origins, Jerry* jerry) {
+    if (jerry == NULL) {
+        return failure;
+    }
+    JerryEntry* entry = JerryById_lookup(ht,jerry->id);
+    if (entry == NULL) {
+        return Not_Exist;
+    }
+    listNode node = entry->node;
+    deleteAllJerryCHARACTERISTICS(mht,orders,jerry);
+    removeFromPriorityQueue(moods,entry->mood);
+    removeFromJerryStore(store,jerry);
+    removeHandleFromMultiValueHashTable(origins,jerry->origin->planet->name,entry->origin);
+    JerryById_remove(ht,jerry->id); // Before the Jerry, which owns the key
+    removeByHandle(Jerries,node); // Frees the Jerry
+    return success;
+}
+/**
+ * Finds the Jerry with the closest value to the target for a specific characteristic, in O(log n).
+ * Among equally close Jerries, the one that got the characteristic first is chosen.
+ * @param orders A hash table of orderedIndex by characteristic name.
  * @param characteristic_name Name of the characteristic to compare.
  * @param target_value Target value to find the closest match.
  * @return A pointer to the closest Jerry, or NULL if no match is found.
  */
-Jerry* find_closest_jerry(linkedlist jerryList, char* characteristic_name, double target_value) {
-    if (jerryList == NULL || characteristic_name == NULL) {
+Jerry* find_closest_jerry(hashTable orders, char* characteristic_name, double target_value) {
+    if (orders == NULL || characteristic_name == NULL) {
         return NULL;
     }
-
-    Jerry* closest_jerry = NULL;
-    double closest_diff = -1; // Initialize with a special negative marker
-    int list_length = getLength(jerryList);
-    for (int i = 1; i <= list_length; i++) {
-        Jerry* current_jerry = (Jerry*)getDataByIndex(jerryList, i);
-        if (current_jerry == NULL) {
-            continue; // Skip if the current object is NULL
-        }
-        // Find the characteristic in the current Jerry
-        PhysicalCharacteristics* characteristic = get_characteristic(current_jerry, characteristic_name);
-        if (characteristic != NULL) {
-            // Calculate the absolute difference
-            double diff;
-            if (characteristic->value > target_value) {
-                diff = characteristic->value - target_value;
-            } else {
-                diff = target_value - characteristic->value;
-            }
-
-            // Update the closest Jerry if it's the first or closer than the previous
-            if (closest_jerry == NULL || diff < closest_diff) {
-                closest_diff = diff;
-                closest_jerry = current_jerry;
-            }
-        }
-    }
-    // Return the closest Jerry
-    return closest_jerry;
+    orderedIndex order = lookupInHashTable(orders,characteristic_key(characteristic_name));
+    return (Jerry*)getIndexNodeData(findNearestInIndex(order,target_value));
 }
 
 /**
- * Finds the saddest Jerry in a list.
- * @param Jerries A linked list containing Jerries.
- * @return A pointer to the saddest Jerry, or NULL if the list is empty.
+ * Finds the saddest Jerry in the daycare, in O(1) (O(n) once after activities, to rebuild the heap).
+ * Among equally sad Jerries, the one that came to the daycare first is chosen.
+ * @param moods A min-heap of the Jerries by happiness.
+ * @return A pointer to the saddest Jerry, or NULL if the daycare is empty.
  */
-Jerry* find_the_saddest_jerry(linkedlist Jerries) {
-    if (Jerries == NULL) {
-        return NULL;
-    }
-    int list_length = getLength(Jerries);
-    if (list_length <=0) {
-        return NULL;
-    }
-    Jerry* most_sad_jerry = NULL;
-    int lowest_happiness = 101; // Initialize above the maximum happiness
-    for (int i = 1; i <= list_length; i++) {
-        Jerry* current_jerry = (Jerry*)getDataByIndex(Jerries, i);
-        if (current_jerry == NULL) {
-            continue; // Skip if the current object is NULL
-        }
-        int happiness = current_jerry->happiness;
-        if (happiness < lowest_happiness) {
-            lowest_happiness = happiness;
-            most_sad_jerry = current_jerry;
-        }
-    }
-    return most_sad_jerry;
+Jerry* find_the_saddest_jerry(priorityQueue moods) {
+    return (Jerry*)peekPriorityQueue(moods);
 }
 /**
  * Prints all planets in the PlanetsManager.
@@ -491,108 +572,171 @@ status print_all_planets(PlanetsManager* manager) {
     return Success; // Successfully printed all planets
 }
 
-status interact_with_fake_beth(linkedlist Jerries) {
-    if (Jerries == NULL) {
+/**
+ * Changes the happiness of every Jerry for an activity.
+ * An activity whose result is read right away is applied to every Jerry at once. Deferring it only pays when
+ * activities come back to back with no read in between, like when the log is replayed.
+ * @param store The columnar store of the Jerries' happiness, that records the activity.
+ * @param activity 1 to interact with fake Beth, 2 to play golf, 3 to adjust the picture settings on the TV.
+ * @param deferred true to only record the activity, each Jerry goes through it when its happiness is next read.
+ * @return status success, or Invlid_Input if the activity is not known.
+ */
+status apply_activity(jerryStore store, int activity, bool deferred) {
+    status (*adjust)(jerryStore, int, int, int) = deferred ? deferHappinessAdjustment : adjustHappinessInStore;
+    switch (activity) {
+        case 1:
+            // Jerries with at least 20 gain 15, the others lose 5
+            return adjust(store, 20, 15, -5);
+        case 2:
+            // Jerries with at least 50 gain 10, the others lose 10
+            return adjust(store, 50, 10, -10);
+        case 3:
+            // Every Jerry gains 20
+            return adjust(store, INT_MIN, 20, 20);
+        default:
+            return Invlid_Input;
+    }
+}
+
+status interact_with_fake_beth(jerryStore store, linkedlist Jerries) {
+    if (store == NULL || Jerries == NULL) {
         printf("The list of Jerries is empty!\n");
         return failure;
     }
 
-    int list_length = getLength(Jerries);
-    if (list_length <= 0) {
+    if (getJerryStoreSize(store) <= 0) {
         printf("No Jerries to interact with!\n");
         return failure;
     }
 
-    for (int i = 1; i <= list_length; i++) {
-        Jerry* current_jerry = (Jerry*)getDataByIndex(Jerries, i);
-        if (current_jerry == NULL) {
-            continue; // Skip invalid entries
-        }
-
-        if (current_jerry->happiness >= 20) {
-            current_jerry->happiness += 15;
-            if (current_jerry->happiness > 100) {
-                current_jerry->happiness = 100; // Limit to 100
-            }
-        } else {
-            current_jerry->happiness -= 5;
-            if (current_jerry->happiness < 0) {
-                current_jerry->happiness = 0;  // Limit to 0
-            }
-        }
-
-    }
+    apply_activity(store, 1, false); // The list shows the result right away
     displayList(Jerries);
     return success;
 }
 
-status play_golf_with_jerries(linkedlist Jerries) {
-    if (Jerries == NULL) {
+status play_golf_with_jerries(jerryStore store, linkedlist Jerries) {
+    if (store == NULL || Jerries == NULL) {
         return failure;
     }
 
-    int list_length = getLength(Jerries);
-    if (list_length <= 0) {
+    if (getJerryStoreSize(store) <= 0) {
         return failure;
     }
 
-    for (int i = 1; i <= list_length; i++) {
-        Jerry* current_jerry = (Jerry*)getDataByIndex(Jerries, i);
-        if (current_jerry == NULL) {
-            continue; // Skip invalid entries
-        }
-
-        if (current_jerry->happiness >= 50) {
-            current_jerry->happiness += 10;
-            if (current_jerry->happiness > 100) {
-                current_jerry->happiness = 100; // Limit to 100
-            }
-        } else {
-            current_jerry->happiness -= 10;
-            if (current_jerry->happiness < 0) {
-                current_jerry->happiness = 0;  // Limit to 0
-            }
-        }
-
-    }
+    apply_activity(store, 2, false);
     // Display the updated list
     displayList(Jerries);
     return success;
 }
 
-status adjust_tv_picture_settings(linkedlist Jerries) {
-    if (Jerries == NULL) {
+status adjust_tv_picture_settings(jerryStore store, linkedlist Jerries) {
+    if (store == NULL || Jerries == NULL) {
         return failure;
     }
 
-    int list_length = getLength(Jerries);
-    if (list_length <= 0) {
+    if (getJerryStoreSize(store) <= 0) {
         return failure;
     }
 
-    for (int i = 1; i <= list_length; i++) {
-        Jerry* current_jerry = (Jerry*)getDataByIndex(Jerries, i);
-        if (current_jerry == NULL) {
-            continue; // Skip invalid entries
-        }
-
-        current_jerry->happiness += 20;
-        if (current_jerry->happiness > 100) {
-            current_jerry->happiness = 100; // Limit to 100
-        }
-    }
+    apply_activity(store, 3, false);
     // Display the updated list
     displayList(Jerries);
     return success;
 }
+/**
+ * Checks the result of logging a change before it is made.
+ * A change that could not be logged is not made, and a memory problem stops the daycare like any other.
+ * @param s The status returned by the log.
+ * @return s.
+ */
+status check_logged(status s) {
+    if (s == Memory_Problem) {
+        memory_failure_sign = 1;
+    } else if (s != success) {
+        printf("Rick the log of the daycare can not be written ! \n");
+    }
+    return s;
+}
+/**
+ * Admits a new Jerry: creates it and adds it to the list, the ID table, the happiness heap and store and the Jerries by planet.
+ * @param manager A pointer to the PlanetsManager, that knows the planet.
+ * @param Jerries A linked list of all Jerries in the daycare.
+ * @param ht A hash table for Jerry lookups by ID.
+ * @param moods A min-heap of the Jerries by happiness.
+ * @param store The columnar store of the Jerries' happiness.
+ * @param origins A multi-value hash table of the Jerries by planet name.
+ * @param id The ID of the Jerry, not in the daycare.
+ * @param planet_name The name of a known planet.
+ * @param dimension The dimension of the Jerry.
+ * @param happiness The happiness of the Jerry, between 0 and 100.
+ * @return The new Jerry, or NULL if memory allocation failed.
+ */
+Jerry* admit_jerry(PlanetsManager* manager, linkedlist Jerries, JerryById ht, priorityQueue moods, jerryStore store, MultiValueHashTable origins,
+                   char* id, char* planet_name, char* dimension, int happiness) {
+    // Malloced and not taken from the arena of the manager, which holds what was loaded at startup, so checking out a Jerry admitted later frees it
+    Jerry* new_jerry = create_jerry_on_planet(id,happiness,dimension,find_planet(manager,planet_name),NULL);
+    if (new_jerry == NULL) {
+        memory_failure_sign = 1;
+        return NULL;
+    }
+    listNode node = NULL;
+    if(appendNodeWithHandle(Jerries,new_jerry,&node)!= success) {
+        return NULL;
+    }
+    JerryEntry entry = {new_jerry, node, NULL, NULL};
+    if(addToJerryStore(store,new_jerry)!= success || pushToPriorityQueue(moods,new_jerry,&entry.mood)!= success
+        || addToMultiValueHashTableWithHandle(origins,new_jerry->origin->planet->name,new_jerry,&entry.origin)!= success
+        || JerryById_add(ht,new_jerry->id,entry)!= success) {
+        return NULL;
+    }
+    return new_jerry;
+}
+/**
+ * Adds a physical characteristic to a Jerry and indexes it.
+ * @param mht A multi-value hash table for managing physical characteristics.
+ * @param orders A hash table of the ordered characteristic indexes.
+ * @param jerry The Jerry, that does not have the characteristic.
+ * @param characteristic_name The name of the characteristic.
+ * @param value The value of the characteristic.
+ * @return status success, or Memory_Problem if memory allocation failed.
+ */
+status add_characteristic_to_jerry(MultiValueHashTable mht, hashTable orders, Jerry* jerry, char* characteristic_name, double value) {
+    if(add_physical_characteristic(jerry,characteristic_name,value)!= Success) {
+        return Memory_Problem;
+    }
+    PhysicalCharacteristics* physicalCharacteristics = get_characteristic(jerry,characteristic_name);
+    if(index_characteristic(mht,orders,jerry,physicalCharacteristics)!= success) {
+        return Memory_Problem;
+    }
+    return success;
+}
+/**
+ * Removes a physical characteristic from a Jerry and from the indexes.
+ * @param mht A multi-value hash table for managing physical characteristics.
+ * @param orders A hash table of the ordered characteristic indexes.
+ * @param jerry The Jerry.
+ * @param characteristic The characteristic of the Jerry to remove.
+ * @return status success, or failure if the characteristic was not indexed.
+ */
+status remove_characteristic_from_jerry(MultiValueHashTable mht, hashTable orders, Jerry* jerry, PhysicalCharacteristics* characteristic) {
+    CharacteristicName* name = get_characteristic_name(characteristic->id);
+    if(unindex_characteristic(mht,orders,characteristic)== failure) {
+        return failure;
+    }
+    remove_physical_characteristic(jerry,name->name);
+    return success;
+}
 /**
  * Handles adding a new Jerry to the daycare.
  * @param manager A pointer to the PlanetsManager for managing planets.
  * @param Jerries A linked list of all Jerries in the daycare.
  * @param ht A hash table for Jerry lookups by ID.
+ * @param moods A min-heap of the Jerries by happiness.
+ * @param store The columnar store of the Jerries' happiness.
+ * @param origins A multi-value hash table of the Jerries by planet name.
  * @return Status indicating success, memory problems, invalid input, or if the Jerry already exists.
  */
-status handle_case_1(PlanetsManager* manager, linkedlist Jerries, hashTable ht) {
+status handle_case_1(PlanetsManager* manager, linkedlist Jerries, JerryById ht, priorityQueue moods, jerryStore store, MultiValueHashTable origins) {
     printf("What is your Jerry's ID ? \n");
                 char id[MAX_SIZE];
                 if (scanf("%s", id) != 1) {
@@ -600,7 +744,7 @@ status handle_case_1(PlanetsManager* manager, linkedlist Jerries, hashTable ht)
                     return Invlid_Input;
                 }
                 // Find the Jerry by ID
-                Jerry* jerry = lookupInHashTable(ht,id);
+                Jerry* jerry = find_jerry(ht,id);
                 if (jerry != NULL) {
                     printf("Rick did you forgot ? you already left him here ! \n");
                     while (getchar() != '\n');
@@ -612,7 +756,7 @@ status handle_case_1(PlanetsManager* manager, linkedlist Jerries, hashTable ht)
                     while (getchar() != '\n');
                     return Invlid_Input;
                 }
-                if (!is_planet_exists(manager,planet_name)) {
+                if (find_planet(manager,planet_name) == NULL) {
                     printf("%s is not a known planet ! \n",planet_name);
                     while (getchar() != '\n');
                     return Not_Exist;
@@ -634,15 +778,16 @@ status handle_case_1(PlanetsManager* manager, linkedlist Jerries, hashTable ht)
                 } else if (happiness < 0) {
                     happiness = 0;
                 }
-                Jerry* new_jerry = create_jerry(id,happiness,dimension,manager, planet_name,0,0,0);
-                if(appendNode(Jerries,new_jerry)== failure) {
-                    memory_failure_sign = 1;
-                    return Memory_Problem;
-                };
-                if(addToHashTable(ht,new_jerry->id,new_jerry)== failure) {
+                status logged = check_logged(logAdmit(daycare_log,id,planet_name,dimension,happiness));
+                if (logged != success) {
+                    while (getchar() != '\n');
+                    return logged;
+                }
+                Jerry* new_jerry = admit_jerry(manager,Jerries,ht,moods,store,origins,id,planet_name,dimension,happiness);
+                if (new_jerry == NULL) {
                     memory_failure_sign = 1;
                     return Memory_Problem;
-                };
+                }
                 print_jerry(new_jerry);
                 while (getchar() != '\n');
                 return success;
@@ -651,16 +796,17 @@ status handle_case_1(PlanetsManager* manager, linkedlist Jerries, hashTable ht)
  * Handles adding a physical characteristic to an existing Jerry.
  * @param ht A hash table for Jerry lookups by ID.
  * @param mht A multi-value hash table for managing physical characteristics.
+ * @param orders A hash table of the ordered characteristic indexes.
  * @return Status indicating success, memory problems, invalid input, or if the characteristic already exists.
  */
-status handle_case_2(hashTable ht,MultiValueHashTable mht) {
+status handle_case_2(JerryById ht,MultiValueHashTable mht,hashTable orders) {
     printf("What is your Jerry's ID ? \n");
     char id[MAX_SIZE];
     if (scanf("%s", id) != 1) {
         while (getchar() != '\n'); // Clear invalid input
         return Invlid_Input;
     }
-    Jerry* jerry = lookupInHashTable(ht,id);
+    Jerry* jerry = find_jerry(ht,id);
     if (jerry == NULL) {
         printf("Rick this Jerry is not in the daycare ! \n");
         while (getchar() != '\n');
@@ -683,13 +829,16 @@ status handle_case_2(hashTable ht,MultiValueHashTable mht) {
         while (getchar() != '\n');
         return Invlid_Input;
     }
-    PhysicalCharacteristics* physicalCharacteristics = create_characteristic(characteristic_name,value);
-    add_physical_characteristic(jerry,physicalCharacteristics);
-    if(addToMultiValueHashTable(mht,physicalCharacteristics->name,jerry)== failure) {
+    status logged = check_logged(logAddCharacteristic(daycare_log,id,characteristic_name,value));
+    if (logged != success) {
+        while (getchar() != '\n');
+        return logged;
+    }
+    if(add_characteristic_to_jerry(mht,orders,jerry,characteristic_name,value)!= success) {
         memory_failure_sign = 1;
         return Memory_Problem;
-    };
-    displayMultiValueHashElementsByKey(mht,physicalCharacteristics->name);
+    }
+    displayMultiValueHashElementsByKey(mht,characteristic_key(characteristic_name));
     while (getchar() != '\n');
     return success;
 
@@ -698,9 +847,10 @@ status handle_case_2(hashTable ht,MultiValueHashTable mht) {
  * Handles removing a physical characteristic from an existing Jerry.
  * @param ht A hash table for Jerry lookups by ID.
  * @param mht A multi-value hash table for managing physical characteristics.
+ * @param orders A hash table of the ordered characteristic indexes.
  * @return Status indicating success, memory problems, invalid input, or if the characteristic does not exist.
  */
-status handle_case_3(hashTable ht,MultiValueHashTable mht) {
+status handle_case_3(JerryById ht,MultiValueHashTable mht,hashTable orders) {
     printf("What is your Jerry's ID ? \n");
     char id[MAX_SIZE];
     if (scanf("%s", id) != 1) {
@@ -708,7 +858,7 @@ status handle_case_3(hashTable ht,MultiValueHashTable mht) {
         return Invlid_Input;
     }
 
-    Jerry* jerry = lookupInHashTable(ht,id);
+    Jerry* jerry = find_jerry(ht,id);
     if (jerry == NULL) {
         printf("Rick this Jerry is not in the daycare ! \n");
         while (getchar() != '\n');
@@ -720,17 +870,21 @@ status handle_case_3(hashTable ht,MultiValueHashTable mht) {
         while (getchar() != '\n');
         return Invlid_Input;
     }
-    PhysicalCharacteristics* characteristic_ptr = NULL;
-    if(!does_characteristic_exist(jerry,characteristic_name)) {
+    PhysicalCharacteristics* characteristic_ptr = get_characteristic(jerry,characteristic_name);
+    if(characteristic_ptr == NULL) {
         printf("The information about his %s not available to the daycare ! \n",characteristic_name);
         while (getchar() != '\n');
         return Not_Exist;
     }
-    if(removeFromMultiValueHashTable(mht,characteristic_name,jerry)== failure) {
+    status logged = check_logged(logRemoveCharacteristic(daycare_log,id,characteristic_name));
+    if (logged != success) {
+        while (getchar() != '\n');
+        return logged;
+    }
+    if(remove_characteristic_from_jerry(mht,orders,jerry,characteristic_ptr)== failure) {
         memory_failure_sign = 1;
         return Memory_Problem;
     };
-    remove_physical_characteristic(jerry,characteristic_name);
     print_jerry(jerry);
     while (getchar() != '\n');
     return success;
@@ -740,24 +894,31 @@ status handle_case_3(hashTable ht,MultiValueHashTable mht) {
  * @param Jerries A linked list of all Jerries in the daycare.
  * @param ht A hash table for Jerry lookups by ID.
  * @param mht A multi-value hash table for managing physical characteristics.
+ * @param orders A hash table of the ordered characteristic indexes.
+ * @param moods A min-heap of the Jerries by happiness.
+ * @param store The columnar store of the Jerries' happiness.
+ * @param origins A multi-value hash table of the Jerries by planet name.
  * @return Status indicating success or if the Jerry does not exist.
  */
-status handle_case_4(linkedlist Jerries,hashTable ht,MultiValueHashTable mht) {
+status handle_case_4(linkedlist Jerries,JerryById ht,MultiValueHashTable mht,hashTable orders,priorityQueue moods,jerryStore store,MultiValueHashTable origins) {
     printf("What is your Jerry's ID ? \n");
     char id[MAX_SIZE];
     if (scanf("%s", id) != 1) {
         while (getchar() != '\n');
         return Invlid_Input;
     }
-    Jerry* jerry = lookupInHashTable(ht,id);
+    Jerry* jerry = find_jerry(ht,id);
     if (jerry == NULL) {
         printf("Rick this Jerry is not in the daycare ! \n");
         while (getchar() != '\n');
         return Not_Exist;
     }
-    deleteAllJerryCHARACTERISTICS(mht,jerry);
-    removeFromHashTable(ht,jerry->id);
-    deleteNode(Jerries,jerry);
+    status logged = check_logged(logCheckOut(daycare_log,id));
+    if (logged != success) {
+        while (getchar() != '\n');
+        return logged;
+    }
+    check_out_jerry(Jerries,ht,mht,orders,moods,store,origins,jerry);
     printf("Rick thank you for using our daycare service ! Your Jerry awaits ! \n");
     while (getchar() != '\n');
     return success;
@@ -767,16 +928,20 @@ status handle_case_4(linkedlist Jerries,hashTable ht,MultiValueHashTable mht) {
  * @param Jerries A linked list of all Jerries in the daycare.
  * @param ht A hash table for Jerry lookups by ID.
  * @param mht A multi-value hash table for managing physical characteristics.
+ * @param orders A hash table of the ordered characteristic indexes.
+ * @param moods A min-heap of the Jerries by happiness.
+ * @param store The columnar store of the Jerries' happiness.
+ * @param origins A multi-value hash table of the Jerries by planet name.
  * @return Status indicating success, memory problems, or if no match is found.
  */
-status handle_case_5(linkedlist Jerries, hashTable ht,MultiValueHashTable mht) {
+status handle_case_5(linkedlist Jerries, JerryById ht,MultiValueHashTable mht,hashTable orders,priorityQueue moods,jerryStore store,MultiValueHashTable origins) {
     printf("What do you remember about your Jerry ? \n");
     char characteristic_name[MAX_SIZE];
     if (scanf("%s", characteristic_name) != 1) {
         while (getchar() != '\n');
         return Invlid_Input;
     }
-    linkedlist value_list = lookupInMultiValueHashTable(mht,characteristic_name);
+    linkedlist value_list = lookupInMultiValueHashTable(mht,characteristic_key(characteristic_name));
     if (value_list == NULL) {
         printf("Rick we can not help you - we do not know any Jerry's %s ! \n",characteristic_name);
         while (getchar() != '\n');
@@ -789,12 +954,15 @@ status handle_case_5(linkedlist Jerries, hashTable ht,MultiValueHashTable mht) {
         while (getchar() != '\n');
         return Invlid_Input;
     }
-    Jerry* close_jerry = find_closest_jerry(value_list,characteristic_name,value);
+    Jerry* close_jerry = find_closest_jerry(orders,characteristic_name,value);
+    status logged = check_logged(logCheckOut(daycare_log,close_jerry->id));
+    if (logged != success) {
+        while (getchar() != '\n');
+        return logged;
+    }
     printf("Rick this is the most suitable Jerry we found : \n");
     print_jerry(close_jerry);
-    deleteAllJerryCHARACTERISTICS(mht,close_jerry);
-    removeFromHashTable(ht,close_jerry->id);
-    deleteNode(Jerries,close_jerry);
+    check_out_jerry(Jerries,ht,mht,orders,moods,store,origins,close_jerry);
     printf("Rick thank you for using our daycare service ! Your Jerry awaits ! \n");
     while (getchar() != '\n');
     return success;
@@ -804,34 +972,336 @@ status handle_case_5(linkedlist Jerries, hashTable ht,MultiValueHashTable mht) {
  * @param Jerries A linked list of all Jerries in the daycare.
  * @param ht A hash table for Jerry lookups by ID.
  * @param mht A multi-value hash table for managing physical characteristics.
+ * @param orders A hash table of the ordered characteristic indexes.
+ * @param moods A min-heap of the Jerries by happiness.
+ * @param store The columnar store of the Jerries' happiness.
+ * @param origins A multi-value hash table of the Jerries by planet name.
  * @return Status indicating success or if no Jerries are in the daycare.
  */
-status handle_case_6(linkedlist Jerries, hashTable ht,MultiValueHashTable mht) {
+status handle_case_6(linkedlist Jerries, JerryById ht,MultiValueHashTable mht,hashTable orders,priorityQueue moods,jerryStore store,MultiValueHashTable origins) {
     if (getLength(Jerries) < 1) {
         printf("Rick we can not help you - we currently have no Jerries in the daycare ! \n");
         return zero_jerries;
     }
-    Jerry* jerry = find_the_saddest_jerry(Jerries);
+    Jerry* jerry = find_the_saddest_jerry(moods);
+    status logged = check_logged(logCheckOut(daycare_log,jerry->id));
+    if (logged != success) {
+        return logged;
+    }
     printf("Rick this is the most suitable Jerry we found : \n");
     print_jerry(jerry);
-    deleteAllJerryCHARACTERISTICS(mht,jerry);
-    removeFromHashTable(ht,jerry->id);
-    deleteNode(Jerries,jerry);
+    check_out_jerry(Jerries,ht,mht,orders,moods,store,origins,jerry);
     printf("Rick thank you for using our daycare service ! Your Jerry awaits ! \n");
     return success;
 }
+/**
+ * Prints a Jerry visited by a range query.
+ * @param jerry A pointer to the Jerry.
+ * @param context Not used.
+ * @return status indicating success or failure.
+ */
+status visit_print_jerry(Element jerry, Element context) {
+    (void)context;
+    if (print_jerry((Jerry*)jerry) != Success) {
+        return failure;
+    }
+    return success;
+}
+/**
+ * Prints the Jerries whose characteristic is in [low, high], ordered by the characteristic.
+ * The Jerries are counted and then streamed from the ordered index, no list is built.
+ * @param orders A hash table of orderedIndex by characteristic name.
+ * @param characteristic_name Name of the characteristic.
+ * @param low The lowest value of the range.
+ * @param high The highest value of the range.
+ * @return status Success if Jerries were printed, zero_jerries if the range is empty, Not_Exist if no Jerry has the characteristic.
+ */
+status print_jerries_in_range(hashTable orders, char* characteristic_name, double low, double high) {
+    orderedIndex order = lookupInHashTable(orders,characteristic_key(characteristic_name));
+    if (order == NULL) {
+        return Not_Exist;
+    }
+    int found = countInIndexRange(order,low,high);
+    if (found <= 0) {
+        return zero_jerries;
+    }
+    printf("Rick we found %d Jerries with %s between %.2f and %.2f : \n",found,characteristic_name,low,high);
+    forEachInIndexRange(order,low,high,visit_print_jerry,NULL);
+    return success;
+}
+/**
+ * A profile of remembered characteristic values, searched for by find_similar_jerries.
+ */
+typedef struct Profile_struct {
+    int* ids;                       // Ids of the characteristic names
+    IndexDimension* dimensions;     // Target value, weight and ordered index of every characteristic
+    int count;                      // Number of characteristics
+} Profile;
+
+/**
+ * Calculates the weighted distance of a Jerry from a profile.
+ * @param jerry A pointer to the Jerry.
+ * @param profile A pointer to the Profile.
+ * @return The sum of the weighted squared differences, a characteristic the Jerry lacks adds its missing distance.
+ */
+double profile_distance(Element jerry, Element profile) {
+    Profile* p = (Profile*)profile;
+    double sum = 0;
+    for (int i = 0; i < p->count; i++) {
+        PhysicalCharacteristics* characteristic = get_characteristic_by_id((Jerry*)jerry,p->ids[i]);
+        if (characteristic == NULL) {
+            sum += p->dimensions[i].missing;
+        } else {
+            double diff = characteristic->value - p->dimensions[i].target;
+            sum += p->dimensions[i].weight * diff * diff;
+        }
+    }
+    return sum;
+}
+
+/**
+ * Finds the Jerries closest to a partial profile of characteristic values.
+ * Every characteristic is scaled by the spread of its values in the daycare, so characteristics in
+ * different units weigh the same, and lacking a characteristic counts as being a whole spread away.
+ * Only the Jerries with at least one of the characteristics of the profile are found, a Jerry with none of them
+ * is not in the indexes that are searched.
+ * @param orders A hash table of orderedIndex by characteristic name.
+ * @param names Names of the remembered characteristics.
+ * @param values Remembered values of the characteristics.
+ * @param count Number of remembered characteristics.
+ * @param k Number of Jerries to find.
+ * @param similar Receives the Jerries, closest first (room for k Jerries).
+ * @return The number of Jerries found, or -1 if there was a problem.
+ */
+int find_similar_jerries(hashTable orders, char** names, double* values, int count, int k, Jerry** similar) {
+    if (orders == NULL || names == NULL || values == NULL || count < 1 || count > MAX_PROFILE) {
+        return -1;
+    }
+    IndexDimension dimensions[MAX_PROFILE];
+    int ids[MAX_PROFILE];
+    for (int i = 0; i < count; i++) {
+        ids[i] = find_characteristic_id(names[i]); // Resolved once, the Jerries are matched by id
+        orderedIndex order = lookupInHashTable(orders,get_characteristic_name(ids[i]));
+        double spread = getIndexNodeValue(getLastIndexNode(order)) - getIndexNodeValue(getFirstIndexNode(order));
+        if (spread <= 0) {
+            // A single known value, scale by its size instead
+            spread = getIndexNodeValue(getFirstIndexNode(order));
+            spread = spread < 0 ? -spread : spread;
+            if (spread < 1) {
+                spread = 1;
+            }
+        }
+        dimensions[i].index = order;
+        dimensions[i].target = values[i];
+        dimensions[i].weight = 1 / (spread * spread);
+        dimensions[i].missing = 1;
+    }
+    Profile profile = {ids, dimensions, count};
+    return findNearestInIndexes(dimensions,count,profile_distance,&profile,k,(Element*)similar,NULL);
+}
+
+/**
+ * Asks for a partial profile and prints the Jerries most similar to it, among the Jerries with at least one of
+ * its characteristics. Asking for more Jerries than the daycare holds shows all of them.
+ * @param Jerries A linked list of all Jerries in the daycare.
+ * @param orders A hash table of orderedIndex by characteristic name.
+ * @return status Success if Jerries were printed, Invlid_Input, Memory_Problem or zero_jerries otherwise.
+ */
+status print_similar_jerries(linkedlist Jerries, hashTable orders) {
+    printf("How many physical characteristics do you remember ? \n");
+    int count;
+    if (scanf("%d", &count) != 1 || count < 1 || count > MAX_PROFILE) {
+        printf("Rick this option is not known to the daycare ! \n");
+        while (getchar() != '\n');
+        return Invlid_Input;
+    }
+    char names[MAX_PROFILE][MAX_SIZE];
+    char* name_pointers[MAX_PROFILE];
+    double values[MAX_PROFILE];
+    for (int i = 0; i < count; i++) {
+        printf("What physical characteristic ? \n");
+        if (scanf("%299s", names[i]) != 1) {
+            while (getchar() != '\n');
+            return Invlid_Input;
+        }
+        printf("What is the value of his %s ? \n", names[i]);
+        if (scanf("%lf", &values[i]) != 1) {
+            while (getchar() != '\n');
+            return Invlid_Input;
+        }
+        name_pointers[i] = names[i];
+    }
+    printf("How many Jerries do you want to see ? \n");
+    int k;
+    if (scanf("%d", &k) != 1 || k < 1) {
+        printf("Rick this option is not known to the daycare ! \n");
+        while (getchar() != '\n');
+        return Invlid_Input;
+    }
+    if (k > getLength(Jerries)) {
+        k = getLength(Jerries) > 0 ? getLength(Jerries) : 1; // Every Jerry
+    }
+    Jerry** similar = (Jerry**)malloc(k * sizeof(Jerry*));
+    if (similar == NULL) {
+        memory_failure_sign = 1;
+        return Memory_Problem;
+    }
+    int found = find_similar_jerries(orders,name_pointers,values,count,k,similar);
+    if (found < 0) {
+        free(similar);
+        memory_failure_sign = 1;
+        return Memory_Problem;
+    }
+    if (found == 0) {
+        printf("Rick we can not help you - we do not know any Jerry with these physical characteristics ! \n");
+    } else {
+        printf("Rick these are the most similar Jerries we found : \n");
+        for (int i = 0; i < found; i++) {
+            print_jerry(similar[i]);
+        }
+    }
+    free(similar);
+    while (getchar() != '\n');
+    return found == 0 ? zero_jerries : success;
+}
+/**
+ * Asks for a planet and prints the planets closest to it.
+ * @param manager A pointer to the PlanetsManager.
+ * @return status Success if planets were printed, Invlid_Input, Not_Exist, Memory_Problem or zero_jerries otherwise.
+ */
+status print_closest_planets(PlanetsManager* manager) {
+    printf("Around what planet ? \n");
+    char planet_name[MAX_SIZE];
+    if (scanf("%299s", planet_name) != 1) {
+        while (getchar() != '\n');
+        return Invlid_Input;
+    }
+    Planet* planet = find_planet(manager,planet_name);
+    if (planet == NULL) {
+        printf("%s is not a known planet ! \n",planet_name);
+        while (getchar() != '\n');
+        return Not_Exist;
+    }
+    printf("How many planets do you want to see ? \n");
+    int k;
+    if (scanf("%d", &k) != 1 || k < 1) {
+        printf("Rick this option is not known to the daycare ! \n");
+        while (getchar() != '\n');
+        return Invlid_Input;
+    }
+    if (k >= manager->count) {
+        k = manager->count - 1; // Every other planet
+    }
+    // One more, for the planet itself
+    Planet** nearest = (Planet**)malloc((k + 1) * sizeof(Planet*));
+    if (nearest == NULL) {
+        memory_failure_sign = 1;
+        return Memory_Problem;
+    }
+    int found = find_nearest_planets(manager,planet->x,planet->y,planet->z,k + 1,nearest);
+    if (found < 0) {
+        free(nearest);
+        memory_failure_sign = 1;
+        return Memory_Problem;
+    }
+    int printed = 0;
+    for (int i = 0; i < found && printed < k; i++) {
+        if (nearest[i] == planet) {
+            continue;
+        }
+        if (printed == 0) {
+            printf("Rick these are the planets closest to %s : \n",planet_name);
+        }
+        print_planet(nearest[i]);
+        printed++;
+    }
+    if (printed == 0) {
+        printf("Rick we can not help you - we do not know any other planet ! \n");
+    }
+    free(nearest);
+    while (getchar() != '\n');
+    return printed == 0 ? zero_jerries : success;
+}
+/**
+ * The state of a search for the Jerries from the planets around a planet.
+ */
+typedef struct Neighbourhood_struct {
+    MultiValueHashTable origins;    // The Jerries of the daycare by planet name
+    int found;                      // Number of Jerries printed so far
+} Neighbourhood;
+
+/**
+ * Prints a planet visited by a radius query with the Jerries in the daycare that come from it.
+ * @param planet A pointer to the Planet.
+ * @param context A pointer to the Neighbourhood of the search.
+ * @return status indicating success or failure.
+ */
+status visit_print_planet_jerries(Element planet, Element context) {
+    Neighbourhood* neighbourhood = (Neighbourhood*)context;
+    linkedlist Jerries = lookupInMultiValueHashTable(neighbourhood->origins,((Planet*)planet)->name);
+    if (Jerries == NULL) {
+        return success; // No Jerry from this planet
+    }
+    print_planet((Planet*)planet);
+    neighbourhood->found += getLength(Jerries);
+    return displayList(Jerries);
+}
+/**
+ * Asks for a planet and a radius and prints the Jerries that come from the planets within the radius, closest planet first.
+ * Only the planets near the searched one are visited, through the spatial index, and only their Jerries are printed.
+ * @param manager A pointer to the PlanetsManager.
+ * @param origins A multi-value hash table of the Jerries by planet name.
+ * @return status Success if Jerries were printed, Invlid_Input, Not_Exist, Memory_Problem or zero_jerries otherwise.
+ */
+status print_jerries_around_planet(PlanetsManager* manager, MultiValueHashTable origins) {
+    printf("Around what planet ? \n");
+    char planet_name[MAX_SIZE];
+    if (scanf("%299s", planet_name) != 1) {
+        while (getchar() != '\n');
+        return Invlid_Input;
+    }
+    Planet* planet = find_planet(manager,planet_name);
+    if (planet == NULL) {
+        printf("%s is not a known planet ! \n",planet_name);
+        while (getchar() != '\n');
+        return Not_Exist;
+    }
+    printf("What is the radius ? \n");
+    double radius;
+    if (scanf("%lf", &radius) != 1 || radius < 0) {
+        printf("Rick this option is not known to the daycare ! \n");
+        while (getchar() != '\n');
+        return Invlid_Input;
+    }
+    Neighbourhood neighbourhood = {origins, 0};
+    if (for_each_planet_within(manager,planet->x,planet->y,planet->z,radius,visit_print_planet_jerries,&neighbourhood) == Memory_Problem) {
+        memory_failure_sign = 1;
+        return Memory_Problem;
+    }
+    if (neighbourhood.found == 0) {
+        printf("Rick we can not help you - no Jerry in the daycare is from a planet around %s ! \n",planet_name);
+    }
+    while (getchar() != '\n');
+    return neighbourhood.found == 0 ? zero_jerries : success;
+}
 /**
  * Handles displaying daycare information based on user choice.
  * @param manager A pointer to the PlanetsManager for managing planets.
  * @param Jerries A linked list of all Jerries in the daycare.
  * @param mht A multi-value hash table for managing physical characteristics.
+ * @param orders A hash table of the ordered characteristic indexes.
+ * @param origins A multi-value hash table of the Jerries by planet name.
  */
-void handle_case_7(PlanetsManager* manager, linkedlist Jerries, MultiValueHashTable mht) {
+void handle_case_7(PlanetsManager* manager, linkedlist Jerries, MultiValueHashTable mht, hashTable orders, MultiValueHashTable origins) {
     while (true) {
         printf("What information do you want to know ? \n");
         printf("1 : All Jerries \n");
         printf("2 : All Jerries by physical characteristics \n");
         printf("3 : All known planets \n");
+        printf("4 : All Jerries by physical characteristics range \n");
+        printf("5 : The Jerries most similar to a profile, among those with one of its characteristics \n");
+        printf("6 : The planets closest to a planet \n");
+        printf("7 : All Jerries from the planets around a planet \n");
 
         char input[MAX_SIZE];
         if (fgets(input, MAX_SIZE, stdin) == NULL) {
@@ -839,7 +1309,7 @@ void handle_case_7(PlanetsManager* manager, linkedlist Jerries, MultiValueHashTa
             continue;
         }
         input[strcspn(input, "\n")] = '\0'; // Remove trailing newline
-        if (strlen(input) != 1 || input[0] < '1' || input[0] > '3') {
+        if (strlen(input) != 1 || input[0] < '1' || input[0] > '7') {
             printf("Rick this option is not known to the daycare ! \n");
             break;
         }
@@ -861,13 +1331,14 @@ void handle_case_7(PlanetsManager* manager, linkedlist Jerries, MultiValueHashTa
                     while (getchar() != '\n'); // Clear input buffer
                     break;
                 }
-                linkedlist value_list = lookupInMultiValueHashTable(mht, characteristic_name);
+                CharacteristicName* key = characteristic_key(characteristic_name);
+                linkedlist value_list = lookupInMultiValueHashTable(mht, key);
                 if (value_list == NULL) {
                     printf("Rick we can not help you - we do not know any Jerry's %s ! \n", characteristic_name);
                     while (getchar() != '\n');
                     break;
                 }
-                displayMultiValueHashElementsByKey(mht, characteristic_name);
+                displayMultiValueHashElementsByKey(mht, key);
                 while (getchar() != '\n');
                 break;
             }
@@ -875,6 +1346,47 @@ void handle_case_7(PlanetsManager* manager, linkedlist Jerries, MultiValueHashTa
                 print_all_planets(manager);
                 break;
             }
+            case 4: {
+                printf("What physical characteristics ? \n");
+                char characteristic_name[MAX_SIZE];
+                if (scanf("%s", characteristic_name) != 1) {
+                    while (getchar() != '\n'); // Clear input buffer
+                    break;
+                }
+                if (lookupInHashTable(orders, characteristic_key(characteristic_name)) == NULL) {
+                    printf("Rick we can not help you - we do not know any Jerry's %s ! \n", characteristic_name);
+                    while (getchar() != '\n');
+                    break;
+                }
+                double low, high;
+                printf("What is the lowest value of his %s ? \n", characteristic_name);
+                if (scanf("%lf", &low) != 1) {
+                    while (getchar() != '\n');
+                    break;
+                }
+                printf("What is the highest value of his %s ? \n", characteristic_name);
+                if (scanf("%lf", &high) != 1) {
+                    while (getchar() != '\n');
+                    break;
+                }
+                if (print_jerries_in_range(orders, characteristic_name, low, high) != success) {
+                    printf("Rick we can not help you - we do not know any Jerry with %s in this range ! \n", characteristic_name);
+                }
+                while (getchar() != '\n');
+                break;
+            }
+            case 5: {
+                print_similar_jerries(Jerries,orders);
+                break;
+            }
+            case 6: {
+                print_closest_planets(manager);
+                break;
+            }
+            case 7: {
+                print_jerries_around_planet(manager,origins);
+                break;
+            }
         }
         break; // Exit the while loop after handling the choice
     }
@@ -882,8 +1394,10 @@ void handle_case_7(PlanetsManager* manager, linkedlist Jerries, MultiValueHashTa
 /**
  * Handles engaging Jerries in activities based on user choice.
  * @param Jerries A linked list of all Jerries in the daycare.
+ * @param moods A min-heap of the Jerries by happiness, rebuilt when it is next used.
+ * @param store The columnar store of the Jerries' happiness, that records the activity.
  */
-void handle_case_8(linkedlist Jerries) {
+void handle_case_8(linkedlist Jerries, priorityQueue moods, jerryStore store) {
     while (true) {
         if (getLength(Jerries) < 1) {
             printf("Rick we can not help you - we currently have no Jerries in the daycare ! \n");
@@ -905,23 +1419,27 @@ void handle_case_8(linkedlist Jerries) {
             break;
         }
         int choice8 = input[0] - '0';
+        if (check_logged(logActivity(daycare_log, choice8)) != success) {
+            break;
+        }
         switch (choice8) {
             case 1: {
                 printf("The activity is now over ! \n");
-                interact_with_fake_beth(Jerries);
+                interact_with_fake_beth(store,Jerries);
                 break;
             }
             case 2: {
                 printf("The activity is now over ! \n");
-                play_golf_with_jerries(Jerries);
+                play_golf_with_jerries(store,Jerries);
                 break;
             }
             case 3: {
                 printf("The activity is now over ! \n");
-                adjust_tv_picture_settings(Jerries);
+                adjust_tv_picture_settings(store,Jerries);
                 break;
             }
         }
+        invalidatePriorityQueue(moods); // The activity changed the happiness of every Jerry
         break; // Exit the while loop after one activity
     }
 }
@@ -930,11 +1448,156 @@ void handle_case_8(linkedlist Jerries) {
 
 
 
-void menu(PlanetsManager* manager,linkedlist Jerries,hashTable ht,MultiValueHashTable mht) {
+/**
+ * The structures of the daycare, for the replay of its log and the intake of its roster.
+ */
+typedef struct Daycare_struct {
+    PlanetsManager* manager;
+    linkedlist Jerries;
+    JerryById ht;
+    MultiValueHashTable mht;
+    hashTable orders;
+    priorityQueue moods;
+    jerryStore store;
+    MultiValueHashTable origins;
+} Daycare;
+
+/**
+ * The progress of a batch of the roster.
+ */
+typedef struct RosterIntake_struct {
+    Daycare* daycare;
+    int admitted;  // Jerries admitted
+    int skipped;   // Jerries already in the daycare or from unknown planets
+} RosterIntake;
+
+/**
+ * Admits a Jerry read from the roster, like one admitted from the menu: logged first, and skipped if its ID is
+ * already in the daycare or its planet is not known.
+ * @param context A pointer to the RosterIntake.
+ * @return status success, or the status of a log or a memory problem.
+ */
+status intake_jerry(Element context, char* id, char* dimension, char* planet, int happiness) {
+    RosterIntake* intake = (RosterIntake*)context;
+    Daycare* daycare = intake->daycare;
+    roster_last_id[0] = '\0';
+    if (find_jerry(daycare->ht,id) != NULL || find_planet(daycare->manager,planet) == NULL) {
+        intake->skipped++;
+        return success;
+    }
+    if (happiness > 100) {
+        happiness = 100;
+    } else if (happiness < 0) {
+        happiness = 0;
+    }
+    status logged = check_logged(logAdmit(daycare_log,id,planet,dimension,happiness));
+    if (logged != success) {
+        return logged;
+    }
+    if (admit_jerry(daycare->manager,daycare->Jerries,daycare->ht,daycare->moods,daycare->store,daycare->origins,
+                    id,planet,dimension,happiness) == NULL) {
+        memory_failure_sign = 1;
+        return Memory_Problem;
+    }
+    strcpy(roster_last_id,id);
+    intake->admitted++;
+    return success;
+}
+
+/**
+ * Adds a characteristic read from the roster to the last Jerry read from it, unless that Jerry was skipped,
+ * left the daycare, or already has the characteristic.
+ * @param context A pointer to the RosterIntake.
+ * @return status success, or the status of a log or a memory problem.
+ */
+status intake_characteristic(Element context, char* name, double value) {
+    Daycare* daycare = ((RosterIntake*)context)->daycare;
+    Jerry* jerry = roster_last_id[0] == '\0' ? NULL : find_jerry(daycare->ht,roster_last_id);
+    if (jerry == NULL || does_characteristic_exist(jerry,name)) {
+        return success;
+    }
+    status logged = check_logged(logAddCharacteristic(daycare_log,jerry->id,name,value));
+    if (logged != success) {
+        return logged;
+    }
+    if (add_characteristic_to_jerry(daycare->mht,daycare->orders,jerry,name,value) != success) {
+        memory_failure_sign = 1;
+        return Memory_Problem;
+    }
+    return success;
+}
+
+/**
+ * Admits the Jerries appended to the followed roster since the last command, and tells Rick how many arrived.
+ * The roster is no longer followed once it cannot be read or the log of the daycare cannot be written.
+ * @param daycare The structures of the daycare.
+ */
+void intake_roster(Daycare* daycare) {
+    if (daycare_roster == NULL) {
+        return;
+    }
+    RosterIntake intake = {daycare, 0, 0};
+    ConfigHandlers handlers = {NULL, intake_jerry, intake_characteristic};
+    status s = pollRosterFeed(daycare_roster,&handlers,&intake);
+    if (s == Memory_Problem) {
+        memory_failure_sign = 1;
+    }
+    if (intake.admitted > 0) {
+        printf("Rick %d new Jerries arrived at the daycare ! \n", intake.admitted);
+    }
+    if (intake.skipped > 0) {
+        printf("Rick %d Jerries of the roster could not be admitted ! \n", intake.skipped);
+    }
+    if (s != success && s != Memory_Problem) {
+        // The log failed or the roster cannot be read, polling again would fail the same way before every command
+        closeRosterFeed(daycare_roster);
+        daycare_roster = NULL;
+        printf("Rick the daycare stopped following the roster ! \n");
+    }
+}
+
+/**
+ * Asks for a file and saves the whole daycare to it, for a fast restart with --snapshot.
+ * The log of the changes, if the daycare keeps one, is emptied and continues from the snapshot.
+ * @param manager A pointer to the PlanetsManager.
+ * @param Jerries The list of all Jerries.
+ * @param mht The multi-value hash table of the Jerries by characteristic name.
+ * @return status Success if the daycare was saved, Invlid_Input or Memory_Problem otherwise.
+ */
+status handle_case_0(PlanetsManager* manager, linkedlist Jerries, MultiValueHashTable mht) {
+    printf("What is the name of the snapshot file ? \n");
+    char file_name[MAX_SIZE];
+    if (scanf("%299s", file_name) != 1) {
+        while (getchar() != '\n');
+        return Invlid_Input;
+    }
+    while (getchar() != '\n');
+    unsigned long long checksum = 0;
+    // The snapshot keeps the base of the log, so a crash before the log is emptied below leaves a log it recognizes
+    unsigned long long log_base = getOperationLogBase(daycare_log);
+    status s = save_snapshot(file_name, manager, Jerries, mht, daycare_log != NULL ? &log_base : NULL, &checksum);
+    if (s == Memory_Problem) {
+        memory_failure_sign = 1;
+        return Memory_Problem;
+    }
+    if (s != success) {
+        printf("Rick we could not save the daycare to %s ! \n", file_name);
+        return Invlid_Input;
+    }
+    printf("The daycare was saved to %s ! \n", file_name);
+    // The snapshot holds every change logged so far, the log starts over from it
+    if (daycare_log != NULL && check_logged(resetOperationLog(daycare_log, checksum)) != success) {
+        return failure;
+    }
+    return Success;
+}
+void menu(PlanetsManager* manager,linkedlist Jerries,JerryById ht,MultiValueHashTable mht,hashTable orders,priorityQueue moods,jerryStore store,MultiValueHashTable origins) {
+    Daycare daycare = {manager, Jerries, ht, mht, orders, moods, store, origins};
     while (true) {
+        intake_roster(&daycare); // The Jerries of the roster arrive between commands
         if (memory_failure_sign == 1) {
             printf("Memory Problem\n");
-            cleanAll(manager,Jerries,ht,mht);
+            cleanAll(manager,Jerries,ht,mht,orders,moods,store,origins);
             exit(0);
         }
 
@@ -948,6 +1611,7 @@ void menu(PlanetsManager* manager,linkedlist Jerries,hashTable ht,MultiValueHash
         printf("7 : Show me what you got \n");
         printf("8 : Let the Jerries play \n");
         printf("9 : I had enough. Close this place \n");
+        printf("0 : Save the daycare for a fast restart \n");
 
         char input[MAX_SIZE];
         if (fgets(input, MAX_SIZE, stdin) == NULL) {
@@ -955,53 +1619,57 @@ void menu(PlanetsManager* manager,linkedlist Jerries,hashTable ht,MultiValueHash
             continue;
         }
         input[strcspn(input, "\n")] = '\0';
-        if (strlen(input) != 1 || input[0] < '1' || input[0] > '9') {
+        if (strlen(input) != 1 || input[0] < '0' || input[0] > '9') {
             printf("Rick this option is not known to the daycare ! \n");
             continue;
         }
         int choice = input[0] - '0';
 
         switch (choice) {
+            case 0: {
+                handle_case_0(manager, Jerries, mht);
+                break;
+            }
             case 1: {
-                handle_case_1(manager, Jerries, ht);
+                handle_case_1(manager, Jerries, ht, moods, store, origins);
                 break;
 
             }
             case 2: {
-                handle_case_2(ht,mht);
+                handle_case_2(ht,mht,orders);
                 break;
 
             }
 
             case 3: {
-                handle_case_3(ht,mht);
+                handle_case_3(ht,mht,orders);
                 break;
             }
             case 4: {
-                handle_case_4(Jerries,ht,mht);
+                handle_case_4(Jerries,ht,mht,orders,moods,store,origins);
                 break;
             }
             case 5: {
-                handle_case_5(Jerries,ht,mht);
+                handle_case_5(Jerries,ht,mht,orders,moods,store,origins);
                 break;
             }
             case 6: {
-                handle_case_6(Jerries,ht,mht);
+                handle_case_6(Jerries,ht,mht,orders,moods,store,origins);
                 break;
             }
             case 7: {
-                handle_case_7(manager,Jerries,mht);
+                handle_case_7(manager,Jerries,mht,orders,origins);
                 break;
 
             }
             case 8: {
-                handle_case_8(Jerries);
+                handle_case_8(Jerries,moods,store);
                 break;
             }
 
 
             case 9: {
-                    cleanAll(manager,Jerries,ht,mht);
+                    cleanAll(manager,Jerries,ht,mht,orders,moods,store,origins);
                     printf("The daycare is now clean and close ! \n");
                     exit(0);
                 }
@@ -1010,37 +1678,170 @@ void menu(PlanetsManager* manager,linkedlist Jerries,hashTable ht,MultiValueHash
 
         }
     }
+/**
+ * Replays the admission of a Jerry from the log.
+ * @param context A pointer to the Daycare.
+ * @return status success, Alreaqdy_Exist or Not_Exist if the log does not match the daycare, or Memory_Problem.
+ */
+status replay_admit(Element context, char* id, char* planet, char* dimension, int happiness) {
+    Daycare* daycare = (Daycare*)context;
+    if (find_jerry(daycare->ht,id) != NULL) {
+        return Alreaqdy_Exist;
+    }
+    if (find_planet(daycare->manager,planet) == NULL) {
+        return Not_Exist;
+    }
+    Jerry* jerry = admit_jerry(daycare->manager,daycare->Jerries,daycare->ht,daycare->moods,daycare->store,daycare->origins,
+                               id,planet,dimension,happiness);
+    return jerry != NULL ? success : Memory_Problem;
+}
+
+/**
+ * Replays a characteristic added to a Jerry from the log.
+ * @param context A pointer to the Daycare.
+ * @return status success, Alreaqdy_Exist or Not_Exist if the log does not match the daycare, or Memory_Problem.
+ */
+status replay_add_characteristic(Element context, char* id, char* name, double value) {
+    Daycare* daycare = (Daycare*)context;
+    Jerry* jerry = find_jerry(daycare->ht,id);
+    if (jerry == NULL) {
+        return Not_Exist;
+    }
+    if (does_characteristic_exist(jerry,name)) {
+        return Alreaqdy_Exist;
+    }
+    return add_characteristic_to_jerry(daycare->mht,daycare->orders,jerry,name,value);
+}
+
+/**
+ * Replays a characteristic removed from a Jerry from the log.
+ * @param context A pointer to the Daycare.
+ * @return status success, Not_Exist if the log does not match the daycare, or failure.
+ */
+status replay_remove_characteristic(Element context, char* id, char* name) {
+    Daycare* daycare = (Daycare*)context;
+    Jerry* jerry = find_jerry(daycare->ht,id);
+    PhysicalCharacteristics* characteristic = jerry == NULL ? NULL : get_characteristic(jerry,name);
+    if (characteristic == NULL) {
+        return Not_Exist;
+    }
+    return remove_characteristic_from_jerry(daycare->mht,daycare->orders,jerry,characteristic);
+}
+
+/**
+ * Replays the checkout of a Jerry from the log.
+ * @param context A pointer to the Daycare.
+ * @return status success, or Not_Exist if the log does not match the daycare.
+ */
+status replay_check_out(Element context, char* id) {
+    Daycare* daycare = (Daycare*)context;
+    Jerry* jerry = find_jerry(daycare->ht,id);
+    if (jerry == NULL) {
+        return Not_Exist;
+    }
+    return check_out_jerry(daycare->Jerries,daycare->ht,daycare->mht,daycare->orders,daycare->moods,daycare->store,daycare->origins,jerry);
+}
+
+/**
+ * Replays an activity of the Jerries from the log.
+ * The activity is deferred, the Jerries go through all the replayed activities when they are next read.
+ * @param context A pointer to the Daycare.
+ * @return status success, or Invlid_Input if the activity is not known.
+ */
+status replay_activity(Element context, int activity) {
+    Daycare* daycare = (Daycare*)context;
+    status s = apply_activity(daycare->store,activity,true); // Replayed activities come back to back
+    invalidatePriorityQueue(daycare->moods);
+    return s;
+}
+
+/**
+ * Reads the name of a durability of the log.
+ * @param name unsynced, group or sync.
+ * @param durability Receives the durability.
+ * @return true if the name is known, false otherwise.
+ */
+bool read_durability(char* name, logDurability* durability) {
+    if (strcmp(name, "unsynced") == 0) {
+        *durability = Log_Unsynced;
+    } else if (strcmp(name, "group") == 0) {
+        *durability = Log_Group_Commit;
+    } else if (strcmp(name, "sync") == 0) {
+        *durability = Log_Synchronous;
+    } else {
+        return false;
+    }
+    return true;
+}
+
 int main(int argc, char* argv[]) {
-    if (argc != 3) {
+    // JerryBoree <numberOfPlanets> <configurationFile> [--snapshot <snapshotFile>] [--log <logFile>] [--durability <unsynced|group|sync>]
+    //            [--follow <rosterFile>]
+    if (argc < 3 || argc % 2 == 0) {
         return 1;
     }
     // Parse input arguments
     int number_of_planets = atoi(argv[1]);
     char* configuration_file = argv[2];
+    char* snapshot_file = NULL;
+    char* log_file = NULL;
+    char* roster_file = NULL;
+    logDurability durability = Log_Group_Commit;
+    for (int i = 3; i < argc; i += 2) {
+        if (strcmp(argv[i], "--snapshot") == 0) {
+            // A snapshot that exists replaces the configuration file
+            snapshot_file = access(argv[i + 1], F_OK) == 0 ? argv[i + 1] : NULL;
+        } else if (strcmp(argv[i], "--log") == 0) {
+            log_file = argv[i + 1];
+        } else if (strcmp(argv[i], "--follow") == 0) {
+            roster_file = argv[i + 1];
+        } else if (strcmp(argv[i], "--durability") != 0 || !read_durability(argv[i + 1], &durability)) {
+            return 1;
+        }
+    }
 
     // Initialize PlanetsManager and Jerries array
     PlanetsManager manager = {NULL, 0};
 
     // Initialize PlanetsManager and the linked list for Jerries
-    linkedlist Jerries = createLinkedList( (CopyFunction)shallowCopyElement,
+    // The list creates its own node pool, released in bulk when the list is destroyed
+    linkedlist Jerries = createLinkedListWithPool( (CopyFunction)shallowCopyElement,
     (FreeFunction)destroy_jerry,
     (PrintFunction)print_jerry,
-    (EqualFunction)equalJerry
+    (EqualFunction)equalJerry,
+    NULL
    );
     if (Jerries == NULL) {
         fprintf(stdout, "Memory Problem\n");
         // No memory has been allocated yet, so nothing to clean up
         return 1;
     }
-    // Read the configuration file and populate the data structures
-    status s = read_configuration_file(configuration_file, &manager,Jerries);
-
+    // The planets and the Jerries loaded at startup are allocated from one arena, released in bulk when the daycare closes
+    manager.arena = createArena(ARENA_BLOCK_SIZE);
+    if (manager.arena == NULL) {
+        fprintf(stdout, "Memory Problem\n");
+        destroyLinkedList(Jerries);
+        return 1;
+    }
+    // Read the configuration file, or restore the snapshot, and populate the data structures
+    status s;
+    snapshot restored = NULL;
+    if (snapshot_file != NULL) {
+        restored = load_snapshot(snapshot_file, &manager, Jerries, &s);
+    } else {
+        s = read_configuration_file(configuration_file, &manager,Jerries);
+    }
     // Exit the program and clean up all allocated memory if there is a memory problem
     if (s == Memory_Problem || memory_failure_sign) {
         fprintf(stdout, "Memory Problem\n");
         go_home(Jerries,&manager);
         return 1;
     }
+    if (snapshot_file != NULL && restored == NULL) {
+        fprintf(stdout, "Rick %s is not a snapshot of the daycare ! \n", snapshot_file);
+        go_home(Jerries,&manager);
+        return 1;
+    }
     // Compute hash table sizes based on the number of Jerries and characteristics
     int hashSize;
     hashSize = nextPrime(getLength(Jerries));
@@ -1053,30 +1854,97 @@ int main(int argc, char* argv[]) {
         multihashsize = hashSize;
     }
     // Create hash table for Jerry objects
-    hashTable ht = createHashTable((CopyFunction)deepCopyString,(FreeFunction)freeString,(PrintFunction)printJerryID,(CopyFunction)shallowCopyElement,(FreeFunction)fakeFree,(PrintFunction)print_jerry,(EqualFunction)equalStrings,(TransformIntoNumberFunction)stringToAsciiSum,hashSize);
+    JerryById ht = JerryById_create(hashSize);
     if(ht == NULL) {
         fprintf(stdout, "Memory Problem\n");
+        close_snapshot(restored);
         go_home(Jerries,&manager);
         return 1;
     }
     // Create multi-value hash table for physical characteristics
-    MultiValueHashTable mht = createMultiValueHashTable((CopyFunction)deepCopyString,(FreeFunction) freeString,(PrintFunction) printPhysicalCharacteristic,(CopyFunction)shallowCopyElement,(FreeFunction) fakeFree,(PrintFunction)print_jerry,(EqualFunction)equalStrings,(EqualFunction)equalJerry,(TransformIntoNumberFunction)stringToAsciiSum,multihashsize);
+    // Keyed by the names of the catalog, compared and hashed by id
+    MultiValueHashTable mht = createMultiValueHashTable((CopyFunction)shallowCopyElement,(FreeFunction) fakeFree,(PrintFunction) printPhysicalCharacteristic,(CopyFunction)shallowCopyElement,(FreeFunction) fakeFree,(PrintFunction)print_jerry,(EqualFunction)equalCharacteristicNames,(EqualFunction)equalJerry,(TransformIntoNumberFunction)characteristicNameToNumber,multihashsize);
     if(mht == NULL) {
         fprintf(stdout, "Memory Problem\n");
-        cleanAll(&manager,Jerries,ht,mht);
+        close_snapshot(restored);
+        cleanAll(&manager,Jerries,ht,mht,NULL,NULL,NULL,NULL);
+        return 1;
+    }
+    // Create hash table of the ordered index of every characteristic, for the closest value searches
+    hashTable orders = createHashTable((CopyFunction)shallowCopyElement,(FreeFunction)fakeFree,(PrintFunction)printPhysicalCharacteristic,(CopyFunction)shallowCopyElement,(FreeFunction)destroyOrderedIndex,(PrintFunction)displayOrderedIndex,(EqualFunction)equalCharacteristicNames,(TransformIntoNumberFunction)characteristicNameToNumber,hashSize);
+    if(orders == NULL) {
+        fprintf(stdout, "Memory Problem\n");
+        close_snapshot(restored);
+        cleanAll(&manager,Jerries,ht,mht,orders,NULL,NULL,NULL);
+        return 1;
+    }
+    // Create the happiness heap, for the saddest Jerry, and the happiness store, for the activities
+    priorityQueue moods = createPriorityQueue((CopyFunction)shallowCopyElement,(FreeFunction)fakeFree,(PrintFunction)print_jerry,(CompareFunction)compareHappiness);
+    jerryStore store = createJerryStore(getLength(Jerries));
+    if(moods == NULL || store == NULL) {
+        fprintf(stdout, "Memory Problem\n");
+        close_snapshot(restored);
+        cleanAll(&manager,Jerries,ht,mht,orders,moods,store,NULL);
+        return 1;
+    }
+    // Create multi-value hash table of the Jerries by planet name, for the searches around a planet
+    MultiValueHashTable origins = createMultiValueHashTable((CopyFunction)deepCopyString,(FreeFunction) freeString,(PrintFunction) printPlanetName,(CopyFunction)shallowCopyElement,(FreeFunction) fakeFree,(PrintFunction)print_jerry,(EqualFunction)equalStrings,(EqualFunction)equalJerry,(TransformIntoNumberFunction)stringToAsciiSum,hashSize);
+    if(origins == NULL) {
+        fprintf(stdout, "Memory Problem\n");
+        close_snapshot(restored);
+        cleanAll(&manager,Jerries,ht,mht,orders,moods,store,origins);
         return 1;
     }
-    if(addAllJerriesToHashTable(Jerries,ht)==failure) {
+    setMultiValueHashFunction(origins,(HashFunction)wyhashString);
+    if(addAllJerriesToHashTable(Jerries,ht,moods,store,origins)==failure) {
         fprintf(stdout, "Memory Problem\n");
-        cleanAll(&manager,Jerries,ht,mht);
+        close_snapshot(restored);
+        cleanAll(&manager,Jerries,ht,mht,orders,moods,store,origins);
         return 1;
     }
-    if(addAllcharToMultiHashTable(Jerries,mht)==failure) {
+    // The characteristics of a snapshot are indexed in their saved order, so ties keep their order
+    CharacteristicIndexes indexes = {mht, orders};
+    s = restored != NULL ? index_snapshot_characteristics(restored, index_restored_characteristic, &indexes)
+                         : addAllcharToMultiHashTable(Jerries,mht,orders);
+    unsigned long long base = get_snapshot_checksum(restored); // The state the log applies to, 0 for the configuration file
+    unsigned long long applied = 0; // The base of a log the snapshot was saved from, its changes are in the snapshot
+    bool superseded = get_snapshot_log_base(restored, &applied);
+    close_snapshot(restored);
+    if(s==failure) {
         fprintf(stdout, "Memory Problem\n");
-        cleanAll(&manager,Jerries,ht,mht);
+        cleanAll(&manager,Jerries,ht,mht,orders,moods,store,origins);
         return 1;
     }
+    // Replay the changes logged since the daycare was loaded, and log the next ones
+    if (log_file != NULL) {
+        Daycare daycare = {&manager, Jerries, ht, mht, orders, moods, store, origins};
+        LogHandlers handlers = {replay_admit, replay_add_characteristic, replay_remove_characteristic, replay_check_out, replay_activity};
+        daycare_log = openOperationLog(log_file, durability, base, superseded ? &applied : NULL, &handlers, &daycare, &s);
+        if (s == Memory_Problem || memory_failure_sign) {
+            fprintf(stdout, "Memory Problem\n");
+            cleanAll(&manager,Jerries,ht,mht,orders,moods,store,origins);
+            return 1;
+        }
+        if (daycare_log == NULL) {
+            fprintf(stdout, "Rick %s is not a log of this daycare ! \n", log_file);
+            cleanAll(&manager,Jerries,ht,mht,orders,moods,store,origins);
+            return 1;
+        }
+    }
+    // Follow the roster from its current end, the Jerries appended to it are admitted between commands
+    if (roster_file != NULL) {
+        daycare_roster = openRosterFeed(roster_file, &s);
+        if (daycare_roster == NULL) {
+            if (s == Memory_Problem) {
+                fprintf(stdout, "Memory Problem\n");
+            } else {
+                fprintf(stdout, "Rick %s can not be followed ! \n", roster_file);
+            }
+            cleanAll(&manager,Jerries,ht,mht,orders,moods,store,origins);
+            return 1;
+        }
+    }
     // Display the menu for user interaction
-    menu(&manager,Jerries,ht,mht);
+    menu(&manager,Jerries,ht,mht,orders,moods,store,origins);
      return 0;
 }
\ No newline at end of file
@@ -0,0 +1,278 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "JerryStore.h"
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+#define MIN_CAPACITY 16   // Slots of a new store, the columns double when full
+#define HAPPINESS_RANGE (MAX_HAPPINESS - MIN_HAPPINESS + 1)
+
+// One activity: Jerries at or above the threshold gain addAbove, the others gain addBelow
+typedef struct adjustment_s {
+    int threshold;
+    int addAbove;
+    int addBelow;
+} Adjustment;
+
+// The columns of the store: slot i holds the happiness of jerries[i]
+struct jerryStore_s {
+    int* happiness;     // The happiness column, the only copy of the happiness of every Jerry in the store
+    unsigned char* seen;// Number of pending activities already applied to every slot
+    Jerry** jerries;    // The Jerry of every slot, to move it when its slot moves
+    int size;
+    int capacity;
+    Adjustment pending[MAX_PENDING];    // Deferred activities, oldest first
+    int pendingCount;
+    int composed[HAPPINESS_RANGE];      // All pending activities applied to every happiness level
+};
+
+// Applies one activity to a happiness level
+static int adjust(const Adjustment* adjustment, int happiness) {
+    if (happiness >= adjustment->threshold) {
+        happiness += adjustment->addAbove;
+        return happiness > MAX_HAPPINESS ? MAX_HAPPINESS : happiness;
+    }
+    happiness += adjustment->addBelow;
+    return happiness < MIN_HAPPINESS ? MIN_HAPPINESS : happiness;
+}
+
+// Brings a slot up to date with the pending activities and returns its happiness
+static int catchUp(jerryStore store, int slot) {
+    int happiness = store->happiness[slot];
+    int seen = store->seen[slot];
+    if (seen == store->pendingCount) {
+        return happiness;
+    }
+    if (seen == 0 && happiness >= MIN_HAPPINESS && happiness <= MAX_HAPPINESS) {
+        happiness = store->composed[happiness - MIN_HAPPINESS]; // Every pending activity at once
+    } else {
+        for (int i = seen; i < store->pendingCount; i++) {
+            happiness = adjust(&store->pending[i], happiness);
+        }
+    }
+    store->happiness[slot] = happiness;
+    store->seen[slot] = (unsigned char)store->pendingCount;
+    return happiness;
+}
+
+// Empties the log of pending activities
+static void clearPending(jerryStore store) {
+    store->pendingCount = 0;
+    for (int i = 0; i < HAPPINESS_RANGE; i++) {
+        store->composed[i] = MIN_HAPPINESS + i;
+    }
+}
+
+// Applies the pending activities to every slot and empties the log
+static void applyPending(jerryStore store) {
+    if (store->pendingCount == 0) {
+        return;
+    }
+    for (int i = 0; i < store->size; i++) {
+        catchUp(store, i);
+        store->seen[i] = 0;
+    }
+    clearPending(store);
+}
+
+// Points every Jerry of the store to its slot, after the happiness column moved
+static void pointJerriesToSlots(jerryStore store) {
+    for (int i = 0; i < store->size; i++) {
+        store->jerries[i]->happiness = &store->happiness[i];
+    }
+}
+
+// Returns the slot of a Jerry of the store, or -1 if the Jerry is not in this store
+static int slotOf(jerryStore store, Jerry* jerry) {
+    if (jerry->happiness < store->happiness || jerry->happiness >= store->happiness + store->size) {
+        return -1;
+    }
+    int slot = (int)(jerry->happiness - store->happiness);
+    return store->jerries[slot] == jerry ? slot : -1;
+}
+
+jerryStore createJerryStore(int expected) {
+    jerryStore store = (jerryStore)malloc(sizeof(struct jerryStore_s));
+    if (store == NULL) {
+        return NULL;
+    }
+    store->capacity = expected > MIN_CAPACITY ? expected : MIN_CAPACITY;
+    store->happiness = (int*)malloc(store->capacity * sizeof(int));
+    store->seen = (unsigned char*)malloc(store->capacity * sizeof(unsigned char));
+    store->jerries = (Jerry**)malloc(store->capacity * sizeof(Jerry*));
+    if (store->happiness == NULL || store->seen == NULL || store->jerries == NULL) {
+        free(store->happiness);
+        free(store->seen);
+        free(store->jerries);
+        free(store);
+        return NULL;
+    }
+    store->size = 0;
+    clearPending(store);
+    return store;
+}
+
+status destroyJerryStore(jerryStore store) {
+    if (store == NULL) {
+        return failure;
+    }
+    for (int i = 0; i < store->size; i++) {
+        Jerry* jerry = store->jerries[i];
+        jerry->own_happiness = catchUp(store, i);
+        jerry->happiness = &jerry->own_happiness;
+        jerry->store = NULL;
+    }
+    free(store->happiness);
+    free(store->seen);
+    free(store->jerries);
+    free(store);
+    return success;
+}
+
+status addToJerryStore(jerryStore store, Jerry* jerry) {
+    if (store == NULL || jerry == NULL || jerry->store != NULL) {
+        return failure;
+    }
+    if (store->size == store->capacity) {
+        int* happiness = (int*)realloc(store->happiness, store->capacity * 2 * sizeof(int));
+        if (happiness == NULL) {
+            return Memory_Problem;
+        }
+        store->happiness = happiness;
+        pointJerriesToSlots(store); // Before anything else can fail, the old column is gone
+        unsigned char* seen = (unsigned char*)realloc(store->seen, store->capacity * 2 * sizeof(unsigned char));
+        if (seen == NULL) {
+            return Memory_Problem;
+        }
+        store->seen = seen;
+        Jerry** jerries = (Jerry**)realloc(store->jerries, store->capacity * 2 * sizeof(Jerry*));
+        if (jerries == NULL) {
+            return Memory_Problem;
+        }
+        store->jerries = jerries;
+        store->capacity *= 2;
+    }
+    store->happiness[store->size] = jerry->own_happiness;
+    store->seen[store->size] = (unsigned char)store->pendingCount; // The deferred activities happened before it came
+    store->jerries[store->size] = jerry;
+    jerry->happiness = &store->happiness[store->size];
+    jerry->store = store;
+    store->size++;
+    return success;
+}
+
+status removeFromJerryStore(jerryStore store, Jerry* jerry) {
+    if (store == NULL || jerry == NULL) {
+        return failure;
+    }
+    int slot = jerry->store == store ? slotOf(store, jerry) : -1;
+    if (slot < 0) {
+        return failure;
+    }
+    jerry->own_happiness = catchUp(store, slot);
+    jerry->happiness = &jerry->own_happiness;
+    jerry->store = NULL;
+    // The last Jerry moves into the free slot
+    store->size--;
+    if (slot != store->size) {
+        store->happiness[slot] = store->happiness[store->size];
+        store->seen[slot] = store->seen[store->size];
+        store->jerries[slot] = store->jerries[store->size];
+        store->jerries[slot]->happiness = &store->happiness[slot];
+    }
+    return success;
+}
+
+// The plain C version of the kernel, without branches so the compiler may vectorize it too
+static void adjustRange(int* happiness, int from, int to, int threshold, int addAbove, int addBelow) {
+    for (int i = from; i < to; i++) {
+        int up = happiness[i] + addAbove;
+        int down = happiness[i] + addBelow;
+        up = up > MAX_HAPPINESS ? MAX_HAPPINESS : up;
+        down = down < MIN_HAPPINESS ? MIN_HAPPINESS : down;
+        happiness[i] = happiness[i] >= threshold ? up : down;
+    }
+}
+
+status adjustHappinessInStore(jerryStore store, int threshold, int addAbove, int addBelow) {
+    if (store == NULL) {
+        return failure;
+    }
+    applyPending(store); // The deferred activities came first
+    int* happiness = store->happiness;
+    int i = 0;
+#if defined(__AVX2__)
+    const __m256i threshold8 = _mm256_set1_epi32(threshold);
+    const __m256i above8 = _mm256_set1_epi32(addAbove);
+    const __m256i below8 = _mm256_set1_epi32(addBelow);
+    const __m256i max8 = _mm256_set1_epi32(MAX_HAPPINESS);
+    const __m256i min8 = _mm256_set1_epi32(MIN_HAPPINESS);
+    for (; i + 8 <= store->size; i += 8) {
+        __m256i h = _mm256_loadu_si256((__m256i*)&happiness[i]);
+        __m256i up = _mm256_min_epi32(_mm256_add_epi32(h, above8), max8);
+        __m256i down = _mm256_max_epi32(_mm256_add_epi32(h, below8), min8);
+        __m256i below = _mm256_cmpgt_epi32(threshold8, h); // All ones where h < threshold
+        _mm256_storeu_si256((__m256i*)&happiness[i], _mm256_blendv_epi8(up, down, below));
+    }
+#elif defined(__SSE2__)
+    // SSE2 has no 32-bit min, max or blend, they are built from compares and masks
+    const __m128i threshold4 = _mm_set1_epi32(threshold);
+    const __m128i above4 = _mm_set1_epi32(addAbove);
+    const __m128i below4 = _mm_set1_epi32(addBelow);
+    const __m128i max4 = _mm_set1_epi32(MAX_HAPPINESS);
+    const __m128i min4 = _mm_set1_epi32(MIN_HAPPINESS);
+    for (; i + 4 <= store->size; i += 4) {
+        __m128i h = _mm_loadu_si128((__m128i*)&happiness[i]);
+        __m128i up = _mm_add_epi32(h, above4);
+        __m128i over = _mm_cmpgt_epi32(up, max4);
+        up = _mm_or_si128(_mm_and_si128(over, max4), _mm_andnot_si128(over, up));
+        __m128i down = _mm_add_epi32(h, below4);
+        __m128i under = _mm_cmplt_epi32(down, min4);
+        down = _mm_or_si128(_mm_and_si128(under, min4), _mm_andnot_si128(under, down));
+        __m128i below = _mm_cmplt_epi32(h, threshold4);
+        _mm_storeu_si128((__m128i*)&happiness[i], _mm_or_si128(_mm_and_si128(below, down), _mm_andnot_si128(below, up)));
+    }
+#endif
+    adjustRange(happiness, i, store->size, threshold, addAbove, addBelow); // The tail, or everything without vectors
+    return success;
+}
+
+status deferHappinessAdjustment(jerryStore store, int threshold, int addAbove, int addBelow) {
+    if (store == NULL) {
+        return failure;
+    }
+    if (store->pendingCount == MAX_PENDING) {
+        applyPending(store);
+    }
+    Adjustment* adjustment = &store->pending[store->pendingCount++];
+    adjustment->threshold = threshold;
+    adjustment->addAbove = addAbove;
+    adjustment->addBelow = addBelow;
+    for (int i = 0; i < HAPPINESS_RANGE; i++) {
+        store->composed[i] = adjust(adjustment, store->composed[i]);
+    }
+    return success;
+}
+
+int readHappinessInStore(jerryStore store, Jerry* jerry) {
+    if (store == NULL || jerry == NULL || jerry->store != store) {
+        return -1;
+    }
+    int slot = slotOf(store, jerry);
+    return slot < 0 ? -1 : catchUp(store, slot);
+}
+
+status applyDeferredAdjustments(jerryStore store) {
+    if (store == NULL) {
+        return failure;
+    }
+    applyPending(store);
+    return success;
+}
+
+int getJerryStoreSize(jerryStore store) {
+    if (store == NULL) {
+        return -1;
+    }
+    return store->size;
+}
@@ -0,0 +1,152 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <time.h>
+#include "Jerry.h"
+#include "JerryStore.h"
+#include "LinkedList.h"
+#define ID_SIZE 16
+#define DEFAULT_JERRIES 1000000
+#define DEFAULT_ROUNDS 30
+/**
+ * Measures the daycare activities on the Jerries list against the same activities on a JerryStore,
+ * applied right away and deferred (the time of the deferred ones includes applying them at the end).
+ * Usage: ./JerryStoreBench [numberOfJerries] [numberOfRounds]
+ * Every round runs the three activities once. All sides start from the same happiness levels and
+ * must end with the same ones, or the benchmark fails.
+ */
+
+// The Jerries are owned by the benchmark, the list keeps them as is
+static Element noCopy(Element element) {
+    return element;
+}
+
+static status noFree(Element element) {
+    (void)element;
+    return success;
+}
+
+static bool sameJerry(Element jerry1, Element jerry2) {
+    return jerry1 == jerry2;
+}
+
+// Returns the seconds of processor time since start
+static double elapsed(clock_t start) {
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+// One activity the way the daycare ran it before the store: one Jerry at a time, through the list
+static void activityOnList(linkedlist Jerries, int threshold, int addAbove, int addBelow) {
+    for (listNode node = getFirstNode(Jerries); node != NULL; node = getNextNode(node)) {
+        Jerry* jerry = (Jerry*)getNodeData(node);
+        if (*jerry->happiness >= threshold) {
+            *jerry->happiness += addAbove;
+            if (*jerry->happiness > MAX_HAPPINESS) {
+                *jerry->happiness = MAX_HAPPINESS;
+            }
+        } else {
+            *jerry->happiness += addBelow;
+            if (*jerry->happiness < MIN_HAPPINESS) {
+                *jerry->happiness = MIN_HAPPINESS;
+            }
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int jerryCount = argc > 1 ? atoi(argv[1]) : DEFAULT_JERRIES;
+    int rounds = argc > 2 ? atoi(argv[2]) : DEFAULT_ROUNDS;
+    if (jerryCount < 1 || rounds < 1) {
+        printf("Usage: %s [numberOfJerries] [numberOfRounds]\n", argv[0]);
+        return 1;
+    }
+    // The three daycare activities: fake Beth, golf, TV
+    const int activities[3][3] = {{20, 15, -5}, {50, 10, -10}, {INT_MIN, 20, 20}};
+    PlanetsManager manager = {NULL, 0};
+    Jerry** jerries = (Jerry**)malloc(jerryCount * sizeof(Jerry*));
+    int* start = (int*)malloc(jerryCount * sizeof(int));
+    int* expected = (int*)malloc(jerryCount * sizeof(int));
+    linkedlist Jerries = createLinkedList(noCopy, noFree, noFree, sameJerry);
+    jerryStore store = createJerryStore(jerryCount);
+    int created = 0;
+    if (jerries != NULL && start != NULL && expected != NULL && Jerries != NULL && store != NULL) {
+        unsigned int state = 12345;
+        for (; created < jerryCount; created++) {
+            char id[ID_SIZE];
+            snprintf(id, ID_SIZE, "J%d", created);
+            state = state * 1103515245u + 12345u;
+            start[created] = (int)(state >> 16) % (MAX_HAPPINESS + 1);
+            jerries[created] = create_jerry(id, start[created], "C-137", &manager, "Earth", 0, 0, 0);
+            if (jerries[created] == NULL) {
+                break;
+            }
+            if (appendNode(Jerries, jerries[created]) != success) {
+                destroy_jerry(jerries[created]);
+                break;
+            }
+        }
+    }
+    int failed = 1;
+    if (created < jerryCount || memory_failure_sign == 1) {
+        printf("Memory Problem\n");
+    } else {
+        printf("%d Jerries, %d rounds of the three activities\n", jerryCount, rounds);
+        clock_t begin = clock();
+        for (int r = 0; r < rounds; r++) {
+            for (int a = 0; a < 3; a++) {
+                activityOnList(Jerries, activities[a][0], activities[a][1], activities[a][2]);
+            }
+        }
+        double listTime = elapsed(begin);
+        printf("%-18s %8.2f ns/Jerry/activity\n", "Jerries list", listTime * 1e9 / ((double)jerryCount * rounds * 3));
+        for (int i = 0; i < jerryCount; i++) {
+            expected[i] = *jerries[i]->happiness;
+            *jerries[i]->happiness = start[i];
+            addToJerryStore(store, jerries[i]);
+        }
+        begin = clock();
+        for (int r = 0; r < rounds; r++) {
+            for (int a = 0; a < 3; a++) {
+                adjustHappinessInStore(store, activities[a][0], activities[a][1], activities[a][2]);
+            }
+        }
+        double storeTime = elapsed(begin);
+        printf("%-18s %8.2f ns/Jerry/activity\n", "JerryStore", storeTime * 1e9 / ((double)jerryCount * rounds * 3));
+        failed = 0;
+        for (int i = 0; i < jerryCount && !failed; i++) {
+            if (*jerries[i]->happiness != expected[i]) {
+                printf("Jerry %d ends with %d instead of %d\n", i, *jerries[i]->happiness, expected[i]);
+                failed = 1;
+            }
+            *jerries[i]->happiness = start[i];
+        }
+        begin = clock();
+        for (int r = 0; r < rounds; r++) {
+            for (int a = 0; a < 3; a++) {
+                deferHappinessAdjustment(store, activities[a][0], activities[a][1], activities[a][2]);
+            }
+        }
+        applyDeferredAdjustments(store);
+        double deferredTime = elapsed(begin);
+        printf("%-18s %8.2f ns/Jerry/activity\n", "JerryStore, deferred", deferredTime * 1e9 / ((double)jerryCount * rounds * 3));
+        for (int i = 0; i < jerryCount && !failed; i++) {
+            if (*jerries[i]->happiness != expected[i]) {
+                printf("Jerry %d ends with %d instead of %d when deferred\n", i, *jerries[i]->happiness, expected[i]);
+                failed = 1;
+            }
+        }
+        if (!failed) {
+            printf("Same happiness on all sides\n");
+        }
+    }
+    destroyJerryStore(store);
+    destroyLinkedList(Jerries);
+    for (int i = 0; i < created; i++) {
+        destroy_jerry(jerries[i]);
+    }
+    destroy_all_planets(&manager);
+    free(jerries);
+    free(start);
+    free(expected);
+    return failed;
+}
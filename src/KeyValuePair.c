@@ -1,9 +1,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "KeyValuePair.h"
-struct key_value_pair_s {
-    Element key;
-    Element value;
+// Callbacks shared by all the pairs of one owner (usually a hash table)
+struct pair_ops_s {
     CopyFunction copyKey;
     FreeFunction freeKey;
     PrintFunction printKey;
@@ -11,45 +10,100 @@ struct key_value_pair_s {
     CopyFunction copyValue;
     FreeFunction freeValue;
     PrintFunction printValue;
+    memoryPool pool;    // Pool the pairs come from, NULL if they are malloced
+    bool ownedByPair;   // Created by createKeyValuePair for a single pair and destroyed with it
+};
+
+struct key_value_pair_s {
+    Element key;
+    Element value;
+    unsigned long long hash; // Hash of the key, cached by the owner of the pair
+    pairOps ops;             // Shared callbacks, not owned by the pair
 };
 
+pairOps createPairOps(CopyFunction copyKey, FreeFunction freeKey, PrintFunction printKey,
+                      EqualFunction equalKey, CopyFunction copyValue, FreeFunction freeValue,
+                      PrintFunction printValue, memoryPool pool) {
+    if (copyKey == NULL || freeKey == NULL || printKey == NULL || copyValue == NULL || freeValue == NULL ||
+        printValue == NULL) {
+        return NULL;
+    }
+    pairOps ops = (pairOps)malloc(sizeof(struct pair_ops_s));
+    if (ops == NULL) {
+        return NULL;
+    }
+    ops->copyKey = copyKey;
+    ops->freeKey = freeKey;
+    ops->printKey = printKey;
+    ops->equalKey = equalKey;
+    ops->copyValue = copyValue;
+    ops->freeValue = freeValue;
+    ops->printValue = printValue;
+    ops->pool = pool;
+    ops->ownedByPair = false;
+    return ops;
+}
+
+status destroyPairOps(pairOps ops) {
+    if (ops == NULL) {
+        return failure;
+    }
+    free(ops);
+    return success;
+}
+
+// Frees the memory of the pair structure, back to its pool if it came from one
+static void releasePairMemory(KeyValuePair pair) {
+    if (pair->ops->pool != NULL) {
+        returnToPool(pair->ops->pool, pair);
+    } else {
+        free(pair);
+    }
+}
+
 KeyValuePair createKeyValuePair(CopyFunction copyKey, FreeFunction freeKey, PrintFunction printKey,
                                EqualFunction equalKey, CopyFunction copyValue, FreeFunction freeValue,
                                PrintFunction printValue, Element key, Element value) {
+    // A standalone pair gets its own callbacks, released together with it
+    pairOps ops = createPairOps(copyKey, freeKey, printKey, equalKey, copyValue, freeValue, printValue, NULL);
+    if (ops == NULL) {
+        return NULL;
+    }
+    ops->ownedByPair = true;
+    KeyValuePair pair = createKeyValuePairWithOps(ops, key, value);
+    if (pair == NULL) {
+        destroyPairOps(ops);
+    }
+    return pair;
+}
 
-    if (copyKey == NULL || freeKey == NULL || printKey == NULL || copyValue == NULL || freeValue == NULL ||
-        printValue == NULL || key == NULL || value == NULL) {
+KeyValuePair createKeyValuePairWithOps(pairOps ops, Element key, Element value) {
+    if (ops == NULL || key == NULL || value == NULL) {
         return NULL;
-        }
+    }
 
     // Allocate memory for the key-value pair
-    KeyValuePair pair = (KeyValuePair)malloc(sizeof(struct key_value_pair_s));
+    KeyValuePair pair = ops->pool != NULL ? (KeyValuePair)allocateFromPool(ops->pool) : (KeyValuePair)malloc(sizeof(struct key_value_pair_s));
     if (pair == NULL) {
         return NULL;
     }
+    pair->ops = ops;
     // Copy the key
-    pair->key = copyKey(key);
+    pair->key = ops->copyKey(key);
     if (pair->key == NULL) {
-        free(pair); // Free the pair if copying the key fails
+        releasePairMemory(pair); // Free the pair if copying the key fails
         return NULL;
     }
     // Copy the value
-    pair->value = copyValue(value);
+    pair->value = ops->copyValue(value);
     if (pair->value == NULL) {
 
-        freeKey(pair->key); // Free the copied key
-        free(pair); // Free the pair
+        ops->freeKey(pair->key); // Free the copied key
+        releasePairMemory(pair); // Free the pair
         return NULL;
     }
 
-    pair->copyKey = copyKey;
-    pair->freeKey = freeKey;
-    pair->printKey = printKey;
-    pair->equalKey = equalKey;
-    pair->copyValue = copyValue;
-    pair->freeValue = freeValue;
-    pair->printValue = printValue;
-
+    pair->hash = 0;
     return pair;
 }
 
@@ -58,16 +112,20 @@ status destroyKeyValuePair(KeyValuePair pair) {
     if (pair == NULL) {
         return failure;
     }
+    pairOps ops = pair->ops;
     // Free the key if it exists
-    if (pair->key != NULL&&  pair->freeKey!=NULL ) {
-        pair->freeKey(pair->key);
+    if (pair->key != NULL&&  ops->freeKey!=NULL ) {
+        ops->freeKey(pair->key);
     }
     // Free the value if it exists
-    if (pair->value != NULL&&  pair->freeValue != NULL ) {
-        pair->freeValue(pair->value);
+    if (pair->value != NULL&&  ops->freeValue != NULL ) {
+        ops->freeValue(pair->value);
     }
     // Free the pair structure itself
-    free(pair);
+    releasePairMemory(pair);
+    if (ops->ownedByPair) {
+        destroyPairOps(ops); // The callbacks of a standalone pair go with it
+    }
     return success;
 }
 
@@ -75,7 +133,7 @@ status displayValue(KeyValuePair pair) {
     if (pair == NULL|| pair->value == NULL) {
         return failure;
     }
-    pair->printValue(pair->value); // Use the print function to display the value
+    pair->ops->printValue(pair->value); // Use the print function to display the value
     return success;
 }
 
@@ -83,7 +141,7 @@ status displayKey(KeyValuePair pair) {
     if (pair == NULL|| pair->key == NULL) {
         return failure;
     }
-    pair->printKey(pair->key); // Use the print function to display the key
+    pair->ops->printKey(pair->key); // Use the print function to display the key
     return success;
 }
 
@@ -98,14 +156,14 @@ Element getKey(KeyValuePair pair) {
     if (pair == NULL|| pair->key == NULL) {
         return NULL;
     }
-    return pair->copyKey(pair); // Return the key
+    return pair->key; // Return the key
 }
 
 bool isEqualKey(KeyValuePair pair,Element key) {
-    if(pair == NULL || key == NULL || pair->key == NULL||pair->equalKey == NULL) {
+    if(pair == NULL || key == NULL || pair->key == NULL||pair->ops->equalKey == NULL) {
         return false;
     }
-    return pair->equalKey(pair->key, key); // Use the comparison function
+    return pair->ops->equalKey(pair->key, key); // Use the comparison function
 
 }
 
@@ -120,7 +178,26 @@ status displayKeyValuePair(Element pair_element) {
     if (pair->key == NULL || pair->value == NULL) {
         return failure;
     }
-    pair->printKey(pair->key);  // Display the key
-    pair->printValue(pair->value); // Display the value
+    pair->ops->printKey(pair->key);  // Display the key
+    pair->ops->printValue(pair->value); // Display the value
+    return success;
+}
+
+status setPairHash(KeyValuePair pair, unsigned long long hash) {
+    if (pair == NULL) {
+        return failure;
+    }
+    pair->hash = hash;
     return success;
+}
+
+unsigned long long getPairHash(KeyValuePair pair) {
+    if (pair == NULL) {
+        return 0;
+    }
+    return pair->hash;
+}
+
+memoryPool createPairPool(int pairsPerSlab) {
+    return createMemoryPool(sizeof(struct key_value_pair_s), pairsPerSlab);
 }
\ No newline at end of file
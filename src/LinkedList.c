@@ -2,9 +2,12 @@
 #include <stdlib.h>
 #include "LinkedList.h"
 #include "KeyValuePair.h"
+#include "MemoryPool.h"
+#define NODES_PER_SLAB 64 // Nodes malloced at once by a pool the list creates for itself
 typedef struct node_t {
     Element content ;
     struct node_t* next;
+    struct node_t* prev; // Lets a node be unlinked in O(1) through its handle
 } Node;
 
 struct linkedlist_s {
@@ -15,34 +18,47 @@ struct linkedlist_s {
     FreeFunction freeElement;
     PrintFunction printElement;
     EqualFunction equalFunc;
+    memoryPool pool;    // Pool of the nodes, NULL if every node is malloced on its own
+    bool ownsPool;      // The pool was created by the list and is released with it
 };
 
 
-Node* create_node(Element content, CopyFunction copyElement) {
+Node* create_node(Element content, CopyFunction copyElement, memoryPool pool) {
     if (content == NULL || copyElement == NULL) {
         return NULL;
     }
-    Node* new_node = (Node*)malloc(sizeof(Node));
+    Node* new_node = pool != NULL ? (Node*)allocateFromPool(pool) : (Node*)malloc(sizeof(Node));
     if (new_node == NULL) {
         return NULL; // Memory allocation failed
     }
     new_node->content = copyElement(content);
     if (new_node->content == NULL) {
-        free(new_node); // Free node if content copy fails
+        // Free node if content copy fails
+        if (pool != NULL) {
+            returnToPool(pool, new_node);
+        } else {
+            free(new_node);
+        }
         return NULL;
     }
     new_node->next = NULL; // Initialize next to NULL
+    new_node->prev = NULL;
     return new_node;
 }
 
-void free_node(Node* node,FreeFunction freeElement) {
+void free_node(Node* node,FreeFunction freeElement, memoryPool pool) {
     if (node == NULL) {
         return;
     }
     if (node->content != NULL && freeElement != NULL) {
         freeElement(node->content); // Free the node's content using the provided function
     }
-    free(node); // Free the node itself
+    // Free the node itself
+    if (pool != NULL) {
+        returnToPool(pool, node);
+    } else {
+        free(node);
+    }
 }
 
 linkedlist createLinkedList(CopyFunction copyElement, FreeFunction freeElement, PrintFunction printElement,EqualFunction equalFunc) {
@@ -61,8 +77,32 @@ linkedlist createLinkedList(CopyFunction copyElement, FreeFunction freeElement,
     new_list->freeElement = freeElement;
     new_list->printElement = printElement;
     new_list->equalFunc = equalFunc;
+    new_list->pool = NULL;
+    new_list->ownsPool = false;
+    return new_list;
+
+}
+
+linkedlist createLinkedListWithPool(CopyFunction copyElement, FreeFunction freeElement, PrintFunction printElement,EqualFunction equalFunc, memoryPool pool) {
+    linkedlist new_list = createLinkedList(copyElement, freeElement, printElement, equalFunc);
+    if (new_list == NULL) {
+        return NULL;
+    }
+    if (pool == NULL) {
+        // No shared pool was given, the list gets its own
+        pool = createNodePool(NODES_PER_SLAB);
+        if (pool == NULL) {
+            free(new_list);
+            return NULL;
+        }
+        new_list->ownsPool = true;
+    }
+    new_list->pool = pool;
     return new_list;
+}
 
+memoryPool createNodePool(int nodesPerSlab) {
+    return createMemoryPool(sizeof(Node), nodesPerSlab);
 }
 
 status destroyLinkedList(linkedlist list) {
@@ -71,38 +111,84 @@ status destroyLinkedList(linkedlist list) {
     }
     Node* curr = list->head;
     Node* next_node = NULL;
+    // An own pool is released in bulk below, so its nodes only need their elements freed
+    memoryPool nodePool = list->ownsPool ? NULL : list->pool;
     while (curr != NULL) {
         next_node = curr->next; // Save the next node
-        free_node(curr,list->freeElement); // Free the current node
+        if (list->ownsPool) {
+            list->freeElement(curr->content);
+        } else {
+            free_node(curr,list->freeElement,nodePool); // Free the current node
+        }
         curr = next_node; // Move to the next node
     }
+    if (list->ownsPool) {
+        destroyMemoryPool(list->pool); // Release all the slabs at once
+    }
     free(list); // Free the linked list structure itself
     return success;
 }
 
+// Links a node as the new tail of the list
+static void link_tail(linkedlist list, Node* node) {
+    node->next = NULL;
+    node->prev = list->tail;
+    if (list->tail == NULL) {
+        // If the list is empty, set head and tail to the new node
+        list->head = node;
+    }
+    // Otherwise, append to the end of the list
+    else {
+        list->tail->next = node;
+    }
+    list->tail = node;
+    // Increment the list length
+    list->length++;
+}
+
+// Unlinks a node from the list without freeing it
+static void unlink_node(linkedlist list, Node* node) {
+    if (node->prev == NULL) {
+        list->head = node->next; // Node is the head
+    } else {
+        node->prev->next = node->next;
+    }
+    if (node->next == NULL) {
+        list->tail = node->prev; // Node is the tail
+    } else {
+        node->next->prev = node->prev;
+    }
+    node->next = NULL;
+    node->prev = NULL;
+    list->length--; // Decrement the list length
+}
+
 status appendNode(linkedlist list, Element element) {
+    return appendNodeWithHandle(list, element, NULL);
+}
+
+status appendNodeWithHandle(linkedlist list, Element element, listNode* handle) {
     if (list == NULL || element == NULL) {
         return failure;
     }
-    Node* new_node = create_node(element, list->copyElement);
+    Node* new_node = create_node(element, list->copyElement, list->pool);
     if (new_node == NULL) {
         return  Memory_Problem; // Memory allocation failed
     }
-    if (list->tail == NULL) {
-        // If the list is empty, set head and tail to the new node
-        list->head = new_node;
-        list->tail = new_node;
-
+    link_tail(list, new_node);
+    if (handle != NULL) {
+        *handle = new_node; // The node stays valid until it is removed
     }
-    // Otherwise, append to the end of the list
-    else {
-        list->tail->next = new_node;
-        list->tail = new_node;
+   return success;
+}
 
+status removeByHandle(linkedlist list, listNode handle) {
+    if (list == NULL || handle == NULL || list->length == 0) {
+        return failure;
     }
-    // Increment the list length
-    list->length++;
-   return success;
+    unlink_node(list, handle);
+    free_node(handle, list->freeElement, list->pool); // Free the node and its element
+    return success;
 }
 
 status deleteNode(linkedlist list, Element element) {
@@ -110,29 +196,14 @@ status deleteNode(linkedlist list, Element element) {
         return failure;
     }
     Node* curr = list->head;
-    Node* prev = NULL;
     while (curr != NULL) {
         // Found the node to delete
         if (list->equalFunc(curr->content, element)) {
-            if (prev == NULL) {
-                // Node to delete is the head
-                list->head = curr->next;
-                if (list->head == NULL) {
-                    list->tail = NULL;
-                }
-            } else {
-                // Node to delete is in the middle or end
-                prev->next = curr->next;
-                if (list->tail == curr) {
-                    list->tail = prev;
-                }
-            }
-            free_node(curr,list->freeElement); // Free the node
-            list->length--; // Decrement the list length
+            unlink_node(list, curr);
+            free_node(curr,list->freeElement,list->pool); // Free the node
             return success;
         }
-        prev = curr; // Move to the next node
-        curr = curr->next;
+        curr = curr->next; // Move to the next node
     }
     return Not_Exist; // Element not found
 
@@ -193,4 +264,36 @@ Element getTailContent(linkedlist list) {
         return NULL; // Invalid input or empty list
     }
     return list->copyElement(list->tail->content);  // Return the content of the last node
-}
\ No newline at end of file
+}
+
+status transferHead(linkedlist from, linkedlist to) {
+    if (from == NULL || to == NULL || from->head == NULL) {
+        return failure;
+    }
+    // Unlink the head of the source list and link it as the tail of the destination list
+    Node* node = from->head;
+    unlink_node(from, node);
+    link_tail(to, node);
+    return success;
+}
+
+listNode getFirstNode(linkedlist list) {
+    if (list == NULL) {
+        return NULL;
+    }
+    return list->head;
+}
+
+listNode getNextNode(listNode node) {
+    if (node == NULL) {
+        return NULL;
+    }
+    return node->next;
+}
+
+Element getNodeData(listNode node) {
+    if (node == NULL) {
+        return NULL;
+    }
+    return node->content; // Borrowed, the list still owns the element
+}
@@ -0,0 +1,125 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "MemoryPool.h"
+#define POOL_ALIGNMENT 16 // Every object is aligned for any basic type
+
+// Header of a slab, the objects follow it
+typedef struct slab_s {
+    struct slab_s* next;
+    union {
+        long double align_ld;
+        void* align_ptr;
+        long long align_ll;
+    } align; // Keeps the first object aligned
+} Slab;
+
+// A returned object, linked through its own memory
+typedef struct free_object_s {
+    struct free_object_s* next;
+} FreeObject;
+
+struct memoryPool_s {
+    int objectSize;         // Object size, rounded up to the alignment
+    int objectsPerSlab;
+    Slab* slabs;            // All the slabs, newest first
+    int usedInSlab;         // Objects already handed out from the newest slab
+    FreeObject* freeList;   // Returned objects, ready for reuse
+    long allocations;       // Objects handed out since the pool was created
+    long slabCount;         // Slabs malloced since the pool was created
+};
+
+memoryPool createMemoryPool(int objectSize, int objectsPerSlab) {
+    if (objectSize < 1 || objectsPerSlab < 1) {
+        return NULL;
+    }
+    memoryPool pool = (memoryPool)malloc(sizeof(struct memoryPool_s));
+    if (pool == NULL) {
+        return NULL;
+    }
+    if (objectSize < (int)sizeof(FreeObject)) {
+        objectSize = sizeof(FreeObject); // A returned object must hold the free list link
+    }
+    pool->objectSize = (objectSize + POOL_ALIGNMENT - 1) / POOL_ALIGNMENT * POOL_ALIGNMENT;
+    pool->objectsPerSlab = objectsPerSlab;
+    pool->slabs = NULL;
+    pool->usedInSlab = objectsPerSlab; // No slab yet, the first allocation mallocs one
+    pool->freeList = NULL;
+    pool->allocations = 0;
+    pool->slabCount = 0;
+    return pool;
+}
+
+status destroyMemoryPool(memoryPool pool) {
+    if (pool == NULL) {
+        return failure;
+    }
+    // Release the slabs, not the objects one by one
+    Slab* curr = pool->slabs;
+    while (curr != NULL) {
+        Slab* next = curr->next;
+        free(curr);
+        curr = next;
+    }
+    free(pool);
+    return success;
+}
+
+Element allocateFromPool(memoryPool pool) {
+    if (pool == NULL) {
+        return NULL;
+    }
+    // Reuse a returned object first
+    if (pool->freeList != NULL) {
+        FreeObject* object = pool->freeList;
+        pool->freeList = object->next;
+        pool->allocations++;
+        return object;
+    }
+    // Start a new slab when the newest one is used up
+    if (pool->usedInSlab == pool->objectsPerSlab) {
+        Slab* slab = (Slab*)malloc(sizeof(Slab) + (size_t)pool->objectSize * pool->objectsPerSlab);
+        if (slab == NULL) {
+            return NULL;
+        }
+        slab->next = pool->slabs;
+        pool->slabs = slab;
+        pool->usedInSlab = 0;
+        pool->slabCount++;
+    }
+    char* objects = (char*)(pool->slabs + 1);
+    Element object = objects + (size_t)pool->usedInSlab * pool->objectSize;
+    pool->usedInSlab++;
+    pool->allocations++;
+    return object;
+}
+
+status returnToPool(memoryPool pool, Element object) {
+    if (pool == NULL || object == NULL) {
+        return failure;
+    }
+    FreeObject* freeObject = (FreeObject*)object;
+    freeObject->next = pool->freeList;
+    pool->freeList = freeObject;
+    return success;
+}
+
+long getPoolAllocations(memoryPool pool) {
+    if (pool == NULL) {
+        return -1;
+    }
+    return pool->allocations;
+}
+
+long getPoolSlabs(memoryPool pool) {
+    if (pool == NULL) {
+        return -1;
+    }
+    return pool->slabCount;
+}
+
+long getPoolSavedMallocs(memoryPool pool) {
+    if (pool == NULL) {
+        return -1;
+    }
+    return pool->allocations - pool->slabCount;
+}
@@ -2,8 +2,10 @@
 #include "HashTable.h"
 #include "LinkedList.h"
 #include <stdlib.h>
+#define VALUES_PER_SLAB 64 // Value list nodes malloced at once
 struct MultiValueHashTable_s {
     hashTable ht;
+    memoryPool nodePool; // Nodes of all the value lists
     EqualFunction equalValue;
     CopyFunction copyValue;
     CopyFunction copyKey;
@@ -19,6 +21,12 @@ MultiValueHashTable createMultiValueHashTable(CopyFunction copyKey, FreeFunction
     if (mht == NULL) {
         return NULL;
     }
+    // All the value lists take their nodes from one shared pool
+    mht->nodePool = createNodePool(VALUES_PER_SLAB);
+    if (mht->nodePool == NULL) {
+        free(mht);
+        return NULL;
+    }
     // Create the base hash table
     mht->ht = createHashTable( (CopyFunction)copyKey,
     (FreeFunction)freeKey,
@@ -31,6 +39,7 @@ MultiValueHashTable createMultiValueHashTable(CopyFunction copyKey, FreeFunction
     hashNumber
 );;
     if (mht->ht == NULL) {
+        destroyMemoryPool(mht->nodePool);
         free(mht);
         return NULL;
     }
@@ -55,12 +64,18 @@ status destroyMultiValueHashTable(MultiValueHashTable mht) {
     if (d_status == failure) {
         return failure;
     }
+    destroyMemoryPool(mht->nodePool); // Release the slabs of all the value nodes at once
     // Free the MultiValueHashTable structure
     free(mht);
     return success;
 }
 // Adds a key-value pair to the MultiValueHashTable
 status addToMultiValueHashTable(MultiValueHashTable mht,Element key, Element value) {
+    return addToMultiValueHashTableWithHandle(mht, key, value, NULL);
+}
+
+// Adds a key-value pair to the MultiValueHashTable and returns the node of the value
+status addToMultiValueHashTableWithHandle(MultiValueHashTable mht,Element key, Element value, listNode* handle) {
     if (mht == NULL|| key == NULL || value == NULL) {
         return failure;
     }
@@ -68,12 +83,12 @@ status addToMultiValueHashTable(MultiValueHashTable mht,Element key, Element val
     Element value_list = lookupInHashTable(mht->ht,key);
     if (value_list == NULL) {
         // If no list exists, create a new linked list
-        linkedlist new_list = createLinkedList(mht->copyValue,mht->freeValue,mht->printValue,mht->equalValue);
+        linkedlist new_list = createLinkedListWithPool(mht->copyValue,mht->freeValue,mht->printValue,mht->equalValue,mht->nodePool);
         if (new_list == NULL) {
             return Memory_Problem;
         }
         // Add the value to the new list
-        if (appendNode(new_list,value) == failure) {
+        if (appendNodeWithHandle(new_list,value,handle) != success) {
             destroyLinkedList(new_list);
             return failure;
         }
@@ -84,7 +99,7 @@ status addToMultiValueHashTable(MultiValueHashTable mht,Element key, Element val
         }
         return success;
     }
-    if (appendNode(value_list,value) == failure) {
+    if (appendNodeWithHandle(value_list,value,handle) != success) {
         return failure;
     }
     return success;
@@ -118,6 +133,23 @@ status removeFromMultiValueHashTable(MultiValueHashTable mht,Element key, Elemen
     return success;
 }
 
+// Removes the value of a node in the MultiValueHashTable in O(1)
+status removeHandleFromMultiValueHashTable(MultiValueHashTable mht, Element key, listNode handle) {
+    if (mht == NULL || key == NULL || handle == NULL) {
+        return failure;
+    }
+    // Lookup the list of values associated with the key
+    linkedlist value_list = lookupInHashTable(mht->ht,key);
+    if (value_list == NULL) {
+        return Not_Exist;
+    }
+    removeByHandle(value_list,handle); // Unlink the node directly, also free the memory
+    if (getLength(value_list)== 0) {
+        removeFromHashTable(mht->ht,key); // Remove the key if the list is empty
+    }
+    return success;
+}
+
 // Displays the values associated with a key in the MultiValueHashTable
 status displayMultiValueHashElementsByKey(MultiValueHashTable mht, Element key) {
     if (mht == NULL || key == NULL || mht->ht == NULL) {
@@ -131,4 +163,18 @@ status displayMultiValueHashElementsByKey(MultiValueHashTable mht, Element key)
     mht->printKey(key); // Print the key
     displayList(list); // Display all values in the list
     return success;
+}
+
+status setMultiValueHashFunction(MultiValueHashTable mht, HashFunction hashFunction) {
+    if (mht == NULL) {
+        return failure;
+    }
+    return setHashFunction(mht->ht, hashFunction);
+}
+
+long getMultiValueSavedMallocs(MultiValueHashTable mht) {
+    if (mht == NULL) {
+        return -1;
+    }
+    return getHashTableSavedMallocs(mht->ht) + getPoolSavedMallocs(mht->nodePool);
 }
\ No newline at end of file
@@ -0,0 +1,548 @@
+//
+// The log of the changes of the daycare.
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "ConfigParser.h"
+#include "OperationLog.h"
+#define LOG_BYTE_ORDER 0x01020304  // Reads back differently on a machine of another byte order
+#define LOG_BUFFER_SIZE 65536      // Bytes of a new buffer of records, it doubles when full
+#define RECORD_PREFIX_SIZE 8       // The size and the checksum before every record
+#define CHECKSUM_SEED 0xcbf29ce484222325ULL
+#define CHECKSUM_PRIME 0x100000001b3ULL
+
+typedef struct LogHeader_struct {
+    char magic[8];
+    int32_t version;
+    int32_t byte_order;
+    uint64_t base;             // 0 for the configuration file, or the checksum of a snapshot
+} LogHeader;
+
+typedef enum e_record_type {
+    Admit_Record = 1,
+    Add_Record,
+    Remove_Record,
+    Check_Out_Record,
+    Activity_Record
+} recordType;
+
+struct operationLog_s {
+    int file;
+    logDurability durability;
+    unsigned long long base;   // The state the records apply to, changed by resetOperationLog
+    pthread_t thread;          // The log thread, that writes and syncs the records
+    pthread_mutex_t lock;      // Guards everything below
+    pthread_cond_t logged;     // Signaled when records are logged, or when the log closes
+    pthread_cond_t written;    // Signaled when a batch of records is written (and synced)
+    char* pending;             // The records logged and not yet taken by the log thread
+    long pending_size;
+    long pending_capacity;
+    char* batch;               // The records the log thread writes, swapped with pending
+    long batch_capacity;
+    unsigned long long logged_bytes;  // Bytes logged since the log was opened
+    unsigned long long written_bytes; // Of which written (and synced, unless Log_Unsynced)
+    bool closing;
+    bool failed;               // A write or a sync failed, nothing is logged anymore
+};
+
+// The checksum of a record, to find one that was cut by a crash
+static uint32_t checksum_record(const unsigned char* data, long size) {
+    uint64_t checksum = CHECKSUM_SEED;
+    for (long i = 0; i < size; i++) {
+        checksum = (checksum ^ data[i]) * CHECKSUM_PRIME;
+    }
+    return (uint32_t)(checksum ^ (checksum >> 32));
+}
+
+// --- Records ---
+
+// Builds a record in place, after room for its size and checksum
+typedef struct RecordBuilder_struct {
+    unsigned char data[RECORD_PREFIX_SIZE + LOG_MAX_RECORD];
+    int size;                  // Bytes of the record, without the prefix
+    bool overflow;
+} RecordBuilder;
+
+static void put_field(RecordBuilder* record, const void* field, int size) {
+    if (record->overflow || record->size + size > LOG_MAX_RECORD) {
+        record->overflow = true;
+        return;
+    }
+    memcpy(record->data + RECORD_PREFIX_SIZE + record->size, field, (size_t)size);
+    record->size += size;
+}
+
+static void start_record(RecordBuilder* record, recordType type) {
+    unsigned char byte = (unsigned char)type;
+    record->size = 0;
+    record->overflow = false;
+    put_field(record, &byte, 1);
+}
+
+static void put_string(RecordBuilder* record, char* string) {
+    size_t length = string == NULL ? LOG_MAX_RECORD : strlen(string);
+    if (length >= LOG_MAX_RECORD) {
+        record->overflow = true;
+        return;
+    }
+    uint16_t stored = (uint16_t)length;
+    put_field(record, &stored, sizeof(stored));
+    put_field(record, string, (int)length);
+}
+
+static void put_int32(RecordBuilder* record, int32_t value) {
+    put_field(record, &value, sizeof(value));
+}
+
+// Reads the fields of a record, the strings copied with a NUL to a buffer of the reader
+typedef struct RecordReader_struct {
+    const unsigned char* data;
+    int size;
+    int position;
+    char strings[LOG_MAX_RECORD + 8];
+    int strings_used;
+    bool failed;
+} RecordReader;
+
+static void get_field(RecordReader* reader, void* field, int size) {
+    if (reader->failed || reader->position + size > reader->size) {
+        reader->failed = true;
+        return;
+    }
+    memcpy(field, reader->data + reader->position, (size_t)size);
+    reader->position += size;
+}
+
+static char* get_string(RecordReader* reader) {
+    uint16_t length = 0;
+    get_field(reader, &length, sizeof(length));
+    if (reader->failed || reader->position + length > reader->size) {
+        reader->failed = true;
+        return NULL;
+    }
+    char* string = reader->strings + reader->strings_used;
+    memcpy(string, reader->data + reader->position, length);
+    string[length] = '\0';
+    reader->position += length;
+    reader->strings_used += length + 1;
+    return string;
+}
+
+static int32_t get_int32(RecordReader* reader) {
+    int32_t value = 0;
+    get_field(reader, &value, sizeof(value));
+    return value;
+}
+
+// Calls the handler of one record, Invlid_Input if the record does not hold its fields
+static status replay_record(const unsigned char* data, int size, LogHandlers* handlers, Element context) {
+    RecordReader* reader = (RecordReader*)malloc(sizeof(RecordReader));
+    if (reader == NULL) {
+        return Memory_Problem;
+    }
+    reader->data = data;
+    reader->size = size;
+    reader->position = 0;
+    reader->strings_used = 0;
+    reader->failed = false;
+    unsigned char type = 0;
+    get_field(reader, &type, 1);
+    status s = Invlid_Input;
+    switch (type) {
+        case Admit_Record: {
+            char* id = get_string(reader);
+            char* planet = get_string(reader);
+            char* dimension = get_string(reader);
+            int32_t happiness = get_int32(reader);
+            if (!reader->failed && reader->position == size) {
+                s = handlers->admit(context, id, planet, dimension, happiness);
+            }
+            break;
+        }
+        case Add_Record: {
+            char* id = get_string(reader);
+            char* name = get_string(reader);
+            double value = 0;
+            get_field(reader, &value, sizeof(value));
+            if (!reader->failed && reader->position == size) {
+                s = handlers->add_characteristic(context, id, name, value);
+            }
+            break;
+        }
+        case Remove_Record: {
+            char* id = get_string(reader);
+            char* name = get_string(reader);
+            if (!reader->failed && reader->position == size) {
+                s = handlers->remove_characteristic(context, id, name);
+            }
+            break;
+        }
+        case Check_Out_Record: {
+            char* id = get_string(reader);
+            if (!reader->failed && reader->position == size) {
+                s = handlers->check_out(context, id);
+            }
+            break;
+        }
+        case Activity_Record: {
+            int32_t activity = get_int32(reader);
+            if (!reader->failed && reader->position == size) {
+                s = handlers->activity(context, activity);
+            }
+            break;
+        }
+    }
+    free(reader);
+    return s;
+}
+
+// Replays the records of a mapped log, end receives the offset after the last whole record
+// (0 for a log of the applied base, which is not replayed)
+static status replay_log(const char* data, long size, unsigned long long base, unsigned long long* applied,
+                         LogHandlers* handlers, Element context, long* end) {
+    LogHeader header;
+    if (data == NULL || size < (long)sizeof(LogHeader)) {
+        return Invlid_Input;
+    }
+    memcpy(&header, data, sizeof(header));
+    if (memcmp(header.magic, LOG_MAGIC, sizeof(header.magic)) != 0 || header.version != LOG_VERSION
+        || header.byte_order != LOG_BYTE_ORDER) {
+        return Invlid_Input;
+    }
+    if (header.base != base) {
+        if (applied == NULL || header.base != *applied) {
+            return Invlid_Input;
+        }
+        *end = 0; // Its records are already in the daycare, it starts over from base
+        return success;
+    }
+    long offset = sizeof(LogHeader);
+    while (size - offset >= RECORD_PREFIX_SIZE) {
+        uint32_t record_size;
+        uint32_t checksum;
+        memcpy(&record_size, data + offset, sizeof(record_size));
+        memcpy(&checksum, data + offset + sizeof(record_size), sizeof(checksum));
+        const unsigned char* record = (const unsigned char*)data + offset + RECORD_PREFIX_SIZE;
+        if (record_size == 0 || record_size > LOG_MAX_RECORD || record_size > size - offset - RECORD_PREFIX_SIZE
+            || checksum_record(record, record_size) != checksum) {
+            break; // Cut by a crash, this record and what follows were never confirmed
+        }
+        status s = replay_record(record, (int)record_size, handlers, context);
+        if (s != success) {
+            return s;
+        }
+        offset += RECORD_PREFIX_SIZE + record_size;
+    }
+    *end = offset;
+    return success;
+}
+
+// --- The log thread ---
+
+// Writes a whole buffer, past interrupted and partial writes
+static bool write_all(int file, const char* data, long size) {
+    while (size > 0) {
+        ssize_t written = write(file, data, (size_t)size);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return false;
+        }
+        data += written;
+        size -= written;
+    }
+    return true;
+}
+
+// Takes the records logged so far, writes and syncs them together, and starts over until the log closes
+static void* write_records(void* argument) {
+    operationLog log = (operationLog)argument;
+    pthread_mutex_lock(&log->lock);
+    while (true) {
+        while (log->pending_size == 0 && !log->closing) {
+            pthread_cond_wait(&log->logged, &log->lock);
+        }
+        if (log->pending_size == 0) {
+            break; // Closing, and everything is written
+        }
+        char* batch = log->pending;
+        long size = log->pending_size;
+        long capacity = log->pending_capacity;
+        unsigned long long target = log->logged_bytes;
+        bool failed = log->failed;
+        log->pending = log->batch;
+        log->pending_capacity = log->batch_capacity;
+        log->pending_size = 0;
+        log->batch = batch;
+        log->batch_capacity = capacity;
+        // The daycare goes on logging into the other buffer meanwhile
+        pthread_mutex_unlock(&log->lock);
+        bool ok = !failed && write_all(log->file, batch, size)
+                  && (log->durability == Log_Unsynced || fdatasync(log->file) == 0);
+        pthread_mutex_lock(&log->lock);
+        if (!ok) {
+            log->failed = true;
+        }
+        log->written_bytes = target;
+        pthread_cond_broadcast(&log->written);
+    }
+    pthread_mutex_unlock(&log->lock);
+    return NULL;
+}
+
+// Hands a record to the log thread, and waits for it to be synced if the durability asks to
+static status append_record(operationLog log, RecordBuilder* record) {
+    if (record->overflow) {
+        return Invlid_Input;
+    }
+    uint32_t size = (uint32_t)record->size;
+    uint32_t checksum = checksum_record(record->data + RECORD_PREFIX_SIZE, record->size);
+    memcpy(record->data, &size, sizeof(size));
+    memcpy(record->data + sizeof(size), &checksum, sizeof(checksum));
+    long total = RECORD_PREFIX_SIZE + record->size;
+    pthread_mutex_lock(&log->lock);
+    if (log->failed) {
+        pthread_mutex_unlock(&log->lock);
+        return failure;
+    }
+    if (log->pending_size + total > log->pending_capacity) {
+        long capacity = log->pending_capacity * 2;
+        while (log->pending_size + total > capacity) {
+            capacity *= 2;
+        }
+        char* grown = (char*)realloc(log->pending, (size_t)capacity);
+        if (grown == NULL) {
+            pthread_mutex_unlock(&log->lock);
+            return Memory_Problem;
+        }
+        log->pending = grown;
+        log->pending_capacity = capacity;
+    }
+    memcpy(log->pending + log->pending_size, record->data, (size_t)total);
+    log->pending_size += total;
+    log->logged_bytes += (unsigned long long)total;
+    unsigned long long target = log->logged_bytes;
+    pthread_cond_signal(&log->logged);
+    if (log->durability == Log_Synchronous) {
+        while (log->written_bytes < target && !log->failed) {
+            pthread_cond_wait(&log->written, &log->lock);
+        }
+    }
+    status s = log->failed ? failure : success;
+    pthread_mutex_unlock(&log->lock);
+    return s;
+}
+
+// Waits until the log thread wrote every record logged so far, with the lock held
+static void wait_for_writes(operationLog log) {
+    while (log->written_bytes < log->logged_bytes && !log->failed) {
+        pthread_cond_wait(&log->written, &log->lock);
+    }
+}
+
+// Writes the header of an empty log at the start of the file and syncs it
+static bool write_header(int file, unsigned long long base) {
+    LogHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, LOG_MAGIC, sizeof(header.magic));
+    header.version = LOG_VERSION;
+    header.byte_order = LOG_BYTE_ORDER;
+    header.base = base;
+    return ftruncate(file, 0) == 0 && lseek(file, 0, SEEK_SET) == 0 && write_all(file, (char*)&header, sizeof(header))
+           && fsync(file) == 0;
+}
+
+// --- The log ---
+
+operationLog openOperationLog(char* path, logDurability durability, unsigned long long base, unsigned long long* applied,
+                              LogHandlers* handlers, Element context, status* result) {
+    status ignored;
+    if (result == NULL) {
+        result = &ignored;
+    }
+    if (path == NULL || handlers == NULL || handlers->admit == NULL || handlers->add_characteristic == NULL
+        || handlers->remove_characteristic == NULL || handlers->check_out == NULL || handlers->activity == NULL) {
+        *result = Invlid_Input;
+        return NULL;
+    }
+    // Replay the records of an existing log, a new or empty one gets a header
+    long end = 0;
+    if (access(path, F_OK) == 0) {
+        ConfigText text;
+        *result = mapConfigFile(path, &text); // Mapped like a configuration file, the records are read in place
+        if (*result != success) {
+            return NULL;
+        }
+        if (text.size > 0) {
+            *result = replay_log(text.data, text.size, base, applied, handlers, context, &end);
+        }
+        long size = text.size;
+        unmapConfigFile(&text);
+        if (*result != success) {
+            return NULL;
+        }
+        if (end == size) {
+            end = size == 0 ? 0 : -1; // Nothing to drop
+        }
+    }
+    operationLog log = (operationLog)malloc(sizeof(struct operationLog_s));
+    if (log == NULL) {
+        *result = Memory_Problem;
+        return NULL;
+    }
+    log->file = open(path, O_WRONLY | O_CREAT, 0644);
+    bool ready = log->file >= 0;
+    if (ready && end == 0) {
+        ready = write_header(log->file, base);
+    } else if (ready && end > 0) {
+        ready = ftruncate(log->file, end) == 0 && fsync(log->file) == 0; // Drop the records cut by a crash
+    }
+    if (!ready || lseek(log->file, 0, SEEK_END) < 0) {
+        if (log->file >= 0) {
+            close(log->file);
+        }
+        free(log);
+        *result = Invlid_Input;
+        return NULL;
+    }
+    log->durability = durability;
+    log->base = base;
+    log->pending = (char*)malloc(LOG_BUFFER_SIZE);
+    log->batch = (char*)malloc(LOG_BUFFER_SIZE);
+    log->pending_size = 0;
+    log->pending_capacity = LOG_BUFFER_SIZE;
+    log->batch_capacity = LOG_BUFFER_SIZE;
+    log->logged_bytes = 0;
+    log->written_bytes = 0;
+    log->closing = false;
+    log->failed = false;
+    pthread_mutex_init(&log->lock, NULL);
+    pthread_cond_init(&log->logged, NULL);
+    pthread_cond_init(&log->written, NULL);
+    if (log->pending == NULL || log->batch == NULL || pthread_create(&log->thread, NULL, write_records, log) != 0) {
+        pthread_cond_destroy(&log->written);
+        pthread_cond_destroy(&log->logged);
+        pthread_mutex_destroy(&log->lock);
+        free(log->pending);
+        free(log->batch);
+        close(log->file);
+        free(log);
+        *result = Memory_Problem;
+        return NULL;
+    }
+    *result = success;
+    return log;
+}
+
+status logAdmit(operationLog log, char* id, char* planet, char* dimension, int happiness) {
+    if (log == NULL) {
+        return success;
+    }
+    RecordBuilder record;
+    start_record(&record, Admit_Record);
+    put_string(&record, id);
+    put_string(&record, planet);
+    put_string(&record, dimension);
+    put_int32(&record, happiness);
+    return append_record(log, &record);
+}
+
+status logAddCharacteristic(operationLog log, char* id, char* name, double value) {
+    if (log == NULL) {
+        return success;
+    }
+    RecordBuilder record;
+    start_record(&record, Add_Record);
+    put_string(&record, id);
+    put_string(&record, name);
+    put_field(&record, &value, sizeof(value));
+    return append_record(log, &record);
+}
+
+status logRemoveCharacteristic(operationLog log, char* id, char* name) {
+    if (log == NULL) {
+        return success;
+    }
+    RecordBuilder record;
+    start_record(&record, Remove_Record);
+    put_string(&record, id);
+    put_string(&record, name);
+    return append_record(log, &record);
+}
+
+status logCheckOut(operationLog log, char* id) {
+    if (log == NULL) {
+        return success;
+    }
+    RecordBuilder record;
+    start_record(&record, Check_Out_Record);
+    put_string(&record, id);
+    return append_record(log, &record);
+}
+
+status logActivity(operationLog log, int activity) {
+    if (log == NULL) {
+        return success;
+    }
+    RecordBuilder record;
+    start_record(&record, Activity_Record);
+    put_int32(&record, activity);
+    return append_record(log, &record);
+}
+
+status resetOperationLog(operationLog log, unsigned long long base) {
+    if (log == NULL) {
+        return failure;
+    }
+    pthread_mutex_lock(&log->lock);
+    wait_for_writes(log);
+    // The log thread is idle until the next record, which waits for the lock
+    if (!log->failed && !write_header(log->file, base)) {
+        log->failed = true;
+    }
+    if (!log->failed) {
+        log->base = base;
+    }
+    status s = log->failed ? failure : success;
+    pthread_mutex_unlock(&log->lock);
+    return s;
+}
+
+unsigned long long getOperationLogBase(operationLog log) {
+    if (log == NULL) {
+        return 0;
+    }
+    pthread_mutex_lock(&log->lock);
+    unsigned long long base = log->base;
+    pthread_mutex_unlock(&log->lock);
+    return base;
+}
+
+status closeOperationLog(operationLog log) {
+    if (log == NULL) {
+        return success;
+    }
+    pthread_mutex_lock(&log->lock);
+    log->closing = true;
+    pthread_cond_signal(&log->logged);
+    pthread_mutex_unlock(&log->lock);
+    pthread_join(log->thread, NULL); // It writes what is left first
+    bool ok = !log->failed && fsync(log->file) == 0;
+    if (close(log->file) != 0) {
+        ok = false;
+    }
+    pthread_cond_destroy(&log->written);
+    pthread_cond_destroy(&log->logged);
+    pthread_mutex_destroy(&log->lock);
+    free(log->pending);
+    free(log->batch);
+    free(log);
+    return ok ? success : failure;
+}
@@ -0,0 +1,534 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "OrderedIndex.h"
+#include "MemoryPool.h"
+#define NODES_PER_SLAB 64 // Tree nodes malloced at once
+
+// A node of the AVL tree
+typedef struct index_node_s {
+    double value;                   // The number the node is ordered by
+    unsigned long order;            // Sequence number of the addition, breaks ties between equally close nodes
+    Element content;
+    struct index_node_s* left;
+    struct index_node_s* right;
+    struct index_node_s* parent;    // Lets a node be removed and walked from through its handle
+    int height;                     // Height of the subtree of the node (a leaf has height 1)
+    int count;                      // Number of nodes in the subtree of the node, for counting ranges
+} IndexNode;
+
+struct orderedIndex_s {
+    IndexNode* root;
+    int size;
+    unsigned long added;    // Number of additions so far, the next sequence number
+    memoryPool pool;        // Pool of the nodes, released in bulk when the index is destroyed
+    CopyFunction copyElement;
+    FreeFunction freeElement;
+    PrintFunction printElement;
+};
+
+// Returns the height of a subtree (0 for an empty one)
+static int height(IndexNode* node) {
+    return node == NULL ? 0 : node->height;
+}
+
+// Returns the number of nodes in a subtree (0 for an empty one)
+static int count(IndexNode* node) {
+    return node == NULL ? 0 : node->count;
+}
+
+// Recalculates the height and the count of a node from its children
+static void updateNode(IndexNode* node) {
+    int left = height(node->left);
+    int right = height(node->right);
+    node->height = (left > right ? left : right) + 1;
+    node->count = count(node->left) + count(node->right) + 1;
+}
+
+// Makes the parent of old point to replacement instead (or the root, if old has no parent)
+static void replaceChild(orderedIndex index, IndexNode* parent, IndexNode* old, IndexNode* replacement) {
+    if (parent == NULL) {
+        index->root = replacement;
+    } else if (parent->left == old) {
+        parent->left = replacement;
+    } else {
+        parent->right = replacement;
+    }
+    if (replacement != NULL) {
+        replacement->parent = parent;
+    }
+}
+
+// Rotates a subtree to the left, its right child becomes its root
+static void rotateLeft(orderedIndex index, IndexNode* node) {
+    IndexNode* pivot = node->right;
+    node->right = pivot->left;
+    if (pivot->left != NULL) {
+        pivot->left->parent = node;
+    }
+    replaceChild(index, node->parent, node, pivot);
+    pivot->left = node;
+    node->parent = pivot;
+    updateNode(node);
+    updateNode(pivot);
+}
+
+// Rotates a subtree to the right, its left child becomes its root
+static void rotateRight(orderedIndex index, IndexNode* node) {
+    IndexNode* pivot = node->left;
+    node->left = pivot->right;
+    if (pivot->right != NULL) {
+        pivot->right->parent = node;
+    }
+    replaceChild(index, node->parent, node, pivot);
+    pivot->right = node;
+    node->parent = pivot;
+    updateNode(node);
+    updateNode(pivot);
+}
+
+// Restores the AVL balance on the path from a node up to the root
+static void rebalance(orderedIndex index, IndexNode* node) {
+    while (node != NULL) {
+        updateNode(node);
+        int balance = height(node->left) - height(node->right);
+        if (balance > 1) {
+            if (height(node->left->left) < height(node->left->right)) {
+                rotateLeft(index, node->left);
+            }
+            rotateRight(index, node);
+            node = node->parent; // The new root of the subtree
+        } else if (balance < -1) {
+            if (height(node->right->right) < height(node->right->left)) {
+                rotateRight(index, node->right);
+            }
+            rotateLeft(index, node);
+            node = node->parent;
+        }
+        node = node->parent;
+    }
+}
+
+// Returns the leftmost node of a subtree
+static IndexNode* leftmost(IndexNode* node) {
+    while (node->left != NULL) {
+        node = node->left;
+    }
+    return node;
+}
+
+// Returns the first node whose number is not below the target, or NULL
+static IndexNode* lowerBound(orderedIndex index, double target) {
+    IndexNode* found = NULL;
+    IndexNode* current = index->root;
+    while (current != NULL) {
+        if (current->value >= target) {
+            found = current;
+            current = current->left;
+        } else {
+            current = current->right;
+        }
+    }
+    return found;
+}
+
+// Returns the last node whose number is not above the target, or NULL
+static IndexNode* lastNotAbove(orderedIndex index, double target) {
+    IndexNode* found = NULL;
+    IndexNode* current = index->root;
+    while (current != NULL) {
+        if (current->value <= target) {
+            found = current;
+            current = current->right;
+        } else {
+            current = current->left;
+        }
+    }
+    return found;
+}
+
+// Returns the number of nodes whose number is below the target (or not above it, if inclusive)
+static int countBelow(orderedIndex index, double target, bool inclusive) {
+    int below = 0;
+    IndexNode* current = index->root;
+    while (current != NULL) {
+        if (current->value < target || (inclusive && current->value == target)) {
+            below += count(current->left) + 1;
+            current = current->right;
+        } else {
+            current = current->left;
+        }
+    }
+    return below;
+}
+
+orderedIndex createOrderedIndex(CopyFunction copyElement, FreeFunction freeElement, PrintFunction printElement) {
+    if (copyElement == NULL || freeElement == NULL || printElement == NULL) {
+        return NULL;
+    }
+    orderedIndex index = (orderedIndex)malloc(sizeof(struct orderedIndex_s));
+    if (index == NULL) {
+        return NULL;
+    }
+    index->pool = createMemoryPool(sizeof(IndexNode), NODES_PER_SLAB);
+    if (index->pool == NULL) {
+        free(index);
+        return NULL;
+    }
+    index->root = NULL;
+    index->size = 0;
+    index->added = 0;
+    index->copyElement = copyElement;
+    index->freeElement = freeElement;
+    index->printElement = printElement;
+    return index;
+}
+
+status destroyOrderedIndex(orderedIndex index) {
+    if (index == NULL) {
+        return failure;
+    }
+    // Free the elements, the nodes themselves go with the pool
+    for (IndexNode* node = getFirstIndexNode(index); node != NULL; node = getNextIndexNode(node)) {
+        index->freeElement(node->content);
+    }
+    destroyMemoryPool(index->pool);
+    free(index);
+    return success;
+}
+
+status addToOrderedIndex(orderedIndex index, double value, Element element, indexNode* handle) {
+    if (index == NULL || element == NULL) {
+        return failure;
+    }
+    IndexNode* node = (IndexNode*)allocateFromPool(index->pool);
+    if (node == NULL) {
+        return Memory_Problem;
+    }
+    node->content = index->copyElement(element);
+    if (node->content == NULL) {
+        returnToPool(index->pool, node);
+        return Memory_Problem;
+    }
+    node->value = value;
+    node->order = index->added++;
+    node->left = NULL;
+    node->right = NULL;
+    node->height = 1;
+    node->count = 1;
+    // Equal numbers go to the right, so they keep the order they were added in
+    IndexNode* parent = NULL;
+    IndexNode* current = index->root;
+    while (current != NULL) {
+        parent = current;
+        current = value < current->value ? current->left : current->right;
+    }
+    node->parent = parent;
+    if (parent == NULL) {
+        index->root = node;
+    } else if (value < parent->value) {
+        parent->left = node;
+    } else {
+        parent->right = node;
+    }
+    rebalance(index, parent);
+    index->size++;
+    if (handle != NULL) {
+        *handle = node;
+    }
+    return success;
+}
+
+status removeFromOrderedIndex(orderedIndex index, indexNode handle) {
+    if (index == NULL || handle == NULL) {
+        return failure;
+    }
+    IndexNode* node = handle;
+    IndexNode* fix; // Lowest node whose subtree changed
+    if (node->left == NULL) {
+        fix = node->parent;
+        replaceChild(index, node->parent, node, node->right);
+    } else if (node->right == NULL) {
+        fix = node->parent;
+        replaceChild(index, node->parent, node, node->left);
+    } else {
+        // Relink the successor into the place of the node, so the handles of other nodes stay valid
+        IndexNode* successor = leftmost(node->right);
+        if (successor->parent != node) {
+            fix = successor->parent;
+            replaceChild(index, successor->parent, successor, successor->right);
+            successor->right = node->right;
+            successor->right->parent = successor;
+        } else {
+            fix = successor;
+        }
+        replaceChild(index, node->parent, node, successor);
+        successor->left = node->left;
+        successor->left->parent = successor;
+        successor->height = node->height;
+    }
+    rebalance(index, fix);
+    index->freeElement(node->content);
+    returnToPool(index->pool, node);
+    index->size--;
+    return success;
+}
+
+indexNode findFloorInIndex(orderedIndex index, double target) {
+    if (index == NULL) {
+        return NULL;
+    }
+    IndexNode* last = lastNotAbove(index, target);
+    if (last == NULL) {
+        return NULL;
+    }
+    return lowerBound(index, last->value); // The first added node with the same number
+}
+
+indexNode findCeilingInIndex(orderedIndex index, double target) {
+    if (index == NULL) {
+        return NULL;
+    }
+    return lowerBound(index, target);
+}
+
+indexNode findNearestInIndex(orderedIndex index, double target) {
+    IndexNode* floor = findFloorInIndex(index, target);
+    IndexNode* ceiling = findCeilingInIndex(index, target);
+    if (floor == NULL) {
+        return ceiling;
+    }
+    if (ceiling == NULL) {
+        return floor;
+    }
+    double floorDiff = target - floor->value;
+    double ceilingDiff = ceiling->value - target;
+    if (floorDiff < ceilingDiff) {
+        return floor;
+    }
+    if (ceilingDiff < floorDiff) {
+        return ceiling;
+    }
+    return floor->order < ceiling->order ? floor : ceiling;
+}
+
+int countInIndexRange(orderedIndex index, double low, double high) {
+    if (index == NULL) {
+        return -1;
+    }
+    if (low > high) {
+        return 0;
+    }
+    return countBelow(index, high, true) - countBelow(index, low, false);
+}
+
+status forEachInIndexRange(orderedIndex index, double low, double high, VisitFunction visit, Element context) {
+    if (index == NULL || visit == NULL) {
+        return failure;
+    }
+    for (IndexNode* node = lowerBound(index, low); node != NULL && node->value <= high; node = getNextIndexNode(node)) {
+        status s = visit(node->content, context);
+        if (s != success) {
+            return s;
+        }
+    }
+    return success;
+}
+
+// Returns the weighted squared distance of a node from the target of a dimension, or the missing distance if there is no node
+static double gapOf(IndexDimension* dimension, IndexNode* node) {
+    if (node == NULL) {
+        return dimension->missing;
+    }
+    double gap = node->value - dimension->target;
+    return dimension->weight * gap * gap;
+}
+
+int findNearestInIndexes(IndexDimension* dimensions, int dimensionCount, DistanceFunction distance, Element context, int k, Element* nearest, double* distances) {
+    if (dimensions == NULL || dimensionCount < 1 || distance == NULL || k < 1 || nearest == NULL) {
+        return -1;
+    }
+    // Only the elements of the indexes are candidates, so more than all of them are never found
+    int candidates = 0;
+    for (int d = 0; d < dimensionCount; d++) {
+        candidates += dimensions[d].index != NULL ? dimensions[d].index->size : 0;
+    }
+    if (candidates == 0) {
+        return 0;
+    }
+    if (k > candidates) {
+        k = candidates;
+    }
+    // Two cursors per dimension, walking down and up from the target
+    IndexNode** below = (IndexNode**)malloc(dimensionCount * sizeof(IndexNode*));
+    IndexNode** above = (IndexNode**)malloc(dimensionCount * sizeof(IndexNode*));
+    double* best = (double*)malloc(k * sizeof(double));
+    if (below == NULL || above == NULL || best == NULL) {
+        free(below);
+        free(above);
+        free(best);
+        return -1;
+    }
+    for (int d = 0; d < dimensionCount; d++) {
+        below[d] = NULL;
+        above[d] = NULL;
+        if (dimensions[d].index != NULL) {
+            below[d] = lastNotAbove(dimensions[d].index, dimensions[d].target);
+            above[d] = below[d] != NULL ? getNextIndexNode(below[d]) : getFirstIndexNode(dimensions[d].index);
+        }
+    }
+    int found = 0;
+    while (true) {
+        // Pick the closest cursor, and bound the distance of every element no cursor has reached yet
+        double bound = 0;
+        int nextDimension = -1;
+        bool fromBelow = false;
+        double nextGap = 0;
+        for (int d = 0; d < dimensionCount; d++) {
+            double belowGap = below[d] != NULL ? gapOf(&dimensions[d], below[d]) : -1;
+            double aboveGap = above[d] != NULL ? gapOf(&dimensions[d], above[d]) : -1;
+            double frontier = dimensions[d].missing;
+            if (belowGap >= 0 && belowGap < frontier) {
+                frontier = belowGap;
+            }
+            if (aboveGap >= 0 && aboveGap < frontier) {
+                frontier = aboveGap;
+            }
+            bound += frontier;
+            if (belowGap >= 0 && (nextDimension == -1 || belowGap < nextGap)) {
+                nextDimension = d;
+                fromBelow = true;
+                nextGap = belowGap;
+            }
+            if (aboveGap >= 0 && (nextDimension == -1 || aboveGap < nextGap)) {
+                nextDimension = d;
+                fromBelow = false;
+                nextGap = aboveGap;
+            }
+        }
+        if (nextDimension == -1 || (found == k && bound >= best[k - 1])) {
+            break; // Every index was walked, or nothing left can enter the k best
+        }
+        IndexNode* node;
+        if (fromBelow) {
+            node = below[nextDimension];
+            below[nextDimension] = getPrevIndexNode(node);
+        } else {
+            node = above[nextDimension];
+            above[nextDimension] = getNextIndexNode(node);
+        }
+        // An element held by several indexes is reached once per index, but enters the k best only once
+        bool known = false;
+        for (int i = 0; i < found; i++) {
+            if (nearest[i] == node->content) {
+                known = true;
+                break;
+            }
+        }
+        if (known) {
+            continue;
+        }
+        double d = distance(node->content, context);
+        if (found == k && d >= best[k - 1]) {
+            continue;
+        }
+        // Insert into the k best, keeping them sorted (equal distances keep the order they were found in)
+        int position = found < k ? found++ : k - 1;
+        while (position > 0 && best[position - 1] > d) {
+            best[position] = best[position - 1];
+            nearest[position] = nearest[position - 1];
+            position--;
+        }
+        best[position] = d;
+        nearest[position] = node->content;
+    }
+    if (distances != NULL) {
+        for (int i = 0; i < found; i++) {
+            distances[i] = best[i];
+        }
+    }
+    free(below);
+    free(above);
+    free(best);
+    return found;
+}
+
+indexNode getFirstIndexNode(orderedIndex index) {
+    if (index == NULL || index->root == NULL) {
+        return NULL;
+    }
+    return leftmost(index->root);
+}
+
+indexNode getLastIndexNode(orderedIndex index) {
+    if (index == NULL || index->root == NULL) {
+        return NULL;
+    }
+    IndexNode* node = index->root;
+    while (node->right != NULL) {
+        node = node->right;
+    }
+    return node;
+}
+
+indexNode getNextIndexNode(indexNode node) {
+    if (node == NULL) {
+        return NULL;
+    }
+    if (node->right != NULL) {
+        return leftmost(node->right);
+    }
+    // Climb until coming up from a left child
+    while (node->parent != NULL && node->parent->right == node) {
+        node = node->parent;
+    }
+    return node->parent;
+}
+
+indexNode getPrevIndexNode(indexNode node) {
+    if (node == NULL) {
+        return NULL;
+    }
+    if (node->left != NULL) {
+        node = node->left;
+        while (node->right != NULL) {
+            node = node->right;
+        }
+        return node;
+    }
+    // Climb until coming up from a right child
+    while (node->parent != NULL && node->parent->left == node) {
+        node = node->parent;
+    }
+    return node->parent;
+}
+
+Element getIndexNodeData(indexNode node) {
+    if (node == NULL) {
+        return NULL;
+    }
+    return node->content;
+}
+
+double getIndexNodeValue(indexNode node) {
+    if (node == NULL) {
+        return 0;
+    }
+    return node->value;
+}
+
+int getIndexSize(orderedIndex index) {
+    if (index == NULL) {
+        return -1;
+    }
+    return index->size;
+}
+
+status displayOrderedIndex(orderedIndex index) {
+    if (index == NULL) {
+        return failure;
+    }
+    for (IndexNode* node = getFirstIndexNode(index); node != NULL; node = getNextIndexNode(node)) {
+        index->printElement(node->content);
+    }
+    return success;
+}
@@ -0,0 +1,249 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "PriorityQueue.h"
+#include "MemoryPool.h"
+#define HEAP_ARITY 4          // Children of every heap position, a wider heap is shallower
+#define INITIAL_CAPACITY 16   // Positions of a new heap array, it doubles when full
+#define NODES_PER_SLAB 64     // Heap nodes malloced at once
+
+// A heap node, it keeps its position so that a handle can be removed or updated without a search
+typedef struct heap_node_s {
+    Element content;
+    unsigned long order;    // Sequence number of the addition, orders equal elements
+    int position;           // Index of the node in the heap array
+} HeapNode;
+
+struct priorityQueue_s {
+    HeapNode** heap;        // The heap array, the smallest element first
+    int size;
+    int capacity;
+    unsigned long added;    // Number of additions so far, the next sequence number
+    bool stale;             // The priorities changed outside the queue, the heap must be rebuilt before use
+    memoryPool pool;        // Pool of the nodes, released in bulk when the queue is destroyed
+    CopyFunction copyElement;
+    FreeFunction freeElement;
+    PrintFunction printElement;
+    CompareFunction compare;
+};
+
+// Checks if the node at position a should be above the node at position b
+static bool isBefore(priorityQueue pq, int a, int b) {
+    int result = pq->compare(pq->heap[a]->content, pq->heap[b]->content);
+    if (result != 0) {
+        return result < 0;
+    }
+    return pq->heap[a]->order < pq->heap[b]->order;
+}
+
+// Rebuilds the heap if its order is stale
+static void restoreOrder(priorityQueue pq) {
+    if (pq->stale) {
+        rebuildPriorityQueue(pq);
+    }
+}
+
+// Swaps two positions of the heap array
+static void swapPositions(priorityQueue pq, int a, int b) {
+    HeapNode* node = pq->heap[a];
+    pq->heap[a] = pq->heap[b];
+    pq->heap[b] = node;
+    pq->heap[a]->position = a;
+    pq->heap[b]->position = b;
+}
+
+// Moves a node up until its parent is before it, returns its final position
+static int siftUp(priorityQueue pq, int position) {
+    while (position > 0) {
+        int parent = (position - 1) / HEAP_ARITY;
+        if (!isBefore(pq, position, parent)) {
+            break;
+        }
+        swapPositions(pq, position, parent);
+        position = parent;
+    }
+    return position;
+}
+
+// Moves a node down until it is before all its children
+static void siftDown(priorityQueue pq, int position) {
+    while (true) {
+        int first = position * HEAP_ARITY + 1;
+        int smallest = position;
+        for (int child = first; child < first + HEAP_ARITY && child < pq->size; child++) {
+            if (isBefore(pq, child, smallest)) {
+                smallest = child;
+            }
+        }
+        if (smallest == position) {
+            return;
+        }
+        swapPositions(pq, position, smallest);
+        position = smallest;
+    }
+}
+
+priorityQueue createPriorityQueue(CopyFunction copyElement, FreeFunction freeElement, PrintFunction printElement, CompareFunction compare) {
+    if (copyElement == NULL || freeElement == NULL || printElement == NULL || compare == NULL) {
+        return NULL;
+    }
+    priorityQueue pq = (priorityQueue)malloc(sizeof(struct priorityQueue_s));
+    if (pq == NULL) {
+        return NULL;
+    }
+    pq->heap = (HeapNode**)malloc(INITIAL_CAPACITY * sizeof(HeapNode*));
+    pq->pool = createMemoryPool(sizeof(HeapNode), NODES_PER_SLAB);
+    if (pq->heap == NULL || pq->pool == NULL) {
+        free(pq->heap);
+        destroyMemoryPool(pq->pool);
+        free(pq);
+        return NULL;
+    }
+    pq->size = 0;
+    pq->capacity = INITIAL_CAPACITY;
+    pq->added = 0;
+    pq->stale = false;
+    pq->copyElement = copyElement;
+    pq->freeElement = freeElement;
+    pq->printElement = printElement;
+    pq->compare = compare;
+    return pq;
+}
+
+status destroyPriorityQueue(priorityQueue pq) {
+    if (pq == NULL) {
+        return failure;
+    }
+    for (int i = 0; i < pq->size; i++) {
+        pq->freeElement(pq->heap[i]->content);
+    }
+    destroyMemoryPool(pq->pool); // The nodes go with their slabs
+    free(pq->heap);
+    free(pq);
+    return success;
+}
+
+status pushToPriorityQueue(priorityQueue pq, Element element, heapNode* handle) {
+    if (pq == NULL || element == NULL) {
+        return failure;
+    }
+    if (pq->size == pq->capacity) {
+        HeapNode** heap = (HeapNode**)realloc(pq->heap, pq->capacity * 2 * sizeof(HeapNode*));
+        if (heap == NULL) {
+            return Memory_Problem;
+        }
+        pq->heap = heap;
+        pq->capacity *= 2;
+    }
+    restoreOrder(pq);
+    HeapNode* node = (HeapNode*)allocateFromPool(pq->pool);
+    if (node == NULL) {
+        return Memory_Problem;
+    }
+    node->content = pq->copyElement(element);
+    if (node->content == NULL) {
+        returnToPool(pq->pool, node);
+        return Memory_Problem;
+    }
+    node->order = pq->added++;
+    node->position = pq->size;
+    pq->heap[pq->size++] = node;
+    siftUp(pq, node->position);
+    if (handle != NULL) {
+        *handle = node;
+    }
+    return success;
+}
+
+Element peekPriorityQueue(priorityQueue pq) {
+    if (pq == NULL || pq->size == 0) {
+        return NULL;
+    }
+    restoreOrder(pq);
+    return pq->heap[0]->content;
+}
+
+heapNode getTopHeapNode(priorityQueue pq) {
+    if (pq == NULL || pq->size == 0) {
+        return NULL;
+    }
+    restoreOrder(pq);
+    return pq->heap[0];
+}
+
+status removeFromPriorityQueue(priorityQueue pq, heapNode handle) {
+    if (pq == NULL || handle == NULL || handle->position >= pq->size || pq->heap[handle->position] != handle) {
+        return failure;
+    }
+    restoreOrder(pq);
+    int position = handle->position;
+    // The last node takes the place of the removed one and moves up or down from there
+    pq->size--;
+    if (position != pq->size) {
+        pq->heap[position] = pq->heap[pq->size];
+        pq->heap[position]->position = position;
+        if (siftUp(pq, position) == position) {
+            siftDown(pq, position);
+        }
+    }
+    pq->freeElement(handle->content);
+    returnToPool(pq->pool, handle);
+    return success;
+}
+
+status updateInPriorityQueue(priorityQueue pq, heapNode handle) {
+    if (pq == NULL || handle == NULL || handle->position >= pq->size || pq->heap[handle->position] != handle) {
+        return failure;
+    }
+    if (pq->stale) {
+        rebuildPriorityQueue(pq); // Puts the node in its place too
+        return success;
+    }
+    if (siftUp(pq, handle->position) == handle->position) {
+        siftDown(pq, handle->position);
+    }
+    return success;
+}
+
+status rebuildPriorityQueue(priorityQueue pq) {
+    if (pq == NULL) {
+        return failure;
+    }
+    // Floyd's heap construction: sift down every parent, from the last one to the root
+    for (int i = (pq->size - 2) / HEAP_ARITY; i >= 0; i--) {
+        siftDown(pq, i);
+    }
+    pq->stale = false;
+    return success;
+}
+
+status invalidatePriorityQueue(priorityQueue pq) {
+    if (pq == NULL) {
+        return failure;
+    }
+    pq->stale = true;
+    return success;
+}
+
+Element getHeapNodeData(heapNode node) {
+    if (node == NULL) {
+        return NULL;
+    }
+    return node->content;
+}
+
+int getPriorityQueueSize(priorityQueue pq) {
+    if (pq == NULL) {
+        return -1;
+    }
+    return pq->size;
+}
+
+status displayPriorityQueue(priorityQueue pq) {
+    if (pq == NULL) {
+        return failure;
+    }
+    for (int i = 0; i < pq->size; i++) {
+        pq->printElement(pq->heap[i]->content);
+    }
+    return success;
+}
@@ -0,0 +1,164 @@
+//
+// The feed of a roster file that grows while the daycare runs.
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include "RosterFeed.h"
+#define EVENTS_BUFFER_SIZE 4096 // Bytes of inotify events read at once
+
+struct rosterFeed_s {
+    int file;
+    int watch;                 // The inotify descriptor, -1 when the size is checked on every poll
+    long offset;               // Bytes of the file read so far, up to the end of the last whole line
+    bool changed;              // The file changed since the last batch that was read completely
+};
+
+// Reads the pending events of the watch, true if the file was written to
+static bool drain_events(int watch) {
+    char events[EVENTS_BUFFER_SIZE];
+    bool written = false;
+    while (true) {
+        ssize_t size = read(watch, events, sizeof(events));
+        if (size < 0 && errno == EINTR) {
+            continue;
+        }
+        if (size <= 0) {
+            return written; // EAGAIN, no more events
+        }
+        written = true; // Only IN_MODIFY is watched
+    }
+}
+
+// Reads size bytes of a file from an offset, past interrupted and partial reads
+static bool read_at(int file, char* data, long size, long offset) {
+    while (size > 0) {
+        ssize_t part = pread(file, data, (size_t)size, offset);
+        if (part < 0 && errno == EINTR) {
+            continue;
+        }
+        if (part <= 0) {
+            return false;
+        }
+        data += part;
+        size -= part;
+        offset += part;
+    }
+    return true;
+}
+
+rosterFeed openRosterFeed(char* path, status* result) {
+    status ignored;
+    if (result == NULL) {
+        result = &ignored;
+    }
+    if (path == NULL) {
+        *result = Invlid_Input;
+        return NULL;
+    }
+    rosterFeed feed = (rosterFeed)malloc(sizeof(struct rosterFeed_s));
+    if (feed == NULL) {
+        *result = Memory_Problem;
+        return NULL;
+    }
+    struct stat info;
+    feed->file = open(path, O_RDONLY);
+    if (feed->file < 0 || fstat(feed->file, &info) != 0 || !S_ISREG(info.st_mode)) {
+        if (feed->file >= 0) {
+            close(feed->file);
+        }
+        free(feed);
+        *result = Invlid_Input;
+        return NULL;
+    }
+    feed->offset = (long)info.st_size;
+    feed->changed = false;
+    // Watched before anything is appended, so no write goes unnoticed
+    feed->watch = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (feed->watch >= 0 && inotify_add_watch(feed->watch, path, IN_MODIFY) < 0) {
+        close(feed->watch);
+        feed->watch = -1;
+    }
+    *result = success;
+    return feed;
+}
+
+status pollRosterFeed(rosterFeed feed, ConfigHandlers* handlers, Element context) {
+    if (feed == NULL || handlers == NULL) {
+        return Invlid_Input;
+    }
+    if (feed->watch >= 0 && drain_events(feed->watch)) {
+        feed->changed = true;
+    }
+    if (feed->watch >= 0 && !feed->changed) {
+        return success; // Nothing was written since the last batch
+    }
+    struct stat info;
+    if (fstat(feed->file, &info) != 0) {
+        return Invlid_Input;
+    }
+    long size = (long)info.st_size;
+    if (size < feed->offset) {
+        feed->offset = 0; // Truncated, the roster starts over
+    }
+    if (size == feed->offset) {
+        feed->changed = false;
+        return success;
+    }
+    long appended = size - feed->offset;
+    char* data = (char*)malloc((size_t)appended);
+    if (data == NULL) {
+        return Memory_Problem;
+    }
+    if (!read_at(feed->file, data, appended, feed->offset)) {
+        free(data);
+        return Invlid_Input;
+    }
+    // Only whole lines, the rest is read again once its newline is written
+    long whole = appended;
+    while (whole > 0 && data[whole - 1] != '\n') {
+        whole--;
+    }
+    status s = success;
+    long position = 0;
+    while (s == success && position < whole) {
+        long parsed = 0;
+        s = parseConfigJerries(data + position, whole - position, handlers, context, &parsed);
+        position += parsed; // Up to the failed line when a handler fails
+        if (s == success && position < whole) {
+            // A section header, the lines after it are read as Jerries too
+            const char* newline = (const char*)memchr(data + position, '\n', (size_t)(whole - position));
+            position = newline - data + 1;
+        }
+    }
+    if (s != success) {
+        // The lines before the failed one were handled, the failed one and the rest are read again on the next poll
+        while (position > 0 && data[position - 1] != '\n') {
+            position--; // From the start of a long line that failed in one of its pieces
+        }
+        free(data);
+        feed->offset += position;
+        feed->changed = true;
+        return s;
+    }
+    free(data);
+    feed->offset += whole;
+    feed->changed = whole < appended; // A line still being written
+    return success;
+}
+
+void closeRosterFeed(rosterFeed feed) {
+    if (feed == NULL) {
+        return;
+    }
+    if (feed->watch >= 0) {
+        close(feed->watch);
+    }
+    close(feed->file);
+    free(feed);
+}
@@ -0,0 +1,595 @@
+//
+// The binary snapshot of the daycare.
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "ConfigParser.h"
+#include "Snapshot.h"
+#include "TypedHashTable.h"
+#define SNAPSHOT_BYTE_ORDER 0x01020304 // Reads back differently on a machine of another byte order
+#define WRITER_BUFFER_SIZE 65536       // Bytes written at once, a multiple of 8
+#define CHECKSUM_SEED 0xcbf29ce484222325ULL
+#define CHECKSUM_PRIME 0x100000001b3ULL
+
+typedef struct SnapshotHeader_struct {
+    char magic[8];
+    int32_t version;
+    int32_t byte_order;
+    int32_t planet_count;
+    int32_t name_count;
+    int32_t jerry_count;
+    int32_t characteristic_count;
+    int32_t layout_count;      // Entries of the index layout, one per indexed characteristic
+    int32_t logged;            // 1 if the daycare had a log when it was saved, and log_base is its base
+    int64_t strings_size;      // Bytes of the strings, without the padding
+    uint64_t checksum;         // Of everything after the header
+    uint64_t log_base;         // The base of the log whose changes the snapshot holds
+} SnapshotHeader;
+
+typedef struct SnapshotPlanet_struct {
+    double x;
+    double y;
+    double z;
+    int32_t name;              // Offset of the name in the strings
+    int32_t reserved;
+} SnapshotPlanet;
+
+typedef struct SnapshotJerry_struct {
+    int32_t id;                // Offset of the id in the strings
+    int32_t dimension;         // Offset of the dimension in the strings
+    int32_t planet;            // Position of the planet in the planets
+    int32_t happiness;
+    int32_t first;             // Position of the first characteristic in the characteristics
+    int32_t count;             // Number of characteristics
+} SnapshotJerry;
+
+typedef struct SnapshotCharacteristic_struct {
+    double value;
+    int32_t id;                // Id of the name in the names
+    int32_t reserved;
+} SnapshotCharacteristic;
+
+// The parts of a snapshot in memory, found from the counts of the header
+typedef struct SnapshotLayout_struct {
+    const SnapshotPlanet* planets;
+    const int32_t* names;
+    const SnapshotJerry* jerries;
+    const SnapshotCharacteristic* characteristics;
+    const int32_t* layout_starts;  // For every name id, where its Jerries start in layout_jerries (name_count + 1 entries)
+    const int32_t* layout_jerries; // Positions of Jerries in the Jerries
+    const char* strings;
+} SnapshotLayout;
+
+struct snapshot_s {
+    ConfigText text;           // The mapped file
+    SnapshotHeader header;
+    SnapshotLayout layout;
+    Jerry** jerries;           // The restored Jerries, by position
+};
+
+// Rounds a size up to a multiple of 8
+static int64_t padded(int64_t size) {
+    return (size + 7) / 8 * 8;
+}
+
+// Folds whole 8 byte words into a checksum
+static uint64_t checksum_words(uint64_t checksum, const unsigned char* data, int64_t size) {
+    for (int64_t i = 0; i + 8 <= size; i += 8) {
+        uint64_t word;
+        memcpy(&word, data + i, 8);
+        checksum = (checksum ^ word) * CHECKSUM_PRIME;
+        checksum ^= checksum >> 32;
+    }
+    return checksum;
+}
+
+// Computes the layout of a snapshot from the counts of its header, returns its size in bytes
+static int64_t layout_snapshot(const SnapshotHeader* header, const char* data, SnapshotLayout* layout) {
+    int64_t offset = sizeof(SnapshotHeader);
+    layout->planets = (const SnapshotPlanet*)(data + offset);
+    offset += (int64_t)header->planet_count * sizeof(SnapshotPlanet);
+    layout->names = (const int32_t*)(data + offset);
+    offset += padded((int64_t)header->name_count * sizeof(int32_t));
+    layout->jerries = (const SnapshotJerry*)(data + offset);
+    offset += (int64_t)header->jerry_count * sizeof(SnapshotJerry);
+    layout->characteristics = (const SnapshotCharacteristic*)(data + offset);
+    offset += (int64_t)header->characteristic_count * sizeof(SnapshotCharacteristic);
+    layout->layout_starts = (const int32_t*)(data + offset);
+    offset += padded(((int64_t)header->name_count + 1) * sizeof(int32_t));
+    layout->layout_jerries = (const int32_t*)(data + offset);
+    offset += padded((int64_t)header->layout_count * sizeof(int32_t));
+    layout->strings = data + offset;
+    return offset + padded(header->strings_size);
+}
+
+// --- Saving ---
+
+// Writes the body of a snapshot through a buffer, checksumming it on the way
+typedef struct SnapshotWriter_struct {
+    FILE* file;
+    unsigned char buffer[WRITER_BUFFER_SIZE];
+    int used;
+    int64_t written;           // Bytes put since the start of the body
+    uint64_t checksum;
+    bool failed;
+} SnapshotWriter;
+
+static void flush_writer(SnapshotWriter* writer) {
+    writer->checksum = checksum_words(writer->checksum, writer->buffer, writer->used);
+    if (writer->used > 0 && fwrite(writer->buffer, 1, (size_t)writer->used, writer->file) != (size_t)writer->used) {
+        writer->failed = true;
+    }
+    writer->used = 0;
+}
+
+static void put_bytes(SnapshotWriter* writer, const void* data, int64_t size) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    writer->written += size;
+    while (size > 0) {
+        int room = WRITER_BUFFER_SIZE - writer->used;
+        int part = size < room ? (int)size : room;
+        memcpy(writer->buffer + writer->used, bytes, (size_t)part);
+        writer->used += part;
+        bytes += part;
+        size -= part;
+        if (writer->used == WRITER_BUFFER_SIZE) {
+            flush_writer(writer);
+        }
+    }
+}
+
+static void put_int(SnapshotWriter* writer, int32_t value) {
+    put_bytes(writer, &value, sizeof(value));
+}
+
+// Pads the body with zeros to a multiple of 8 bytes, every part starts aligned
+static void pad_writer(SnapshotWriter* writer) {
+    static const unsigned char zeros[8] = {0};
+    put_bytes(writer, zeros, padded(writer->written) - writer->written);
+}
+
+static unsigned long long hash_pointer(Element element, unsigned long long seed) {
+    unsigned long long key = (unsigned long long)(uintptr_t)element ^ seed;
+    key = (key ^ (key >> 31)) * 0x9e3779b97f4a7c15ULL;
+    return key ^ (key >> 29);
+}
+
+static bool same_pointer(Element element1, Element element2) {
+    return element1 == element2;
+}
+
+// The position of every planet in the manager and of every Jerry in the list, the records refer to them by position
+DEFINE_HASHTABLE(PositionOf, Element, int32_t, hash_pointer, same_pointer)
+
+// Takes the offset of the next string in the strings, returns -1 when the strings outgrow a snapshot
+static int32_t string_offset(int64_t* strings, const char* str) {
+    int64_t offset = *strings;
+    *strings += (int64_t)strlen(str) + 1;
+    return *strings > INT32_MAX ? -1 : (int32_t)offset;
+}
+
+// Fills a table with the positions of elements, returns false if memory allocation failed
+static bool add_position(PositionOf positions, Element element, int32_t position) {
+    return PositionOf_add(positions, element, position) == success;
+}
+
+// The Jerries of the multi-value hash table under a name, or NULL if none has it
+static linkedlist jerries_with_name(MultiValueHashTable mht, int id) {
+    return lookupInMultiValueHashTable(mht, get_characteristic_name(id));
+}
+
+// Writes the body of a snapshot and fills the header
+static status write_snapshot_body(SnapshotWriter* writer, SnapshotHeader* header, PlanetsManager* manager,
+                                  linkedlist Jerries, MultiValueHashTable mht, PositionOf planets, PositionOf jerries) {
+    int64_t strings = 0;
+    // Planets
+    for (int i = 0; i < manager->count; i++) {
+        SnapshotPlanet record = {manager->planets[i]->x, manager->planets[i]->y, manager->planets[i]->z,
+                                 string_offset(&strings, manager->planets[i]->name), 0};
+        if (record.name < 0) {
+            return Invlid_Input; // More text than a snapshot holds
+        }
+        put_bytes(writer, &record, sizeof(record));
+    }
+    // Names
+    for (int id = 0; id < header->name_count; id++) {
+        int32_t name = string_offset(&strings, get_characteristic_name(id)->name);
+        if (name < 0) {
+            return Invlid_Input;
+        }
+        put_int(writer, name);
+    }
+    pad_writer(writer);
+    // Jerries
+    int32_t first = 0;
+    for (listNode node = getFirstNode(Jerries); node != NULL; node = getNextNode(node)) {
+        Jerry* jerry = (Jerry*)getNodeData(node);
+        int32_t* planet = PositionOf_lookup(planets, jerry->origin->planet);
+        SnapshotJerry record;
+        record.id = string_offset(&strings, jerry->id);
+        record.dimension = string_offset(&strings, jerry->origin->dimension);
+        record.planet = planet == NULL ? -1 : *planet;
+        record.happiness = get_happiness(jerry);
+        record.first = first;
+        record.count = jerry->characteristics_count;
+        if (record.id < 0 || record.dimension < 0 || record.planet < 0 || first > INT32_MAX - record.count) {
+            return Invlid_Input; // More text than a snapshot holds, or a Jerry of a planet the manager does not have
+        }
+        first += jerry->characteristics_count;
+        put_bytes(writer, &record, sizeof(record));
+    }
+    // Characteristics
+    for (listNode node = getFirstNode(Jerries); node != NULL; node = getNextNode(node)) {
+        Jerry* jerry = (Jerry*)getNodeData(node);
+        for (int c = 0; c < jerry->characteristics_count; c++) {
+            SnapshotCharacteristic record = {jerry->characteristics[c].value, jerry->characteristics[c].id, 0};
+            put_bytes(writer, &record, sizeof(record));
+        }
+    }
+    // Index layout: where the Jerries of every name start, then the Jerries
+    int32_t start = 0;
+    for (int id = 0; id < header->name_count; id++) {
+        put_int(writer, start);
+        linkedlist list = jerries_with_name(mht, id);
+        start += list == NULL ? 0 : getLength(list);
+    }
+    put_int(writer, start);
+    pad_writer(writer);
+    header->layout_count = start;
+    for (int id = 0; id < header->name_count; id++) {
+        linkedlist list = jerries_with_name(mht, id);
+        for (listNode node = list == NULL ? NULL : getFirstNode(list); node != NULL; node = getNextNode(node)) {
+            int32_t* position = PositionOf_lookup(jerries, getNodeData(node));
+            if (position == NULL) {
+                return Invlid_Input; // An indexed Jerry that is not in the list
+            }
+            put_int(writer, *position);
+        }
+    }
+    pad_writer(writer);
+    // Strings, in the order of their offsets
+    for (int i = 0; i < manager->count; i++) {
+        put_bytes(writer, manager->planets[i]->name, (int64_t)strlen(manager->planets[i]->name) + 1);
+    }
+    for (int id = 0; id < header->name_count; id++) {
+        char* name = get_characteristic_name(id)->name;
+        put_bytes(writer, name, (int64_t)strlen(name) + 1);
+    }
+    for (listNode node = getFirstNode(Jerries); node != NULL; node = getNextNode(node)) {
+        Jerry* jerry = (Jerry*)getNodeData(node);
+        put_bytes(writer, jerry->id, (int64_t)strlen(jerry->id) + 1);
+        put_bytes(writer, jerry->origin->dimension, (int64_t)strlen(jerry->origin->dimension) + 1);
+    }
+    header->strings_size = strings;
+    header->characteristic_count = first;
+    pad_writer(writer);
+    flush_writer(writer);
+    header->checksum = writer->checksum;
+    return writer->failed ? Invlid_Input : success;
+}
+
+// Makes a rename in the directory of a path durable
+static void sync_directory(char* path) {
+    char* slash = strrchr(path, '/');
+    size_t length = slash == NULL ? 1 : (slash == path ? 1 : (size_t)(slash - path));
+    char* directory = (char*)malloc(length + 1);
+    if (directory == NULL) {
+        return;
+    }
+    memcpy(directory, slash == NULL ? "." : path, length);
+    directory[length] = '\0';
+    int fd = open(directory, O_RDONLY);
+    if (fd >= 0) {
+        fsync(fd);
+        close(fd);
+    }
+    free(directory);
+}
+
+status save_snapshot(char* path, PlanetsManager* manager, linkedlist Jerries, MultiValueHashTable mht,
+                     unsigned long long* log_base, unsigned long long* checksum) {
+    if (path == NULL || manager == NULL || Jerries == NULL || mht == NULL) {
+        return Invlid_Input;
+    }
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.byte_order = SNAPSHOT_BYTE_ORDER;
+    header.logged = log_base != NULL;
+    header.log_base = log_base != NULL ? *log_base : 0;
+    header.planet_count = manager->count;
+    header.name_count = count_characteristic_names();
+    header.jerry_count = getLength(Jerries);
+    // The position of every planet and Jerry, the records refer to them by position
+    PositionOf planets = PositionOf_create(header.planet_count + 1);
+    PositionOf jerries = PositionOf_create(header.jerry_count + 1);
+    bool added = planets != NULL && jerries != NULL;
+    for (int i = 0; i < manager->count && added; i++) {
+        added = add_position(planets, manager->planets[i], i);
+    }
+    int32_t position = 0;
+    for (listNode node = getFirstNode(Jerries); node != NULL && added; node = getNextNode(node)) {
+        added = add_position(jerries, getNodeData(node), position++);
+    }
+    if (!added) {
+        PositionOf_destroy(planets);
+        PositionOf_destroy(jerries);
+        return Memory_Problem;
+    }
+    // Written next to the old snapshot, which it replaces only once it is complete
+    size_t length = strlen(path);
+    char* temporary = (char*)malloc(length + 5);
+    SnapshotWriter* writer = (SnapshotWriter*)malloc(sizeof(SnapshotWriter));
+    if (temporary == NULL || writer == NULL) {
+        free(temporary);
+        free(writer);
+        PositionOf_destroy(planets);
+        PositionOf_destroy(jerries);
+        return Memory_Problem;
+    }
+    memcpy(temporary, path, length);
+    memcpy(temporary + length, ".tmp", 5);
+    status s = Invlid_Input;
+    writer->file = fopen(temporary, "wb");
+    if (writer->file != NULL) {
+        writer->used = 0;
+        writer->written = 0;
+        writer->checksum = CHECKSUM_SEED;
+        writer->failed = false;
+        // The header is written again with the counts and the checksum once the body is written
+        bool written = fwrite(&header, sizeof(header), 1, writer->file) == 1;
+        s = written ? write_snapshot_body(writer, &header, manager, Jerries, mht, planets, jerries) : Invlid_Input;
+        if (s == success && (fseek(writer->file, 0, SEEK_SET) != 0 || fwrite(&header, sizeof(header), 1, writer->file) != 1
+                             || fflush(writer->file) != 0 || fsync(fileno(writer->file)) != 0)) {
+            s = Invlid_Input;
+        }
+        if (fclose(writer->file) != 0) {
+            s = Invlid_Input;
+        }
+        if (s == success && rename(temporary, path) != 0) {
+            s = Invlid_Input;
+        }
+        if (s == success) {
+            sync_directory(path);
+            if (checksum != NULL) {
+                *checksum = header.checksum;
+            }
+        } else {
+            remove(temporary);
+        }
+    }
+    free(temporary);
+    free(writer);
+    PositionOf_destroy(planets);
+    PositionOf_destroy(jerries);
+    return s;
+}
+
+// --- Loading ---
+
+// Checks that an offset of the strings starts a string that ends inside them
+static bool valid_string(const SnapshotHeader* header, int32_t offset) {
+    return offset >= 0 && offset < header->strings_size;
+}
+
+// Checks a mapped snapshot: the header, the size, the checksum and every reference of every record
+static bool valid_snapshot(const char* data, long size, SnapshotHeader* header, SnapshotLayout* layout) {
+    if (data == NULL || size < (long)sizeof(SnapshotHeader)) {
+        return false;
+    }
+    memcpy(header, data, sizeof(SnapshotHeader));
+    if (memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(header->magic)) != 0 || header->version != SNAPSHOT_VERSION
+        || header->byte_order != SNAPSHOT_BYTE_ORDER || header->planet_count < 0 || header->name_count < 0
+        || header->jerry_count < 0 || header->characteristic_count < 0 || header->layout_count < 0
+        || header->strings_size < 0 || header->strings_size > INT32_MAX || (header->logged != 0 && header->logged != 1)) {
+        return false;
+    }
+    if (layout_snapshot(header, data, layout) != size) {
+        return false;
+    }
+    const unsigned char* body = (const unsigned char*)data + sizeof(SnapshotHeader);
+    if (checksum_words(CHECKSUM_SEED, body, size - (long)sizeof(SnapshotHeader)) != header->checksum) {
+        return false;
+    }
+    // Every string ends inside the strings, so an offset inside them is enough
+    if (header->strings_size > 0 && layout->strings[header->strings_size - 1] != '\0') {
+        return false;
+    }
+    for (int i = 0; i < header->planet_count; i++) {
+        if (!valid_string(header, layout->planets[i].name)) {
+            return false;
+        }
+    }
+    for (int i = 0; i < header->name_count; i++) {
+        if (!valid_string(header, layout->names[i])) {
+            return false;
+        }
+    }
+    int64_t next = 0;
+    for (int i = 0; i < header->jerry_count; i++) {
+        const SnapshotJerry* jerry = &layout->jerries[i];
+        if (!valid_string(header, jerry->id) || !valid_string(header, jerry->dimension) || jerry->planet < 0
+            || jerry->planet >= header->planet_count || jerry->first != next || jerry->count < 0
+            || next + jerry->count > header->characteristic_count) {
+            return false;
+        }
+        // The characteristics of a Jerry have names of the catalog, each one once
+        for (int c = jerry->first; c < jerry->first + jerry->count; c++) {
+            int32_t id = layout->characteristics[c].id;
+            if (id < 0 || id >= header->name_count) {
+                return false;
+            }
+            for (int d = jerry->first; d < c; d++) {
+                if (layout->characteristics[d].id == id) {
+                    return false;
+                }
+            }
+        }
+        next += jerry->count;
+    }
+    if (next != header->characteristic_count || layout->layout_starts[0] != 0
+        || layout->layout_starts[header->name_count] != header->layout_count
+        || header->layout_count != header->characteristic_count) {
+        return false;
+    }
+    // Every entry of the layout is a characteristic of a Jerry, and every characteristic has one entry
+    bool* indexed = (bool*)calloc((size_t)header->characteristic_count + 1, sizeof(bool));
+    if (indexed == NULL) {
+        return false;
+    }
+    bool valid = true;
+    for (int id = 0; id < header->name_count && valid; id++) {
+        int32_t start = layout->layout_starts[id];
+        int32_t end = layout->layout_starts[id + 1];
+        valid = start >= 0 && start <= end && end <= header->layout_count;
+        for (int e = start; e < end && valid; e++) {
+            int32_t position = layout->layout_jerries[e];
+            valid = position >= 0 && position < header->jerry_count;
+            if (!valid) {
+                break;
+            }
+            const SnapshotJerry* jerry = &layout->jerries[position];
+            int found = -1;
+            for (int c = jerry->first; c < jerry->first + jerry->count && found < 0; c++) {
+                found = layout->characteristics[c].id == id ? c : -1;
+            }
+            valid = found >= 0 && !indexed[found];
+            if (valid) {
+                indexed[found] = true;
+            }
+        }
+    }
+    free(indexed);
+    return valid;
+}
+
+// Creates the planets, the names and the Jerries of a checked snapshot
+static status restore_snapshot(snapshot snap, PlanetsManager* manager, linkedlist Jerries) {
+    const SnapshotHeader* header = &snap->header;
+    const SnapshotLayout* layout = &snap->layout;
+    Planet** planets = (Planet**)malloc(((size_t)header->planet_count + 1) * sizeof(Planet*));
+    if (planets == NULL) {
+        return Memory_Problem;
+    }
+    for (int i = 0; i < header->planet_count; i++) {
+        const SnapshotPlanet* planet = &layout->planets[i];
+        planets[i] = create_planet(manager, (char*)layout->strings + planet->name, planet->x, planet->y, planet->z);
+        if (planets[i] == NULL) {
+            free(planets);
+            return Memory_Problem;
+        }
+    }
+    // The names get back their ids, the catalog being empty
+    for (int id = 0; id < header->name_count; id++) {
+        int interned = intern_characteristic_name((char*)layout->strings + layout->names[id]);
+        if (interned != id) {
+            free(planets);
+            return interned < 0 ? Memory_Problem : Invlid_Input; // A name saved twice
+        }
+    }
+    for (int i = 0; i < header->jerry_count; i++) {
+        const SnapshotJerry* record = &layout->jerries[i];
+        Jerry* jerry = create_jerry_on_planet((char*)layout->strings + record->id, record->happiness,
+                                              (char*)layout->strings + record->dimension, planets[record->planet],
+                                              manager->arena);
+        if (jerry == NULL) {
+            free(planets);
+            memory_failure_sign = 1;
+            return Memory_Problem;
+        }
+        for (int c = record->first; c < record->first + record->count; c++) {
+            if (add_physical_characteristic_by_id(jerry, layout->characteristics[c].id, layout->characteristics[c].value) != Success) {
+                destroy_jerry(jerry);
+                free(planets);
+                memory_failure_sign = 1;
+                return Memory_Problem;
+            }
+        }
+        if (appendNode(Jerries, jerry) != success) {
+            destroy_jerry(jerry);
+            free(planets);
+            memory_failure_sign = 1;
+            return Memory_Problem;
+        }
+        snap->jerries[i] = jerry;
+    }
+    free(planets);
+    return success;
+}
+
+snapshot load_snapshot(char* path, PlanetsManager* manager, linkedlist Jerries, status* result) {
+    status ignored;
+    if (result == NULL) {
+        result = &ignored;
+    }
+    if (path == NULL || manager == NULL || Jerries == NULL) {
+        *result = Invlid_Input;
+        return NULL;
+    }
+    snapshot snap = (snapshot)malloc(sizeof(struct snapshot_s));
+    if (snap == NULL) {
+        *result = Memory_Problem;
+        return NULL;
+    }
+    *result = mapConfigFile(path, &snap->text); // Mapped like a configuration file, the records are read in place
+    if (*result != success) {
+        free(snap);
+        return NULL;
+    }
+    if (!valid_snapshot(snap->text.data, snap->text.size, &snap->header, &snap->layout) || count_characteristic_names() != 0) {
+        unmapConfigFile(&snap->text);
+        free(snap);
+        *result = Invlid_Input;
+        return NULL;
+    }
+    snap->jerries = (Jerry**)malloc(((size_t)snap->header.jerry_count + 1) * sizeof(Jerry*));
+    *result = snap->jerries == NULL ? Memory_Problem : restore_snapshot(snap, manager, Jerries);
+    if (*result != success) {
+        close_snapshot(snap);
+        return NULL;
+    }
+    return snap;
+}
+
+status index_snapshot_characteristics(snapshot snap, CharacteristicIndexer index, Element context) {
+    if (snap == NULL || index == NULL) {
+        return failure;
+    }
+    const SnapshotLayout* layout = &snap->layout;
+    for (int id = 0; id < snap->header.name_count; id++) {
+        for (int e = layout->layout_starts[id]; e < layout->layout_starts[id + 1]; e++) {
+            Jerry* jerry = snap->jerries[layout->layout_jerries[e]];
+            status s = index(jerry, get_characteristic_by_id(jerry, id), context);
+            if (s != success) {
+                return s;
+            }
+        }
+    }
+    return success;
+}
+
+unsigned long long get_snapshot_checksum(snapshot snap) {
+    return snap == NULL ? 0 : snap->header.checksum;
+}
+
+bool get_snapshot_log_base(snapshot snap, unsigned long long* base) {
+    if (snap == NULL || base == NULL || snap->header.logged != 1) {
+        return false;
+    }
+    *base = snap->header.log_base;
+    return true;
+}
+
+void close_snapshot(snapshot snap) {
+    if (snap == NULL) {
+        return;
+    }
+    unmapConfigFile(&snap->text);
+    free(snap->jerries);
+    free(snap);
+}
@@ -0,0 +1,369 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "SpatialIndex.h"
+#include "MemoryPool.h"
+#define DIMENSIONS 3
+#define NODES_PER_SLAB 64   // Tree nodes malloced at once
+#define BALANCE 0.7         // Largest share of a subtree that one of its children may hold before a deep addition rebuilds it
+#define MAX_DEPTH 128       // Deeper than a balanced tree of any int number of nodes can grow
+#define INITIAL_MATCHES 16  // Room of the first array of radius matches, it doubles when full
+
+// A node of the k-d tree, it splits its subtree by the coordinate (depth % DIMENSIONS) of its point
+typedef struct spatial_node_s {
+    double point[DIMENSIONS];
+    unsigned long order;    // Sequence number of the addition, breaks ties between equally close nodes
+    Element content;
+    struct spatial_node_s* left;    // Points whose split coordinate is not above the one of the node
+    struct spatial_node_s* right;   // Points whose split coordinate is not below the one of the node
+    int count;              // Number of nodes in the subtree of the node
+} SpatialNode;
+
+struct spatialIndex_s {
+    SpatialNode* root;
+    int size;
+    unsigned long added;    // Number of additions so far, the next sequence number
+    memoryPool pool;        // Pool of the nodes, released in bulk when the index is destroyed
+    CopyFunction copyElement;
+    FreeFunction freeElement;
+    PrintFunction printElement;
+};
+
+// A node found by a search, with its squared distance from the searched point
+typedef struct spatial_match_s {
+    double distance;
+    SpatialNode* node;
+} SpatialMatch;
+
+// Returns the number of nodes in a subtree (0 for an empty one)
+static int count(SpatialNode* node) {
+    return node == NULL ? 0 : node->count;
+}
+
+// Returns the squared distance of a node from a point
+static double distanceTo(SpatialNode* node, const double* point) {
+    double sum = 0;
+    for (int i = 0; i < DIMENSIONS; i++) {
+        double difference = node->point[i] - point[i];
+        sum += difference * difference;
+    }
+    return sum;
+}
+
+// Checks if the first match comes before the second one: closer, or as close and added earlier
+static bool isBefore(const SpatialMatch* first, const SpatialMatch* second) {
+    if (first->distance != second->distance) {
+        return first->distance < second->distance;
+    }
+    return first->node->order < second->node->order;
+}
+
+// Returns the depth a tree of size nodes may reach before an addition looks for a subtree to rebuild
+static int depthLimit(int size) {
+    int limit = 0;
+    for (double reach = 1; reach < size; reach /= BALANCE) {
+        limit++;
+    }
+    return limit;
+}
+
+// Moves the node with the nth smallest coordinate of an axis to position nth of nodes[from, to),
+// with no greater coordinate before it and no smaller one after it (quickselect)
+static void selectNth(SpatialNode** nodes, int from, int to, int nth, int axis) {
+    while (to - from > 1) {
+        double pivot = nodes[from + (to - from) / 2]->point[axis];
+        int i = from;
+        int j = to - 1;
+        while (i <= j) {
+            while (nodes[i]->point[axis] < pivot) {
+                i++;
+            }
+            while (nodes[j]->point[axis] > pivot) {
+                j--;
+            }
+            if (i <= j) {
+                SpatialNode* node = nodes[i];
+                nodes[i++] = nodes[j];
+                nodes[j--] = node;
+            }
+        }
+        // nodes[from, j] are not above the pivot, nodes[i, to) are not below it, the ones between are equal to it
+        if (nth <= j) {
+            to = j + 1;
+        } else if (nth >= i) {
+            from = i;
+        } else {
+            return;
+        }
+    }
+}
+
+// Builds a balanced subtree of nodes[from, to) split first by axis, returns its root
+static SpatialNode* buildBalanced(SpatialNode** nodes, int from, int to, int axis) {
+    if (from >= to) {
+        return NULL;
+    }
+    int middle = from + (to - from) / 2;
+    selectNth(nodes, from, to, middle, axis);
+    SpatialNode* node = nodes[middle];
+    int next = (axis + 1) % DIMENSIONS;
+    node->left = buildBalanced(nodes, from, middle, next);
+    node->right = buildBalanced(nodes, middle + 1, to, next);
+    node->count = to - from;
+    return node;
+}
+
+// Puts the nodes of a subtree into an array, returns the position after the last one
+static int collectNodes(SpatialNode* node, SpatialNode** nodes, int position) {
+    if (node == NULL) {
+        return position;
+    }
+    nodes[position++] = node;
+    position = collectNodes(node->left, nodes, position);
+    return collectNodes(node->right, nodes, position);
+}
+
+// Rebuilds a subtree split first by axis around its medians, returns its new root (the old one if memory ran out)
+static SpatialNode* rebuildSubtree(SpatialNode* node, int axis) {
+    SpatialNode** nodes = (SpatialNode**)malloc(node->count * sizeof(SpatialNode*));
+    if (nodes == NULL) {
+        return node; // Still a valid tree, only less balanced
+    }
+    int size = collectNodes(node, nodes, 0);
+    SpatialNode* root = buildBalanced(nodes, 0, size, axis);
+    free(nodes);
+    return root;
+}
+
+spatialIndex createSpatialIndex(CopyFunction copyElement, FreeFunction freeElement, PrintFunction printElement) {
+    if (copyElement == NULL || freeElement == NULL || printElement == NULL) {
+        return NULL;
+    }
+    spatialIndex index = (spatialIndex)malloc(sizeof(struct spatialIndex_s));
+    if (index == NULL) {
+        return NULL;
+    }
+    index->pool = createMemoryPool(sizeof(SpatialNode), NODES_PER_SLAB);
+    if (index->pool == NULL) {
+        free(index);
+        return NULL;
+    }
+    index->root = NULL;
+    index->size = 0;
+    index->added = 0;
+    index->copyElement = copyElement;
+    index->freeElement = freeElement;
+    index->printElement = printElement;
+    return index;
+}
+
+// Frees the elements of a subtree, the nodes go with the pool
+static void freeElements(spatialIndex index, SpatialNode* node) {
+    if (node == NULL) {
+        return;
+    }
+    index->freeElement(node->content);
+    freeElements(index, node->left);
+    freeElements(index, node->right);
+}
+
+status destroySpatialIndex(spatialIndex index) {
+    if (index == NULL) {
+        return failure;
+    }
+    freeElements(index, index->root);
+    destroyMemoryPool(index->pool);
+    free(index);
+    return success;
+}
+
+status addToSpatialIndex(spatialIndex index, double x, double y, double z, Element element) {
+    if (index == NULL || element == NULL) {
+        return failure;
+    }
+    SpatialNode* node = (SpatialNode*)allocateFromPool(index->pool);
+    if (node == NULL) {
+        return Memory_Problem;
+    }
+    node->content = index->copyElement(element);
+    if (node->content == NULL) {
+        returnToPool(index->pool, node);
+        return Memory_Problem;
+    }
+    node->point[0] = x;
+    node->point[1] = y;
+    node->point[2] = z;
+    node->order = index->added++;
+    node->left = NULL;
+    node->right = NULL;
+    node->count = 1;
+    // Walk down to the new leaf, counting the node in every subtree on the way
+    SpatialNode** path[MAX_DEPTH];   // The links to the ancestors of the new node, from the root
+    SpatialNode** link = &index->root;
+    int depth = 0;
+    while (*link != NULL) {
+        SpatialNode* parent = *link;
+        if (depth < MAX_DEPTH) {
+            path[depth] = link;
+        }
+        int axis = depth % DIMENSIONS;
+        parent->count++;
+        link = node->point[axis] < parent->point[axis] ? &parent->left : &parent->right;
+        depth++;
+    }
+    *link = node;
+    index->size++;
+    // A leaf that is too deep has a lopsided ancestor, the deepest one is rebuilt
+    if (depth > depthLimit(index->size)) {
+        for (int i = (depth < MAX_DEPTH ? depth : MAX_DEPTH) - 1; i >= 0; i--) {
+            SpatialNode* ancestor = *path[i];
+            int larger = count(ancestor->left) > count(ancestor->right) ? count(ancestor->left) : count(ancestor->right);
+            if (larger > BALANCE * ancestor->count) {
+                *path[i] = rebuildSubtree(ancestor, i % DIMENSIONS);
+                break;
+            }
+        }
+    }
+    return success;
+}
+
+// Searches a subtree for the k nodes closest to a point, best holds the found ones closest first
+static void searchNearest(SpatialNode* node, int axis, const double* point, int k, SpatialMatch* best, int* found) {
+    if (node == NULL) {
+        return;
+    }
+    SpatialMatch match = {distanceTo(node, point), node};
+    if (*found < k || isBefore(&match, &best[*found - 1])) {
+        // Insert the node in its place, dropping the farthest one if the list is full
+        int i = *found < k ? (*found)++ : k - 1;
+        while (i > 0 && isBefore(&match, &best[i - 1])) {
+            best[i] = best[i - 1];
+            i--;
+        }
+        best[i] = match;
+    }
+    double difference = point[axis] - node->point[axis];
+    int next = (axis + 1) % DIMENSIONS;
+    searchNearest(difference < 0 ? node->left : node->right, next, point, k, best, found);
+    // The other side is only searched if the splitting plane is not farther than the k-th closest node
+    if (*found < k || difference * difference <= best[*found - 1].distance) {
+        searchNearest(difference < 0 ? node->right : node->left, next, point, k, best, found);
+    }
+}
+
+int findNearestInSpatialIndex(spatialIndex index, double x, double y, double z, int k, Element* nearest, double* distances) {
+    if (index == NULL || k < 0 || (k > 0 && nearest == NULL)) {
+        return -1;
+    }
+    if (k > index->size) {
+        k = index->size;
+    }
+    if (k == 0) {
+        return 0;
+    }
+    SpatialMatch* best = (SpatialMatch*)malloc(k * sizeof(SpatialMatch));
+    if (best == NULL) {
+        return -1;
+    }
+    double point[DIMENSIONS] = {x, y, z};
+    int found = 0;
+    searchNearest(index->root, 0, point, k, best, &found);
+    for (int i = 0; i < found; i++) {
+        nearest[i] = best[i].node->content;
+        if (distances != NULL) {
+            distances[i] = best[i].distance;
+        }
+    }
+    free(best);
+    return found;
+}
+
+// The nodes found by a radius search so far
+typedef struct spatial_matches_s {
+    SpatialMatch* matches;
+    int size;
+    int capacity;
+} SpatialMatches;
+
+// Collects the nodes of a subtree within a squared radius of a point, returns Memory_Problem if the array could not grow
+static status searchRadius(SpatialNode* node, int axis, const double* point, double radius, SpatialMatches* found) {
+    if (node == NULL) {
+        return success;
+    }
+    double distance = distanceTo(node, point);
+    if (distance <= radius) {
+        if (found->size == found->capacity) {
+            int capacity = found->capacity == 0 ? INITIAL_MATCHES : found->capacity * 2;
+            SpatialMatch* matches = (SpatialMatch*)realloc(found->matches, capacity * sizeof(SpatialMatch));
+            if (matches == NULL) {
+                return Memory_Problem;
+            }
+            found->matches = matches;
+            found->capacity = capacity;
+        }
+        found->matches[found->size].distance = distance;
+        found->matches[found->size].node = node;
+        found->size++;
+    }
+    double difference = point[axis] - node->point[axis];
+    int next = (axis + 1) % DIMENSIONS;
+    if (searchRadius(difference < 0 ? node->left : node->right, next, point, radius, found) != success) {
+        return Memory_Problem;
+    }
+    if (difference * difference <= radius) {
+        return searchRadius(difference < 0 ? node->right : node->left, next, point, radius, found);
+    }
+    return success;
+}
+
+// Orders the matches of a radius search closest first, for qsort
+static int compareMatches(const void* first, const void* second) {
+    const SpatialMatch* match1 = (const SpatialMatch*)first;
+    const SpatialMatch* match2 = (const SpatialMatch*)second;
+    return isBefore(match1, match2) ? -1 : isBefore(match2, match1) ? 1 : 0;
+}
+
+status forEachInSpatialRadius(spatialIndex index, double x, double y, double z, double radius, VisitFunction visit, Element context) {
+    if (index == NULL || visit == NULL || radius < 0) {
+        return failure;
+    }
+    double point[DIMENSIONS] = {x, y, z};
+    SpatialMatches found = {NULL, 0, 0};
+    if (searchRadius(index->root, 0, point, radius * radius, &found) != success) {
+        free(found.matches);
+        return Memory_Problem;
+    }
+    if (found.size > 1) {
+        qsort(found.matches, found.size, sizeof(SpatialMatch), compareMatches);
+    }
+    status result = success;
+    for (int i = 0; i < found.size && result == success; i++) {
+        result = visit(found.matches[i].node->content, context);
+    }
+    free(found.matches);
+    return result;
+}
+
+int getSpatialIndexSize(spatialIndex index) {
+    if (index == NULL) {
+        return -1;
+    }
+    return index->size;
+}
+
+// Prints the elements of a subtree, a node before its children
+static void displaySubtree(spatialIndex index, SpatialNode* node) {
+    if (node == NULL) {
+        return;
+    }
+    index->printElement(node->content);
+    displaySubtree(index, node->left);
+    displaySubtree(index, node->right);
+}
+
+status displaySpatialIndex(spatialIndex index) {
+    if (index == NULL) {
+        return failure;
+    }
+    displaySubtree(index, index->root);
+    return success;
+}
@@ -0,0 +1,92 @@
+#include <string.h>
+#include "StringHash.h"
+
+// Secret constants of wyhash
+static const unsigned long long WY_SECRET_0 = 0xa0761d6478bd642fULL;
+static const unsigned long long WY_SECRET_1 = 0xe7037ed1a0b428dbULL;
+
+// Multiplies two 64-bit numbers into a 128-bit product split into its low and high halves
+static void multiply128(unsigned long long* a, unsigned long long* b) {
+#ifdef __SIZEOF_INT128__
+    __uint128_t product = (__uint128_t)(*a) * (*b);
+    *a = (unsigned long long)product;
+    *b = (unsigned long long)(product >> 64);
+#else
+    unsigned long long ha = *a >> 32, hb = *b >> 32, la = (unsigned int)*a, lb = (unsigned int)*b;
+    unsigned long long rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    unsigned long long t = rl + (rm0 << 32);
+    unsigned long long carry = t < rl;
+    unsigned long long low = t + (rm1 << 32);
+    carry += low < t;
+    *a = low;
+    *b = rh + (rm0 >> 32) + (rm1 >> 32) + carry;
+#endif
+}
+
+// Folds the 128-bit product of two numbers back into 64 bits
+static unsigned long long mix(unsigned long long a, unsigned long long b) {
+    multiply128(&a, &b);
+    return a ^ b;
+}
+
+// Reads 8 bytes (little endian order is not required, only consistency)
+static unsigned long long read64(const unsigned char* p) {
+    unsigned long long v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// Reads 4 bytes
+static unsigned long long read32(const unsigned char* p) {
+    unsigned int v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+unsigned long long wyhashString(Element str, unsigned long long seed) {
+    if (str == NULL) {
+        return 0;
+    }
+    const unsigned char* p = (const unsigned char*)str;
+    size_t length = strlen((const char*)str);
+    unsigned long long a, b;
+    seed ^= mix(seed ^ WY_SECRET_0, WY_SECRET_1);
+    if (length <= 16) {
+        if (length >= 4) {
+            // Two overlapping pairs of 4-byte reads cover any length from 4 to 16
+            a = (read32(p) << 32) | read32(p + ((length >> 3) << 2));
+            b = (read32(p + length - 4) << 32) | read32(p + length - 4 - ((length >> 3) << 2));
+        } else if (length > 0) {
+            a = ((unsigned long long)p[0] << 16) | ((unsigned long long)p[length >> 1] << 8) | p[length - 1];
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        // Fold 16 bytes per round, the last (possibly overlapping) 16 bytes are mixed below
+        size_t left = length;
+        while (left > 16) {
+            seed = mix(read64(p) ^ WY_SECRET_1, read64(p + 8) ^ seed);
+            p += 16;
+            left -= 16;
+        }
+        a = read64(p + left - 16);
+        b = read64(p + left - 8);
+    }
+    a ^= WY_SECRET_1;
+    b ^= seed;
+    multiply128(&a, &b);
+    return mix(a ^ WY_SECRET_0 ^ length, b ^ WY_SECRET_1);
+}
+
+unsigned long long fnv1aString(Element str, unsigned long long seed) {
+    if (str == NULL) {
+        return 0;
+    }
+    unsigned long long hash = 0xcbf29ce484222325ULL ^ seed; // FNV offset basis, moved by the seed
+    for (const unsigned char* p = (const unsigned char*)str; *p != '\0'; p++) {
+        hash ^= *p;
+        hash *= 0x100000001b3ULL; // FNV prime
+    }
+    return hash;
+}
@@ -0,0 +1,202 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "StringHash.h"
+#define ID_SIZE 32
+#define MAX_IDS 70000
+#define CHECKED_SEEDS 3
+#define MIN_CHECKED_KEYS 256   // Smaller sets are reported, too few keys to judge a hash by
+#define MAX_CHI_SQUARE_RATIO 1.5
+/**
+ * Checks how the string hashes spread Jerry IDs over the buckets of a table.
+ * Usage: ./StringHashCheck [configurationFile]
+ * The IDs of the configuration file are checked with synthetic sets that are hard on a weak hash: anagrams of one
+ * ID, every short ID, and numbered IDs. Every set is put in buckets the way the tables pick them: the hash modulo a
+ * prime for the Chained engine, and bits above the control byte masked to a power of two for Open_Addressing.
+ * For each set and hash it prints the chi-square of the bucket counts divided by the number of buckets (about 1 for
+ * a uniform hash) and the longest chain. It fails if wyhashString or fnv1aString is skewed on a large enough set.
+ */
+
+typedef struct KeySet_struct {
+    const char* name;
+    char (*ids)[ID_SIZE];
+    int count;
+} KeySet;
+
+// The old key transform of the daycare, the sum of the characters
+static unsigned long long asciiSum(Element str, unsigned long long seed) {
+    (void)seed;
+    unsigned long long sum = 0;
+    for (const char* c = (const char*)str; *c != '\0'; c++) {
+        sum += (unsigned char)*c;
+    }
+    return sum;
+}
+
+static int nextPrime(int n) {
+    for (;; n++) {
+        bool prime = n >= 2;
+        for (int d = 2; d * d <= n && prime; d++) {
+            prime = n % d != 0;
+        }
+        if (prime) {
+            return n;
+        }
+    }
+}
+
+static int nextPowerOfTwo(int n) {
+    int power = 1;
+    while (power < n) {
+        power *= 2;
+    }
+    return power;
+}
+
+// Puts the keys in buckets and returns the chi-square of the counts divided by the buckets, with the longest chain
+static double chiSquareRatio(const KeySet* set, HashFunction hash, unsigned long long seed, bool masked, int* longest) {
+    int buckets = masked ? nextPowerOfTwo(set->count) : nextPrime(set->count);
+    int* counts = (int*)calloc((size_t)buckets, sizeof(int));
+    if (counts == NULL) {
+        return -1;
+    }
+    for (int i = 0; i < set->count; i++) {
+        unsigned long long h = hash(set->ids[i], seed);
+        int bucket = masked ? (int)((h >> 7) & (unsigned long long)(buckets - 1)) : (int)(h % (unsigned long long)buckets);
+        counts[bucket]++;
+    }
+    double expected = (double)set->count / buckets;
+    double chi = 0;
+    *longest = 0;
+    for (int b = 0; b < buckets; b++) {
+        chi += (counts[b] - expected) * (counts[b] - expected) / expected;
+        if (counts[b] > *longest) {
+            *longest = counts[b];
+        }
+    }
+    free(counts);
+    return chi / buckets;
+}
+
+// Reads the Jerry IDs of a configuration file, the first field of every line of the Jerries section
+static int readConfigIds(const char* path, char (*ids)[ID_SIZE], int capacity) {
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        return -1;
+    }
+    char line[300];
+    bool jerries = false;
+    int count = 0;
+    while (fgets(line, sizeof(line), file) != NULL && count < capacity) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (strcmp(line, "Jerries") == 0 || strcmp(line, "Planets") == 0) {
+            jerries = line[0] == 'J';
+        } else if (jerries && line[0] != '\t' && strchr(line, ',') != NULL) {
+            size_t length = strcspn(line, ",");
+            if (length > 0 && length < ID_SIZE) {
+                memcpy(ids[count], line, length);
+                ids[count][length] = '\0';
+                count++;
+            }
+        }
+    }
+    fclose(file);
+    return count;
+}
+
+// Every permutation of an ID (its characters are distinct), they all have the same character sum
+static void permute(char* id, int first, int length, char (*ids)[ID_SIZE], int* count) {
+    if (first == length) {
+        strcpy(ids[(*count)++], id);
+        return;
+    }
+    for (int i = first; i < length; i++) {
+        char c = id[first]; id[first] = id[i]; id[i] = c;
+        permute(id, first + 1, length, ids, count);
+        c = id[first]; id[first] = id[i]; id[i] = c;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const char* config = argc > 1 ? argv[1] : "configuration_file.txt";
+    static const char alphabet[] = "abcdefghijklmnopqrstuvwxyz0123456789";
+    char (*real)[ID_SIZE] = malloc(MAX_IDS * ID_SIZE);
+    char (*anagrams)[ID_SIZE] = malloc(MAX_IDS * ID_SIZE);
+    char (*shorts)[ID_SIZE] = malloc(MAX_IDS * ID_SIZE);
+    char (*numbered)[ID_SIZE] = malloc(MAX_IDS * ID_SIZE);
+    if (real == NULL || anagrams == NULL || shorts == NULL || numbered == NULL) {
+        printf("Memory Problem\n");
+        free(real); free(anagrams); free(shorts); free(numbered);
+        return 1;
+    }
+    int realCount = readConfigIds(config, real, MAX_IDS);
+    if (realCount < 0) {
+        printf("%s cannot be read, only the synthetic IDs are checked\n", config);
+        realCount = 0;
+    }
+    char base[] = "3b1f9e2";
+    int anagramCount = 0;
+    permute(base, 0, (int)strlen(base), anagrams, &anagramCount);
+    int shortCount = 0;
+    for (int a = 0; a < 36; a++) {
+        snprintf(shorts[shortCount++], ID_SIZE, "%c", alphabet[a]);
+        for (int b = 0; b < 36; b++) {
+            snprintf(shorts[shortCount++], ID_SIZE, "%c%c", alphabet[a], alphabet[b]);
+        }
+    }
+    int numberedCount = 50000;
+    for (int i = 0; i < numberedCount; i++) {
+        snprintf(numbered[i], ID_SIZE, "J%05d", i);
+    }
+    KeySet sets[] = {
+        {"configuration IDs", real, realCount},
+        {"anagrams of one ID", anagrams, anagramCount},
+        {"IDs of 1-2 characters", shorts, shortCount},
+        {"numbered IDs", numbered, numberedCount},
+    };
+    struct { const char* name; HashFunction hash; bool checked; } hashes[] = {
+        {"stringToAsciiSum", asciiSum, false},
+        {"wyhashString", wyhashString, true},
+        {"fnv1aString", fnv1aString, true},
+    };
+    unsigned long long seeds[CHECKED_SEEDS] = {0, 0x9e3779b97f4a7c15ULL, 0x243f6a8885a308d3ULL};
+    int skewed = 0;
+    printf("%-22s %-17s %7s %16s %16s\n", "keys", "hash", "count", "Chained chi2/m", "Open chi2/m");
+    for (size_t s = 0; s < sizeof(sets) / sizeof(sets[0]); s++) {
+        if (sets[s].count == 0) {
+            continue;
+        }
+        for (size_t h = 0; h < sizeof(hashes) / sizeof(hashes[0]); h++) {
+            // The worst of the seeds, with its longest chain
+            double worst[2] = {0, 0};
+            int longest[2] = {0, 0};
+            for (int seed = 0; seed < CHECKED_SEEDS; seed++) {
+                for (int engine = 0; engine < 2; engine++) {
+                    int chain = 0;
+                    double ratio = chiSquareRatio(&sets[s], hashes[h].hash, seeds[seed], engine == 1, &chain);
+                    if (ratio < 0) {
+                        printf("Memory Problem\n");
+                        return 1;
+                    }
+                    if (ratio > worst[engine]) {
+                        worst[engine] = ratio;
+                        longest[engine] = chain;
+                    }
+                }
+            }
+            bool bad = hashes[h].checked && sets[s].count >= MIN_CHECKED_KEYS
+                       && (worst[0] > MAX_CHI_SQUARE_RATIO || worst[1] > MAX_CHI_SQUARE_RATIO);
+            skewed += bad;
+            printf("%-22s %-17s %7d %9.2f (%4d) %9.2f (%4d)%s\n", sets[s].name, hashes[h].name, sets[s].count,
+                   worst[0], longest[0], worst[1], longest[1], bad ? "  SKEWED" : "");
+        }
+    }
+    free(real); free(anagrams); free(shorts); free(numbered);
+    if (skewed > 0) {
+        printf("FAILED: %d skewed results\n", skewed);
+        return 1;
+    }
+    printf("wyhashString and fnv1aString spread every set evenly (chi2/m at most %.1f, longest chain in brackets)\n",
+           MAX_CHI_SQUARE_RATIO);
+    return 0;
+}